@@ -1,7 +1,48 @@
-#include <memory>
+// Measures parse throughput and latency for each input file, allocation
+// strategy, and cache state.
+//
+// usage: bench [options] [files...]
+//
+//   --strategy=NAME    single, dynamic, or bounded; repeat to run several.
+//                      Defaults to all three.
+//   --cache=MODE       warm, cold, or both.  Defaults to warm.  Cold runs
+//                      sweep an eviction buffer through the caches before
+//                      each parse.
+//   --evict-mb=N       Size of the eviction buffer.  Defaults to 64.
+//   --min-time=MS      Keep parsing each combination for at least this long.
+//                      Defaults to 200.
+//   --min-iterations=N Parse each combination at least this many times.
+//                      Defaults to 10.
+//   --counters         Also count cycles, instructions, branch misses, and
+//                      L1 data and last-level cache misses during each parse
+//                      with perf_event_open, and report them per input byte.
+//                      Linux only; needs access to the hardware PMU.
+//   --json             Print the results as JSON instead of a table.
+//
+// Every parse runs in place on a fresh copy of the file, made outside the
+// timed region; the time includes allocating the AST and destroying the
+// document.  Throughput and ns per byte are derived from the median time.
+
+#include "harness.h"
+
 #include <sajson.h>
+#include <sajson_writer.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
 #include <vector>
 
+#ifdef __linux__
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 const char* default_files[] = {
     "testdata/apache_builds.json", "testdata/github_events.json",
     "testdata/instruments.json",   "testdata/mesh.json",
@@ -13,93 +54,561 @@ const char* default_files[] = {
 const size_t default_files_count
     = sizeof(default_files) / sizeof(*default_files);
 
-template <typename AllocationStrategy>
-void run_benchmark(size_t max_string_length, const char* filename) {
+enum counter_kind {
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    L1D_MISSES,
+    LLC_MISSES,
+    COUNTER_COUNT
+};
+const char* const counter_names[]
+    = { "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses" };
+
+struct options {
+    options()
+        : warm(true)
+        , cold(false)
+        , evict_bytes(64 << 20)
+        , min_time_ms(200)
+        , min_iterations(10)
+        , counters(false)
+        , json(false) {}
+
+    std::vector<strategy_kind> strategies;
+    bool warm;
+    bool cold;
+    size_t evict_bytes;
+    double min_time_ms;
+    size_t min_iterations;
+    bool counters;
+    bool json;
+    std::vector<std::string> files;
+};
+
+struct result {
+    std::string file;
+    strategy_kind strategy;
+    bool cold;
+    size_t bytes;
+    size_t iterations;
+    double min_ns;
+    double mean_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    // Events per input byte, or negative if not counted.
+    double per_byte[COUNTER_COUNT];
+};
+
+bool read_file(const char* filename, std::vector<char>& contents) {
     FILE* file = fopen(filename, "rb");
     if (!file) {
         perror("fopen failed");
-        return;
+        return false;
     }
 
     std::unique_ptr<FILE, int (*)(FILE*)> deleter(file, fclose);
 
     if (fseek(file, 0, SEEK_END)) {
         perror("fseek failed");
-        return;
+        return false;
     }
     size_t length = ftell(file);
     if (fseek(file, 0, SEEK_SET)) {
         perror("fseek failed");
-        return;
+        return false;
     }
 
-    std::vector<char> buffer(length);
-    if (fread(buffer.data(), length, 1, file) != 1) {
+    contents.resize(length);
+    if (length && fread(contents.data(), length, 1, file) != 1) {
         perror("fread failed");
-        return;
+        return false;
     }
+    return true;
+}
 
-    deleter.reset();
+// Touches every cache line of a buffer larger than the last-level cache, so
+// the next parse finds neither its input nor its allocator's memory cached.
+class cache_evictor {
+public:
+    explicit cache_evictor(size_t bytes)
+        : buffer(bytes)
+        , sink(0) {}
 
-    clock_t minimum_each = std::numeric_limits<clock_t>::max();
+    void evict() {
+        unsigned char sum = 0;
+        for (size_t i = 0; i < buffer.size(); i += 64) {
+            sum += buffer[i];
+            buffer[i] = sum;
+        }
+        sink += sum;
+    }
+
+private:
+    std::vector<unsigned char> buffer;
+    volatile unsigned sink;
+};
 
-    clock_t start = clock();
+#ifdef __linux__
 
-    const size_t N = 1000;
-    for (size_t i = 0; i < N; ++i) {
-        clock_t before_each = clock();
-        sajson::parse(
-            AllocationStrategy(), sajson::string(buffer.data(), buffer.size()));
-        clock_t elapsed_each = clock() - before_each;
-        minimum_each = std::min(minimum_each, elapsed_each);
+// Hardware event counters for the calling thread, opened as one group so
+// they cover exactly the same instructions.  Only user-space events are
+// counted.
+class perf_counters {
+public:
+    perf_counters()
+        : error(0) {
+        for (int k = 0; k < COUNTER_COUNT; ++k) {
+            fds[k] = -1;
+        }
+        static const struct {
+            uint32_t type;
+            uint64_t config;
+        } events[COUNTER_COUNT] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            { PERF_TYPE_HW_CACHE,
+              PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                  | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        };
+        for (int k = 0; k < COUNTER_COUNT; ++k) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[k].type;
+            attr.config = events[k].config;
+            attr.disabled = k == CYCLES;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP
+                | PERF_FORMAT_TOTAL_TIME_ENABLED
+                | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[k] = static_cast<int>(syscall(
+                __NR_perf_event_open, &attr, 0, -1, fds[CYCLES], 0));
+            if (fds[k] >= 0) {
+                order.push_back(static_cast<counter_kind>(k));
+            } else if (k == CYCLES) {
+                // Without the group leader nothing else can be counted.
+                error = errno;
+                return;
+            }
+        }
     }
 
-    clock_t elapsed = clock() - start;
+    ~perf_counters() {
+        for (int k = COUNTER_COUNT; k > 0; --k) {
+            if (fds[k - 1] >= 0) {
+                close(fds[k - 1]);
+            }
+        }
+    }
 
-    double average_elapsed_ms = 1000.0 * elapsed / CLOCKS_PER_SEC / N;
-    double minimum_elapsed_ms = 1000.0 * minimum_each / CLOCKS_PER_SEC;
-    printf(
-        "%*s - %0.3f ms - %0.3f ms\n",
-        static_cast<int>(max_string_length),
-        filename,
-        average_elapsed_ms,
-        minimum_elapsed_ms);
+    bool is_available() const { return fds[CYCLES] >= 0; }
+
+    const char* get_error() const { return strerror(error); }
+
+    bool has(counter_kind k) const { return fds[k] >= 0; }
+
+    void start() {
+        ioctl(fds[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    /// Stops counting and adds the counts since start() to totals.  Returns
+    /// false if the group never got onto the PMU.
+    bool stop(double totals[COUNTER_COUNT]) {
+        ioctl(fds[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // nr, time enabled, time running, then one value per event.
+        uint64_t data[3 + COUNTER_COUNT];
+        ssize_t n = read(fds[CYCLES], data, sizeof(data));
+        if (n < static_cast<ssize_t>((3 + order.size()) * sizeof(uint64_t))
+            || data[2] == 0) {
+            return false;
+        }
+        // Scale up if the group was multiplexed off the PMU for a while.
+        const double scale = static_cast<double>(data[1]) / data[2];
+        for (size_t i = 0; i < order.size(); ++i) {
+            totals[order[i]] += data[3 + i] * scale;
+        }
+        return true;
+    }
+
+private:
+    perf_counters(const perf_counters&) = delete;
+    void operator=(const perf_counters&) = delete;
+
+    int fds[COUNTER_COUNT];
+    std::vector<counter_kind> order;
+    int error;
+};
+
+#else
+
+class perf_counters {
+public:
+    bool is_available() const { return false; }
+    const char* get_error() const { return "not supported on this platform"; }
+    bool has(counter_kind) const { return false; }
+    void start() {}
+    bool stop(double*) { return false; }
+};
+
+#endif
+
+// The nearest-rank percentile of sorted samples.
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    return sorted[std::max<size_t>(rank, 1) - 1];
 }
 
-template <typename AllocationStrategy>
-void run_all(size_t files_count, const char** files) {
-    size_t max_string_length = 0;
-    for (size_t i = 0; i < files_count; ++i) {
-        max_string_length = std::max(max_string_length, strlen(files[i]));
+// Evicts the caches and counts hardware events around each parse, as
+// requested.
+class parse_hooks {
+public:
+    parse_hooks(cache_evictor* evictor_, perf_counters* counters_)
+        : evictor(evictor_)
+        , counters(counters_)
+        , totals()
+        , counted(0) {}
+
+    void before_parse() {
+        if (evictor) {
+            evictor->evict();
+        }
+        if (counters) {
+            counters->start();
+        }
+    }
+
+    void after_parse() {
+        if (counters && counters->stop(totals)) {
+            ++counted;
+        }
+    }
+
+    // Events per parse of kind, or negative if not counted.
+    double get_average(counter_kind kind) const {
+        return counted && counters->has(kind) ? totals[kind] / counted : -1.0;
+    }
+
+private:
+    cache_evictor* evictor;
+    perf_counters* counters;
+    double totals[COUNTER_COUNT];
+    size_t counted;
+};
+
+bool run(
+    const options& opts,
+    const std::string& file,
+    const std::vector<char>& input,
+    strategy_kind strategy,
+    cache_evictor* evictor,
+    perf_counters* counters,
+    result& out) {
+    out.file = file;
+    out.strategy = strategy;
+    out.cold = evictor != 0;
+    parse_hooks hooks(evictor, counters);
+    std::vector<double> samples;
+    if (!time_parses(
+            strategy,
+            input,
+            opts.min_time_ms,
+            opts.min_iterations,
+            hooks,
+            samples)) {
+        fprintf(
+            stderr,
+            "%s: %s: parse failed\n",
+            file.c_str(),
+            strategy_names[strategy]);
+        return false;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double s : samples) {
+        total += s;
+    }
+    const size_t length = input.size();
+    out.bytes = length;
+    out.iterations = samples.size();
+    out.min_ns = samples.front();
+    out.mean_ns = total / samples.size();
+    out.p50_ns = percentile(samples, 50);
+    out.p90_ns = percentile(samples, 90);
+    out.p99_ns = percentile(samples, 99);
+    for (int k = 0; k < COUNTER_COUNT; ++k) {
+        const double average = hooks.get_average(static_cast<counter_kind>(k));
+        out.per_byte[k] = average < 0 ? -1.0 : average / length;
     }
+    return true;
+}
+
+const char* const counter_columns[] = {
+    "cyc/B", "ins/B", "IPC", "brmiss/B", "L1Dmiss/B", "LLCmiss/B",
+};
+const size_t counter_column_count
+    = sizeof(counter_columns) / sizeof(*counter_columns);
+
+void print_table_header(size_t file_width, bool counters) {
     printf(
-        "%*s - %8s - %8s\n",
-        static_cast<int>(max_string_length),
+        "%-*s - %-7s - %-4s - %7s - %7s - %9s - %9s - %9s",
+        static_cast<int>(file_width),
         "file",
-        "avg",
-        "min");
+        "alloc",
+        "mode",
+        "GB/s",
+        "ns/B",
+        "p50 us",
+        "p90 us",
+        "p99 us");
+    for (size_t i = 0; counters && i < counter_column_count; ++i) {
+        printf(" - %9s", counter_columns[i]);
+    }
     printf(
-        "%*s - %8s - %8s\n",
-        static_cast<int>(max_string_length),
+        "\n%-*s - %-7s - %-4s - %7s - %7s - %9s - %9s - %9s",
+        static_cast<int>(file_width),
+        "----",
+        "-----",
+        "----",
         "----",
-        "---",
-        "---");
-    for (size_t i = 0; i < files_count; ++i) {
-        run_benchmark<AllocationStrategy>(max_string_length, files[i]);
+        "----",
+        "------",
+        "------",
+        "------");
+    for (size_t i = 0; counters && i < counter_column_count; ++i) {
+        printf(" - %9s", std::string(strlen(counter_columns[i]), '-').c_str());
     }
+    printf("\n");
 }
 
-int main(int argc, const char** argv) {
-    if (argc > 1) {
-        // printf("\n=== SINGLE ALLOCATION ===\n\n");
-        run_all<sajson::single_allocation>(argc - 1, argv + 1);
-        // printf("\n=== DYNAMIC ALLOCATION ===\n\n");
-        // run_all<sajson::dynamic_allocation>(argc - 1, argv + 1);
+void print_counter(double value) {
+    if (value < 0) {
+        printf(" - %9s", "n/a");
     } else {
-        // printf("\n=== SINGLE ALLOCATION ===\n\n");
-        run_all<sajson::single_allocation>(default_files_count, default_files);
-        // printf("\n=== DYNAMIC ALLOCATION ===\n\n");
-        // run_all<sajson::dynamic_allocation>(default_files_count,
-        // default_files);
+        printf(" - %9.4f", value);
+    }
+}
+
+void print_table_row(size_t file_width, const result& r, bool counters) {
+    printf(
+        "%-*s - %-7s - %-4s - %7.3f - %7.3f - %9.3f - %9.3f - %9.3f",
+        static_cast<int>(file_width),
+        r.file.c_str(),
+        strategy_names[r.strategy],
+        r.cold ? "cold" : "warm",
+        r.bytes / r.p50_ns,
+        r.p50_ns / r.bytes,
+        r.p50_ns / 1000.0,
+        r.p90_ns / 1000.0,
+        r.p99_ns / 1000.0);
+    if (counters) {
+        const double cycles = r.per_byte[CYCLES];
+        const double instructions = r.per_byte[INSTRUCTIONS];
+        print_counter(cycles);
+        print_counter(instructions);
+        print_counter(
+            cycles > 0 && instructions >= 0 ? instructions / cycles : -1.0);
+        print_counter(r.per_byte[BRANCH_MISSES]);
+        print_counter(r.per_byte[L1D_MISSES]);
+        print_counter(r.per_byte[LLC_MISSES]);
+    }
+    printf("\n");
+}
+
+void print_json(const options& opts, const std::vector<result>& results) {
+    sajson::writer w(2);
+    w.begin_object();
+    w.key("build");
+    w.begin_object();
+#ifdef __VERSION__
+    w.key("compiler");
+    w.string(__VERSION__);
+#endif
+    w.key("word_bits");
+    w.int64(sizeof(size_t) * 8);
+    w.key("min_time_ms");
+    w.double_(opts.min_time_ms);
+    w.key("evict_bytes");
+    w.int64(opts.evict_bytes);
+    w.end_object();
+
+    w.key("results");
+    w.begin_array();
+    for (const result& r : results) {
+        w.begin_object();
+        w.key("file");
+        w.string(sajson::string(r.file.data(), r.file.size()));
+        w.key("strategy");
+        w.string(strategy_names[r.strategy]);
+        w.key("cache");
+        w.string(r.cold ? "cold" : "warm");
+        w.key("bytes");
+        w.int64(r.bytes);
+        w.key("iterations");
+        w.int64(r.iterations);
+        w.key("min_ns");
+        w.double_(r.min_ns);
+        w.key("mean_ns");
+        w.double_(r.mean_ns);
+        w.key("p50_ns");
+        w.double_(r.p50_ns);
+        w.key("p90_ns");
+        w.double_(r.p90_ns);
+        w.key("p99_ns");
+        w.double_(r.p99_ns);
+        w.key("gb_per_s");
+        w.double_(r.bytes / r.p50_ns);
+        w.key("ns_per_byte");
+        w.double_(r.p50_ns / r.bytes);
+        if (r.per_byte[CYCLES] >= 0) {
+            w.key("per_byte");
+            w.begin_object();
+            for (int k = 0; k < COUNTER_COUNT; ++k) {
+                if (r.per_byte[k] >= 0) {
+                    w.key(counter_names[k]);
+                    w.double_(r.per_byte[k]);
+                }
+            }
+            w.end_object();
+            if (r.per_byte[INSTRUCTIONS] >= 0 && r.per_byte[CYCLES] > 0) {
+                w.key("ipc");
+                w.double_(r.per_byte[INSTRUCTIONS] / r.per_byte[CYCLES]);
+            }
+        }
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+
+    const sajson::string output = w.get_output();
+    fwrite(output.data(), 1, output.length(), stdout);
+    putchar('\n');
+}
+
+bool starts_with(const char* s, const char* prefix, const char** rest) {
+    size_t n = strlen(prefix);
+    if (strncmp(s, prefix, n)) {
+        return false;
+    }
+    *rest = s + n;
+    return true;
+}
+
+bool parse_options(int argc, const char** argv, options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* rest;
+        if (!strcmp(arg, "--json")) {
+            opts.json = true;
+        } else if (!strcmp(arg, "--counters")) {
+            opts.counters = true;
+        } else if (starts_with(arg, "--strategy=", &rest)) {
+            strategy_kind strategy;
+            if (!find_strategy(rest, &strategy)) {
+                fprintf(stderr, "unknown strategy: %s\n", rest);
+                return false;
+            }
+            opts.strategies.push_back(strategy);
+        } else if (starts_with(arg, "--cache=", &rest)) {
+            opts.warm = !strcmp(rest, "warm") || !strcmp(rest, "both");
+            opts.cold = !strcmp(rest, "cold") || !strcmp(rest, "both");
+            if (!opts.warm && !opts.cold) {
+                fprintf(stderr, "unknown cache mode: %s\n", rest);
+                return false;
+            }
+        } else if (starts_with(arg, "--evict-mb=", &rest)) {
+            opts.evict_bytes = strtoul(rest, 0, 10) << 20;
+        } else if (starts_with(arg, "--min-time=", &rest)) {
+            opts.min_time_ms = strtod(rest, 0);
+        } else if (starts_with(arg, "--min-iterations=", &rest)) {
+            opts.min_iterations = std::max<size_t>(strtoul(rest, 0, 10), 1);
+        } else if (arg[0] == '-' && arg[1] == '-') {
+            fprintf(stderr, "unknown option: %s\n", arg);
+            return false;
+        } else {
+            opts.files.push_back(arg);
+        }
+    }
+    if (opts.strategies.empty()) {
+        opts.strategies = { SINGLE, DYNAMIC, BOUNDED };
+    }
+    if (opts.files.empty()) {
+        opts.files.assign(default_files, default_files + default_files_count);
+    }
+    return true;
+}
+
+int main(int argc, const char** argv) {
+    options opts;
+    if (!parse_options(argc, argv, opts)) {
+        return 2;
+    }
+
+    std::unique_ptr<cache_evictor> evictor;
+    if (opts.cold) {
+        evictor.reset(new cache_evictor(opts.evict_bytes));
+    }
+
+    std::unique_ptr<perf_counters> counters;
+    if (opts.counters) {
+        counters.reset(new perf_counters);
+        if (!counters->is_available()) {
+            fprintf(
+                stderr,
+                "hardware counters unavailable: %s\n",
+                counters->get_error());
+            counters.reset();
+        }
+    }
+
+    size_t file_width = 4;
+    for (const auto& file : opts.files) {
+        file_width = std::max(file_width, file.size());
+    }
+    if (!opts.json) {
+        print_table_header(file_width, counters != nullptr);
+    }
+
+    std::vector<result> results;
+    bool ok = true;
+    for (const auto& file : opts.files) {
+        std::vector<char> input;
+        if (!read_file(file.c_str(), input)) {
+            ok = false;
+            continue;
+        }
+        for (int cold = 0; cold < 2; ++cold) {
+            if (!(cold ? opts.cold : opts.warm)) {
+                continue;
+            }
+            for (strategy_kind strategy : opts.strategies) {
+                result r;
+                if (!run(opts,
+                         file,
+                         input,
+                         strategy,
+                         cold ? evictor.get() : 0,
+                         counters.get(),
+                         r)) {
+                    ok = false;
+                    continue;
+                }
+                if (!opts.json) {
+                    print_table_row(file_width, r, counters != nullptr);
+                }
+                results.push_back(r);
+            }
+        }
+    }
+
+    if (opts.json) {
+        print_json(opts, results);
     }
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,215 @@
+// Compares parse_gzip and parse_zstd against decompressing into a scratch
+// buffer by hand and parsing it in place.  Both do the same work, so the
+// ratio should stay near 1; it shows any overhead the wrappers add, such as
+// growing the buffer past a wrong size hint.
+
+#include <sajson_compressed.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+const char* default_files[] = {
+    "testdata/apache_builds.json", "testdata/github_events.json",
+    "testdata/instruments.json",   "testdata/mesh.json",
+    "testdata/mesh.pretty.json",   "testdata/nested.json",
+    "testdata/svg_menu.json",      "testdata/truenull.json",
+    "testdata/twitter.json",       "testdata/update-center.json",
+    "testdata/whitespace.json",
+};
+const size_t default_files_count
+    = sizeof(default_files) / sizeof(*default_files);
+
+const size_t N = 200;
+
+bool read_file(const char* filename, std::vector<char>& buffer) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        perror("fopen failed");
+        return false;
+    }
+
+    std::unique_ptr<FILE, int (*)(FILE*)> deleter(file, fclose);
+
+    if (fseek(file, 0, SEEK_END)) {
+        perror("fseek failed");
+        return false;
+    }
+    size_t length = ftell(file);
+    if (fseek(file, 0, SEEK_SET)) {
+        perror("fseek failed");
+        return false;
+    }
+
+    buffer.resize(length);
+    if (length && fread(buffer.data(), length, 1, file) != 1) {
+        perror("fread failed");
+        return false;
+    }
+    return true;
+}
+
+// Runs fn N times and returns the fastest run in milliseconds.
+template <typename Function>
+double time_minimum_ms(Function fn) {
+    typedef std::chrono::steady_clock clock;
+    clock::duration minimum = clock::duration::max();
+    for (size_t i = 0; i < N; ++i) {
+        clock::time_point before = clock::now();
+        if (!fn()) {
+            fprintf(stderr, "parse failed\n");
+            return 0.0;
+        }
+        minimum = std::min(minimum, clock::now() - before);
+    }
+    return std::chrono::duration<double, std::milli>(minimum).count();
+}
+
+void print_row(
+    size_t max_string_length,
+    const char* filename,
+    const char* format,
+    double by_hand_ms,
+    double wrapper_ms) {
+    printf(
+        "%*s - %4s - %8.3f ms - %8.3f ms - %5.2fx\n",
+        static_cast<int>(max_string_length),
+        filename,
+        format,
+        by_hand_ms,
+        wrapper_ms,
+        by_hand_ms > 0.0 ? wrapper_ms / by_hand_ms : 0.0);
+}
+
+#ifdef SAJSON_HAVE_ZLIB
+
+std::string gzip(const std::vector<char>& text) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    deflateInit2(
+        &zs,
+        Z_DEFAULT_COMPRESSION,
+        Z_DEFLATED,
+        15 + 16,
+        8,
+        Z_DEFAULT_STRATEGY);
+    std::vector<char> out(deflateBound(&zs, text.size()));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    zs.avail_in = static_cast<uInt>(text.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    size_t length = out.size() - zs.avail_out;
+    deflateEnd(&zs);
+    return std::string(out.data(), length);
+}
+
+// The same pipeline by hand: inflate into a scratch buffer sized from the
+// gzip trailer, then parse the buffer in place.
+bool gunzip_then_parse(const std::string& compressed, size_t length) {
+    std::vector<char> text(length);
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    inflateInit2(&zs, 15 + 16);
+    zs.next_in
+        = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    zs.avail_in = static_cast<uInt>(compressed.size());
+    zs.next_out = reinterpret_cast<Bytef*>(text.data());
+    zs.avail_out = static_cast<uInt>(text.size());
+    int rv = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+    if (rv != Z_STREAM_END) {
+        return false;
+    }
+    return sajson::parse(
+               sajson::single_allocation(),
+               sajson::mutable_string_view(text.size(), text.data()))
+        .is_valid();
+}
+
+#endif // SAJSON_HAVE_ZLIB
+
+#ifdef SAJSON_HAVE_ZSTD
+
+std::string zstd(const std::vector<char>& text) {
+    std::vector<char> out(ZSTD_compressBound(text.size()));
+    size_t length
+        = ZSTD_compress(out.data(), out.size(), text.data(), text.size(), 3);
+    return std::string(out.data(), ZSTD_isError(length) ? 0 : length);
+}
+
+bool unzstd_then_parse(const std::string& compressed, size_t length) {
+    std::vector<char> text(length);
+    size_t rv = ZSTD_decompress(
+        text.data(), text.size(), compressed.data(), compressed.size());
+    if (ZSTD_isError(rv)) {
+        return false;
+    }
+    return sajson::parse(
+               sajson::single_allocation(),
+               sajson::mutable_string_view(rv, text.data()))
+        .is_valid();
+}
+
+#endif // SAJSON_HAVE_ZSTD
+
+void run_benchmark(size_t max_string_length, const char* filename) {
+    std::vector<char> text;
+    if (!read_file(filename, text)) {
+        return;
+    }
+
+#ifdef SAJSON_HAVE_ZLIB
+    {
+        const std::string compressed = gzip(text);
+        const sajson::string input(compressed.data(), compressed.size());
+        double by_hand_ms = time_minimum_ms(
+            [&] { return gunzip_then_parse(compressed, text.size()); });
+        double wrapper_ms = time_minimum_ms([&] {
+            return sajson::parse_gzip(sajson::single_allocation(), input)
+                .is_valid();
+        });
+        print_row(max_string_length, filename, "gzip", by_hand_ms, wrapper_ms);
+    }
+#endif
+
+#ifdef SAJSON_HAVE_ZSTD
+    {
+        const std::string compressed = zstd(text);
+        const sajson::string input(compressed.data(), compressed.size());
+        double by_hand_ms = time_minimum_ms(
+            [&] { return unzstd_then_parse(compressed, text.size()); });
+        double wrapper_ms = time_minimum_ms([&] {
+            return sajson::parse_zstd(sajson::single_allocation(), input)
+                .is_valid();
+        });
+        print_row(max_string_length, filename, "zstd", by_hand_ms, wrapper_ms);
+    }
+#endif
+}
+
+int main(int argc, const char** argv) {
+    size_t files_count = default_files_count;
+    const char** files = default_files;
+    if (argc > 1) {
+        files_count = argc - 1;
+        files = argv + 1;
+    }
+
+    size_t max_string_length = 0;
+    for (size_t i = 0; i < files_count; ++i) {
+        max_string_length = std::max(max_string_length, strlen(files[i]));
+    }
+    printf(
+        "%*s - %4s - %11s - %11s - %6s\n",
+        static_cast<int>(max_string_length),
+        "file",
+        "fmt",
+        "by hand",
+        "wrapper",
+        "ratio");
+    for (size_t i = 0; i < files_count; ++i) {
+        run_benchmark(max_string_length, files[i]);
+    }
+}
@@ -0,0 +1,317 @@
+// Synthetic JSON documents whose shape is set by a handful of parameters,
+// for mapping how parse throughput depends on the data rather than on
+// whichever files happen to be in testdata.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct corpus_parameters {
+    corpus_parameters()
+        : size(1 << 20)
+        , depth(3)
+        , width(8)
+        , string_min(4)
+        , string_max(16)
+        , string_ratio(0.5)
+        , double_ratio(0.5)
+        , escape_density(0)
+        , non_ascii_density(0)
+        , whitespace(0)
+        , duplicate_key_ratio(0)
+        , seed(1) {}
+
+    /// Approximate document size in bytes.  The root array holds as many
+    /// records as it takes to reach it.
+    size_t size;
+    /// Containers per record, each nested in the last.  Levels alternate
+    /// between objects and arrays, starting with an object.
+    size_t depth;
+    /// Members or elements per container.
+    size_t width;
+    /// String values are between string_min and string_max characters
+    /// long, uniformly distributed.
+    size_t string_min;
+    size_t string_max;
+    /// The fraction of scalar values that are strings; the rest are
+    /// numbers.
+    double string_ratio;
+    /// The fraction of numbers that are doubles; the rest are integers.
+    double double_ratio;
+    /// The fraction of string characters written as escape sequences.
+    double escape_density;
+    /// The fraction of string characters outside ASCII, written as raw
+    /// two-, three-, and four-byte UTF-8.
+    double non_ascii_density;
+    /// Whitespace bytes before each token: a newline and then spaces.
+    size_t whitespace;
+    /// The fraction of object keys that repeat an earlier key in the same
+    /// object.
+    double duplicate_key_ratio;
+    uint64_t seed;
+};
+
+/// Sets the parameter called name (as in the --name=value options, with
+/// dashes) from value.  "string-length" sets both string bounds.  Returns
+/// false if there is no such parameter.
+inline bool set_corpus_parameter(
+    corpus_parameters& p, const std::string& name, double value) {
+    const size_t count = value < 0 ? 0 : static_cast<size_t>(value);
+    if (name == "size") {
+        p.size = count;
+    } else if (name == "depth") {
+        p.depth = count ? count : 1;
+    } else if (name == "width") {
+        p.width = count ? count : 1;
+    } else if (name == "string-length") {
+        p.string_min = p.string_max = count;
+    } else if (name == "string-min") {
+        p.string_min = count;
+    } else if (name == "string-max") {
+        p.string_max = count;
+    } else if (name == "string-ratio") {
+        p.string_ratio = value;
+    } else if (name == "double-ratio") {
+        p.double_ratio = value;
+    } else if (name == "escape-density") {
+        p.escape_density = value;
+    } else if (name == "non-ascii-density") {
+        p.non_ascii_density = value;
+    } else if (name == "whitespace") {
+        p.whitespace = count;
+    } else if (name == "duplicate-key-ratio") {
+        p.duplicate_key_ratio = value;
+    } else if (name == "seed") {
+        p.seed = count;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// Applies an option of the form --name=value.  Returns false if arg is not
+/// a corpus parameter.
+inline bool parse_corpus_option(const char* arg, corpus_parameters& p) {
+    const char* equals = strchr(arg, '=');
+    if (strncmp(arg, "--", 2) || !equals) {
+        return false;
+    }
+    return set_corpus_parameter(
+        p, std::string(arg + 2, equals), strtod(equals + 1, 0));
+}
+
+inline const char* corpus_options_help() {
+    return "  --size=BYTES               approximate document size\n"
+           "  --depth=N                  nested containers per record\n"
+           "  --width=N                  members or elements per container\n"
+           "  --string-length=N          string length in characters, or\n"
+           "  --string-min=N             a uniform range\n"
+           "  --string-max=N\n"
+           "  --string-ratio=F           strings among scalar values\n"
+           "  --double-ratio=F           doubles among numbers\n"
+           "  --escape-density=F         escaped string characters\n"
+           "  --non-ascii-density=F      non-ASCII string characters\n"
+           "  --whitespace=N             whitespace bytes before each token\n"
+           "  --duplicate-key-ratio=F    keys repeated within an object\n"
+           "  --seed=N                   random seed\n";
+}
+
+class corpus_generator {
+public:
+    explicit corpus_generator(const corpus_parameters& params_)
+        : params(params_)
+        , state(params_.seed) {}
+
+    /// Returns a document made of records shaped by the parameters.  The
+    /// same parameters always produce the same document.
+    std::string generate() {
+        std::string out;
+        out.reserve(params.size + params.size / 8);
+        out += '[';
+        do {
+            if (out.size() > 1) {
+                out += ',';
+            }
+            space(out);
+            container(out, params.depth, true);
+        } while (out.size() < params.size);
+        space(out);
+        out += ']';
+        return out;
+    }
+
+private:
+    // splitmix64: fast, and identical on every platform, unlike the
+    // standard library's distributions.
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return (next() >> 11) * (1.0 / (1ull << 53)); }
+
+    size_t below(size_t n) { return n ? next() % n : 0; }
+
+    bool chance(double probability) { return uniform() < probability; }
+
+    void space(std::string& out) {
+        if (params.whitespace) {
+            out += '\n';
+            out.append(params.whitespace - 1, ' ');
+        }
+    }
+
+    // A container of width children; the last one is the next level down.
+    void container(std::string& out, size_t depth, bool is_object) {
+        std::vector<std::string> keys;
+        out += is_object ? '{' : '[';
+        for (size_t i = 0; i < params.width; ++i) {
+            if (i) {
+                out += ',';
+            }
+            space(out);
+            if (is_object) {
+                key(out, keys);
+                space(out);
+                out += ':';
+                space(out);
+            }
+            if (depth > 1 && i + 1 == params.width) {
+                container(out, depth - 1, !is_object);
+            } else {
+                scalar(out);
+            }
+        }
+        space(out);
+        out += is_object ? '}' : ']';
+    }
+
+    void key(std::string& out, std::vector<std::string>& keys) {
+        std::string k;
+        if (!keys.empty() && chance(params.duplicate_key_ratio)) {
+            k = keys[below(keys.size())];
+        } else {
+            const size_t length = 3 + below(10);
+            for (size_t i = 0; i < length; ++i) {
+                k += static_cast<char>('a' + below(26));
+            }
+            keys.push_back(k);
+        }
+        out += '"';
+        out += k;
+        out += '"';
+    }
+
+    void scalar(std::string& out) {
+        if (chance(params.string_ratio)) {
+            string(out);
+        } else if (chance(params.double_ratio)) {
+            double_(out);
+        } else {
+            integer(out);
+        }
+    }
+
+    void string(std::string& out) {
+        static const char* const escapes[]
+            = { "\\\"", "\\\\", "\\/", "\\n", "\\t", "\\u00e9", "\\u20ac",
+                "\\ud83d\\ude00" };
+        static const char alphabet[]
+            = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ";
+        const size_t span = params.string_max > params.string_min
+            ? params.string_max - params.string_min + 1
+            : 1;
+        const size_t length = params.string_min + below(span);
+        out += '"';
+        for (size_t i = 0; i < length; ++i) {
+            const double r = uniform();
+            if (r < params.escape_density) {
+                out += escapes[below(sizeof(escapes) / sizeof(*escapes))];
+            } else if (r < params.escape_density + params.non_ascii_density) {
+                non_ascii(out);
+            } else {
+                out += alphabet[below(sizeof(alphabet) - 1)];
+            }
+        }
+        out += '"';
+    }
+
+    void non_ascii(std::string& out) {
+        unsigned c;
+        switch (below(3)) {
+        case 0: // Latin-1 Supplement and Latin Extended.
+            c = 0xc0 + static_cast<unsigned>(below(0x200));
+            break;
+        case 1: // CJK Unified Ideographs.
+            c = 0x4e00 + static_cast<unsigned>(below(0x5200));
+            break;
+        default: // Emoji.
+            c = 0x1f600 + static_cast<unsigned>(below(0x50));
+            break;
+        }
+        if (c < 0x800) {
+            out += static_cast<char>(0xc0 | (c >> 6));
+        } else if (c < 0x10000) {
+            out += static_cast<char>(0xe0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        }
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+
+    static unsigned long power_of_ten(size_t exponent) {
+        unsigned long rv = 1;
+        while (exponent--) {
+            rv *= 10;
+        }
+        return rv;
+    }
+
+    // Integers fit in 32 bits, with magnitudes spread evenly over 1 to 9
+    // digits.
+    void integer(std::string& out) {
+        const unsigned long magnitude = power_of_ten(below(9));
+        const unsigned long value = magnitude + below(magnitude * 9);
+        char buffer[16];
+        snprintf(
+            buffer, sizeof(buffer), "%s%lu", chance(0.25) ? "-" : "", value);
+        out += buffer;
+    }
+
+    // Doubles have up to 6 integer and 1 to 8 fraction digits, and
+    // sometimes an exponent.
+    void double_(std::string& out) {
+        const size_t fraction_digits = 1 + below(8);
+        char buffer[48];
+        int length = snprintf(
+            buffer,
+            sizeof(buffer),
+            "%s%lu.%0*lu",
+            chance(0.25) ? "-" : "",
+            static_cast<unsigned long>(below(1000000)),
+            static_cast<int>(fraction_digits),
+            static_cast<unsigned long>(
+                below(power_of_ten(fraction_digits))));
+        if (chance(0.125)) {
+            snprintf(
+                buffer + length,
+                sizeof(buffer) - length,
+                "e%d",
+                static_cast<int>(below(61)) - 30);
+        }
+        out += buffer;
+    }
+
+    const corpus_parameters params;
+    uint64_t state;
+};
@@ -0,0 +1,58 @@
+// Writes a synthetic JSON document shaped by the options in corpus.h.
+//
+// usage: generate_json [options] [output]
+
+#include "corpus.h"
+
+#include <sajson.h>
+
+int main(int argc, const char** argv) {
+    corpus_parameters params;
+    const char* output = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (parse_corpus_option(argv[i], params)) {
+            continue;
+        }
+        if (argv[i][0] == '-' || output) {
+            fprintf(
+                stderr,
+                "usage: generate_json [options] [output]\n\n%s",
+                corpus_options_help());
+            return 2;
+        }
+        output = argv[i];
+    }
+
+    std::string document = corpus_generator(params).generate();
+
+    // Catch generator bugs before anyone benchmarks them.
+    std::string copy = document;
+    const sajson::document parsed = sajson::parse(
+        sajson::dynamic_allocation(),
+        sajson::mutable_string_view(copy.size(), &copy[0]));
+    if (!parsed.is_valid()) {
+        fprintf(
+            stderr,
+            "generated invalid JSON at %zu:%zu: %s\n",
+            parsed.get_error_line(),
+            parsed.get_error_column(),
+            parsed.get_error_message_as_cstring());
+        return 1;
+    }
+
+    FILE* file = output ? fopen(output, "wb") : stdout;
+    if (!file) {
+        perror("fopen failed");
+        return 1;
+    }
+    bool ok = fwrite(document.data(), 1, document.size(), file)
+        == document.size();
+    if (output) {
+        ok = fclose(file) == 0 && ok;
+    }
+    if (!ok) {
+        perror("write failed");
+        return 1;
+    }
+    return 0;
+}
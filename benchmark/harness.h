@@ -0,0 +1,142 @@
+// The allocation strategies and the timing loop shared by bench and
+// bench_sweep, so that both measure a parse the same way.
+
+#pragma once
+
+#include <sajson.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include <vector>
+
+enum strategy_kind { SINGLE, DYNAMIC, BOUNDED };
+const char* const strategy_names[] = { "single", "dynamic", "bounded" };
+const size_t strategy_count = sizeof(strategy_names) / sizeof(*strategy_names);
+
+/// Sets *out to the strategy called name.  Returns false if there is none.
+inline bool find_strategy(const char* name, strategy_kind* out) {
+    for (size_t k = 0; k < strategy_count; ++k) {
+        if (!strcmp(name, strategy_names[k])) {
+            *out = static_cast<strategy_kind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+// bounded_allocation keeps the parse stack and the AST in the one buffer.
+// Dense documents such as [1,1,...] need about one and a half words per input
+// byte, so start there and double the buffer until the parse stops running
+// out of memory.  Called once, outside the timed region.
+inline std::vector<size_t> bounded_buffer_for(const std::vector<char>& input) {
+    std::vector<size_t> buffer(input.size() + input.size() / 2 + 2);
+    for (;;) {
+        std::vector<char> copy = input;
+        const sajson::document document = sajson::parse(
+            sajson::bounded_allocation(buffer.data(), buffer.size()),
+            sajson::mutable_string_view(copy.size(), copy.data()));
+        if (document._internal_get_error_code()
+            != sajson::ERROR_OUT_OF_MEMORY) {
+            return buffer;
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+}
+
+/// Hooks for time_parses() that do nothing.
+struct no_parse_hooks {
+    void before_parse() {}
+    void after_parse() {}
+};
+
+/// Parses input in place until there are at least min_iterations samples
+/// and min_time_ms has passed, appending each parse's time in nanoseconds
+/// to samples.  Every parse runs on a fresh copy made outside the timed
+/// region, and the time includes allocating the AST and destroying the
+/// document.  hooks.before_parse() and hooks.after_parse() run around each
+/// parse, also outside the timed region.  Returns false if input does not
+/// parse.
+template <typename AllocationStrategy, typename Hooks>
+bool time_parses(
+    const AllocationStrategy& strategy,
+    const std::vector<char>& input,
+    double min_time_ms,
+    size_t min_iterations,
+    Hooks& hooks,
+    std::vector<double>& samples) {
+    typedef std::chrono::steady_clock clock;
+    const size_t length = input.size();
+    std::vector<char> working(length);
+    const size_t first = samples.size();
+
+    const clock::time_point start = clock::now();
+    for (;;) {
+        std::copy(input.begin(), input.end(), working.begin());
+        hooks.before_parse();
+        const clock::time_point before = clock::now();
+        bool valid;
+        {
+            const sajson::document document = sajson::parse(
+                strategy, sajson::mutable_string_view(length, working.data()));
+            valid = document.is_valid();
+        }
+        const clock::time_point after = clock::now();
+        hooks.after_parse();
+
+        if (!valid) {
+            return false;
+        }
+        samples.push_back(
+            std::chrono::duration<double, std::nano>(after - before).count());
+
+        const double elapsed_ms
+            = std::chrono::duration<double, std::milli>(clock::now() - start)
+                  .count();
+        if (samples.size() - first >= min_iterations
+            && elapsed_ms >= min_time_ms) {
+            return true;
+        }
+    }
+}
+
+/// Like the templated time_parses(), with the allocation strategy chosen at
+/// run time.
+template <typename Hooks>
+bool time_parses(
+    strategy_kind strategy,
+    const std::vector<char>& input,
+    double min_time_ms,
+    size_t min_iterations,
+    Hooks& hooks,
+    std::vector<double>& samples) {
+    switch (strategy) {
+    case SINGLE:
+        return time_parses(
+            sajson::single_allocation(),
+            input,
+            min_time_ms,
+            min_iterations,
+            hooks,
+            samples);
+    case DYNAMIC:
+        return time_parses(
+            sajson::dynamic_allocation(),
+            input,
+            min_time_ms,
+            min_iterations,
+            hooks,
+            samples);
+    case BOUNDED: {
+        std::vector<size_t> buffer = bounded_buffer_for(input);
+        return time_parses(
+            sajson::bounded_allocation(buffer.data(), buffer.size()),
+            input,
+            min_time_ms,
+            min_iterations,
+            hooks,
+            samples);
+    }
+    }
+    return false;
+}
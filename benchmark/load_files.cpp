@@ -0,0 +1,165 @@
+// Measures how quickly file_loader reads and parses a batch of files, with
+// io_uring and with pread, against a sequential fopen/fread-then-parse loop
+// like benchmark.cpp's.  The batch is the test documents, repeated; they are
+// read once beforehand so every run is served from the page cache.
+//
+// usage: bench_load_files [threads [repeat]]
+
+#include <sajson_loader.h>
+
+#include <chrono>
+#include <memory>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+const char* default_files[] = {
+    "testdata/apache_builds.json", "testdata/github_events.json",
+    "testdata/instruments.json",   "testdata/mesh.json",
+    "testdata/mesh.pretty.json",   "testdata/nested.json",
+    "testdata/svg_menu.json",      "testdata/truenull.json",
+    "testdata/twitter.json",       "testdata/update-center.json",
+    "testdata/whitespace.json",
+};
+const size_t default_files_count
+    = sizeof(default_files) / sizeof(*default_files);
+
+// Reads and parses each file in turn, returning the number that parsed.
+size_t load_sequentially(const std::vector<std::string>& paths) {
+    size_t valid = 0;
+    std::vector<char> buffer;
+    for (const auto& path : paths) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            perror("fopen failed");
+            continue;
+        }
+        std::unique_ptr<FILE, int (*)(FILE*)> deleter(file, fclose);
+        if (fseek(file, 0, SEEK_END)) {
+            perror("fseek failed");
+            continue;
+        }
+        size_t length = ftell(file);
+        if (fseek(file, 0, SEEK_SET)) {
+            perror("fseek failed");
+            continue;
+        }
+        buffer.resize(length);
+        if (length && fread(buffer.data(), length, 1, file) != 1) {
+            perror("fread failed");
+            continue;
+        }
+        const sajson::document document = sajson::parse(
+            sajson::single_allocation(),
+            sajson::mutable_string_view(length, buffer.data()));
+        valid += document.is_valid();
+    }
+    return valid;
+}
+
+size_t load_with_loader(
+    const std::vector<std::string>& paths,
+    size_t threads,
+    bool allow_io_uring,
+    bool* used_io_uring) {
+    sajson::file_loader<sajson::single_allocation> loader(
+        sajson::single_allocation(), paths, threads, 64, allow_io_uring);
+    *used_io_uring = loader.is_using_io_uring();
+    size_t valid = 0;
+    while (loader.remaining()) {
+        valid += loader.next().doc.is_valid();
+    }
+    return valid;
+}
+
+// Returns the fastest of several runs of fn in milliseconds.
+template <typename Function>
+double time_minimum_ms(Function fn) {
+    typedef std::chrono::steady_clock clock;
+    double best_ms = 0.0;
+    for (int run = 0; run < 5; ++run) {
+        clock::time_point before = clock::now();
+        fn();
+        double ms
+            = std::chrono::duration<double, std::milli>(clock::now() - before)
+                  .count();
+        if (run == 0 || ms < best_ms) {
+            best_ms = ms;
+        }
+    }
+    return best_ms;
+}
+
+void print_row(const char* name, double ms, size_t bytes, double baseline) {
+    printf(
+        "%-18s - %9.3f - %9.1f - %6.2fx\n",
+        name,
+        ms,
+        bytes / 1000.0 / ms,
+        baseline / ms);
+}
+
+int main(int argc, const char** argv) {
+    size_t threads = std::thread::hardware_concurrency();
+    if (argc > 1) {
+        threads = strtoul(argv[1], 0, 10);
+    }
+    if (!threads) {
+        threads = 1;
+    }
+    size_t repeat = argc > 2 ? strtoul(argv[2], 0, 10) : 20;
+
+    std::vector<std::string> paths;
+    for (size_t r = 0; r < repeat; ++r) {
+        paths.insert(
+            paths.end(), default_files, default_files + default_files_count);
+    }
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < default_files_count; ++i) {
+        struct stat st;
+        if (stat(default_files[i], &st)) {
+            perror(default_files[i]);
+            return 1;
+        }
+        bytes += st.st_size * repeat;
+    }
+    // Also warms the page cache.
+    const size_t expected = load_sequentially(paths);
+
+    printf(
+        "%zu files, %.1f MB, %zu threads\n\n",
+        paths.size(),
+        bytes / 1000000.0,
+        threads);
+    printf("%-18s - %9s - %9s - %7s\n", "loader", "ms", "MB/s", "speedup");
+    printf("%-18s - %9s - %9s - %7s\n", "------", "--", "----", "-------");
+
+    size_t valid = 0;
+    const double sequential_ms
+        = time_minimum_ms([&] { valid = load_sequentially(paths); });
+    print_row("sequential fread", sequential_ms, bytes, sequential_ms);
+
+    bool used_io_uring = false;
+    const double pread_ms = time_minimum_ms([&] {
+        valid = load_with_loader(paths, threads, false, &used_io_uring);
+    });
+    if (valid != expected) {
+        fprintf(stderr, "loaders disagree\n");
+        return 1;
+    }
+    print_row("file_loader pread", pread_ms, bytes, sequential_ms);
+
+    const double io_uring_ms = time_minimum_ms([&] {
+        valid = load_with_loader(paths, threads, true, &used_io_uring);
+    });
+    if (valid != expected) {
+        fprintf(stderr, "loaders disagree\n");
+        return 1;
+    }
+    if (used_io_uring) {
+        print_row("file_loader uring", io_uring_ms, bytes, sequential_ms);
+    } else {
+        printf("io_uring unavailable\n");
+    }
+}
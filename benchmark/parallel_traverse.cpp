@@ -0,0 +1,206 @@
+// Measures how parallel_map_reduce scales with thread count when walking
+// the elements of one large array, against a single-threaded sajson::visit.
+// The array's elements are the test documents, repeated.
+//
+// usage: bench_parallel_traverse [max_threads [element_count]]
+
+#include <sajson_parallel.h>
+
+#include <chrono>
+#include <memory>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+const char* element_files[] = {
+    "testdata/apache_builds.json", "testdata/github_events.json",
+    "testdata/instruments.json",   "testdata/svg_menu.json",
+    "testdata/truenull.json",      "testdata/twitter.json",
+    "testdata/update-center.json",
+};
+const size_t element_files_count
+    = sizeof(element_files) / sizeof(*element_files);
+
+struct counts {
+    counts()
+        : nodes(0)
+        , string_length(0)
+        , number_total(0) {}
+
+    counts& operator+=(const counts& other) {
+        nodes += other.nodes;
+        string_length += other.string_length;
+        number_total += other.number_total;
+        return *this;
+    }
+
+    size_t nodes;
+    size_t string_length;
+    double number_total;
+};
+
+struct counting_visitor {
+    explicit counting_visitor(counts& c_)
+        : c(c_) {}
+
+    void visit_null() { ++c.nodes; }
+
+    void visit_boolean(bool) { ++c.nodes; }
+
+    void visit_integer(int i) {
+        ++c.nodes;
+        c.number_total += i;
+    }
+
+    void visit_double(double d) {
+        ++c.nodes;
+        c.number_total += d;
+    }
+
+    void visit_string(const sajson::string& s) {
+        ++c.nodes;
+        c.string_length += s.length();
+    }
+
+    void visit_array(const sajson::array_range& elements) {
+        ++c.nodes;
+        for (const auto& element : elements) {
+            sajson::visit(element, *this);
+        }
+    }
+
+    void visit_object(const sajson::object_range& members) {
+        ++c.nodes;
+        for (auto it = members.begin(); it != members.end(); ++it) {
+            sajson::visit(it.get_value(), *this);
+        }
+    }
+
+    counts& c;
+};
+
+bool read_file(const char* filename, std::string& contents) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        perror("fopen failed");
+        return false;
+    }
+
+    std::unique_ptr<FILE, int (*)(FILE*)> deleter(file, fclose);
+
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, n);
+    }
+    return !ferror(file);
+}
+
+// Returns the fastest of several runs of fn in milliseconds.
+template <typename Function>
+double time_minimum_ms(Function fn) {
+    typedef std::chrono::steady_clock clock;
+    double best_ms = 0.0;
+    for (int run = 0; run < 5; ++run) {
+        clock::time_point before = clock::now();
+        fn();
+        double ms
+            = std::chrono::duration<double, std::milli>(clock::now() - before)
+                  .count();
+        if (run == 0 || ms < best_ms) {
+            best_ms = ms;
+        }
+    }
+    return best_ms;
+}
+
+int main(int argc, const char** argv) {
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (argc > 1) {
+        max_threads = strtoul(argv[1], 0, 10);
+    }
+    if (!max_threads) {
+        max_threads = 1;
+    }
+    size_t element_count = argc > 2 ? strtoul(argv[2], 0, 10) : 300;
+
+    std::vector<std::string> files(element_files_count);
+    for (size_t i = 0; i < element_files_count; ++i) {
+        if (!read_file(element_files[i], files[i])) {
+            return 1;
+        }
+    }
+
+    std::string text = "[";
+    for (size_t i = 0; i < element_count; ++i) {
+        if (i) {
+            text += ',';
+        }
+        text += files[i % files.size()];
+    }
+    text += ']';
+
+    const sajson::document document = sajson::parse(
+        sajson::single_allocation(), sajson::string(text.data(), text.size()));
+    if (!document.is_valid()) {
+        fprintf(stderr, "parse failed\n");
+        return 1;
+    }
+    const sajson::value root = document.get_root();
+
+    counts serial;
+    const double serial_ms = time_minimum_ms([&] {
+        serial = counts();
+        sajson::visit(root, counting_visitor(serial));
+    });
+
+    printf(
+        "%zu elements, %.1f MB, %zu nodes\n\n",
+        element_count,
+        text.size() / 1000000.0,
+        serial.nodes);
+    printf("%7s - %10s - %9s - %7s\n", "threads", "ms", "MB/s", "speedup");
+    printf("%7s - %10s - %9s - %7s\n", "-------", "--", "----", "-------");
+    printf(
+        "%7s - %10.3f - %9.1f - %6.2fx\n",
+        "serial",
+        serial_ms,
+        text.size() / 1000.0 / serial_ms,
+        1.0);
+
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (size_t threads : thread_counts) {
+        sajson::thread_pool pool(threads);
+        counts parallel;
+        const double ms = time_minimum_ms([&] {
+            parallel = sajson::parallel_map_reduce(
+                root,
+                counts(),
+                [](const sajson::value& element) {
+                    counts c;
+                    sajson::visit(element, counting_visitor(c));
+                    return c;
+                },
+                [](counts a, const counts& b) { return a += b; },
+                pool);
+            // The root array itself.
+            ++parallel.nodes;
+        });
+        if (parallel.nodes != serial.nodes
+            || parallel.string_length != serial.string_length) {
+            fprintf(stderr, "traversals disagree\n");
+            return 1;
+        }
+        printf(
+            "%7zu - %10.3f - %9.1f - %6.2fx\n",
+            threads,
+            ms,
+            text.size() / 1000.0 / ms,
+            serial_ms / ms);
+    }
+}
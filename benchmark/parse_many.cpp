@@ -0,0 +1,111 @@
+// Measures how parse_many scales with thread count on a batch of small,
+// independent payloads.
+//
+// usage: bench_parse_many [max_threads [payload_count]]
+
+#include <sajson_parallel.h>
+
+#include <chrono>
+#include <memory>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+const char* payload_files[] = {
+    "testdata/svg_menu.json",
+    "testdata/truenull.json",
+    "testdata/whitespace.json",
+    "testdata/nested.json",
+};
+const size_t payload_files_count
+    = sizeof(payload_files) / sizeof(*payload_files);
+
+bool read_file(const char* filename, std::string& contents) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        perror("fopen failed");
+        return false;
+    }
+
+    std::unique_ptr<FILE, int (*)(FILE*)> deleter(file, fclose);
+
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, n);
+    }
+    return !ferror(file);
+}
+
+int main(int argc, const char** argv) {
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (argc > 1) {
+        max_threads = strtoul(argv[1], 0, 10);
+    }
+    if (!max_threads) {
+        max_threads = 1;
+    }
+    size_t payload_count = argc > 2 ? strtoul(argv[2], 0, 10) : 20000;
+
+    std::vector<std::string> files(payload_files_count);
+    for (size_t i = 0; i < payload_files_count; ++i) {
+        if (!read_file(payload_files[i], files[i])) {
+            return 1;
+        }
+    }
+
+    std::vector<sajson::string> inputs;
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < payload_count; ++i) {
+        const std::string& f = files[i % files.size()];
+        inputs.push_back(sajson::string(f.data(), f.size()));
+        total_bytes += f.size();
+    }
+
+    printf(
+        "%zu payloads, %.1f MB total\n\n",
+        payload_count,
+        total_bytes / 1000000.0);
+    printf("%7s - %10s - %9s - %7s\n", "threads", "ms", "MB/s", "speedup");
+    printf("%7s - %10s - %9s - %7s\n", "-------", "--", "----", "-------");
+
+    typedef std::chrono::steady_clock clock;
+    double baseline_ms = 0.0;
+    std::vector<sajson::document> outputs;
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (size_t threads : thread_counts) {
+        sajson::thread_pool pool(threads);
+        double best_ms = 0.0;
+        for (int run = 0; run < 10; ++run) {
+            clock::time_point before = clock::now();
+            sajson::parse_many(
+                sajson::single_allocation(), inputs, &outputs, pool);
+            double ms = std::chrono::duration<double, std::milli>(
+                            clock::now() - before)
+                            .count();
+            if (run == 0 || ms < best_ms) {
+                best_ms = ms;
+            }
+        }
+        for (const auto& d : outputs) {
+            if (!d.is_valid()) {
+                fprintf(stderr, "parse failed\n");
+                return 1;
+            }
+        }
+        if (threads == 1) {
+            baseline_ms = best_ms;
+        }
+        printf(
+            "%7zu - %10.3f - %9.1f - %6.2fx\n",
+            threads,
+            best_ms,
+            total_bytes / 1000.0 / best_ms,
+            baseline_ms / best_ms);
+    }
+}
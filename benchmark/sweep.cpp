@@ -0,0 +1,199 @@
+// Maps parse throughput against the shape of the input.  Each sweep varies
+// one corpus.h parameter over a range while the others keep their values,
+// generates a document of the same size for every point, and plots the
+// median throughput.
+//
+// usage: bench_sweep [options] [corpus options]
+//
+//   --sweep=NAME       Run only the sweep of this parameter; repeat to run
+//                      several.  Defaults to all of them.
+//   --strategy=NAME    single, dynamic, or bounded.  Defaults to single.
+//   --min-time=MS      Parse each document for at least this long.
+//                      Defaults to 100.
+//   --json             Print the results as JSON instead of a plot.
+//
+// Corpus options set the values of the parameters that are not being swept.
+
+#include "corpus.h"
+#include "harness.h"
+
+#include <sajson.h>
+#include <sajson_writer.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct sweep {
+    const char* parameter;
+    std::vector<double> values;
+};
+
+const sweep sweeps[] = {
+    { "depth", { 1, 2, 4, 8, 16, 32, 64, 128 } },
+    { "width", { 1, 2, 4, 8, 16, 32, 64, 128 } },
+    { "string-length", { 0, 4, 16, 64, 256, 1024 } },
+    { "string-ratio", { 0, 0.25, 0.5, 0.75, 1 } },
+    { "double-ratio", { 0, 0.25, 0.5, 0.75, 1 } },
+    { "escape-density", { 0, 0.01, 0.05, 0.1, 0.25, 0.5 } },
+    { "non-ascii-density", { 0, 0.01, 0.05, 0.1, 0.25, 0.5 } },
+    { "whitespace", { 0, 1, 2, 4, 8, 16 } },
+    { "duplicate-key-ratio", { 0, 0.1, 0.25, 0.5, 0.9 } },
+};
+
+struct point {
+    double value;
+    size_t bytes;
+    double median_ns;
+};
+
+// Returns the median time to parse text, or a negative number if it does
+// not parse.
+double median_parse_ns(
+    strategy_kind strategy, const std::string& text, double min_time_ms) {
+    const std::vector<char> input(text.begin(), text.end());
+    no_parse_hooks hooks;
+    std::vector<double> samples;
+    if (!time_parses(strategy, input, min_time_ms, 5, hooks, samples)) {
+        return -1;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+void plot(const sweep& s, const std::vector<point>& points) {
+    double best = 0;
+    for (const point& p : points) {
+        best = std::max(best, p.bytes / p.median_ns);
+    }
+    printf("%s\n", s.parameter);
+    for (const point& p : points) {
+        const double gb_per_s = p.bytes / p.median_ns;
+        const int bar = static_cast<int>(48 * gb_per_s / best + 0.5);
+        printf(
+            "%10g - %6.3f GB/s - %s\n",
+            p.value,
+            gb_per_s,
+            std::string(bar, '#').c_str());
+    }
+    printf("\n");
+}
+
+void print_json(
+    strategy_kind strategy,
+    const std::vector<const sweep*>& selected,
+    const std::vector<std::vector<point>>& results) {
+    sajson::writer w(2);
+    w.begin_object();
+    w.key("strategy");
+    w.string(strategy_names[strategy]);
+    w.key("sweeps");
+    w.begin_array();
+    for (size_t i = 0; i < selected.size(); ++i) {
+        w.begin_object();
+        w.key("parameter");
+        w.string(selected[i]->parameter);
+        w.key("points");
+        w.begin_array();
+        for (const point& p : results[i]) {
+            w.begin_object();
+            w.key("value");
+            w.double_(p.value);
+            w.key("bytes");
+            w.int64(p.bytes);
+            w.key("median_ns");
+            w.double_(p.median_ns);
+            w.key("gb_per_s");
+            w.double_(p.bytes / p.median_ns);
+            w.end_object();
+        }
+        w.end_array();
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+
+    const sajson::string output = w.get_output();
+    fwrite(output.data(), 1, output.length(), stdout);
+    putchar('\n');
+}
+
+int main(int argc, const char** argv) {
+    corpus_parameters base;
+    strategy_kind strategy = SINGLE;
+    double min_time_ms = 100;
+    bool json = false;
+    std::vector<const sweep*> selected;
+
+    const size_t sweep_count = sizeof(sweeps) / sizeof(*sweeps);
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool ok = true;
+        if (!strcmp(arg, "--json")) {
+            json = true;
+        } else if (!strncmp(arg, "--sweep=", 8)) {
+            size_t k = 0;
+            while (k < sweep_count && strcmp(arg + 8, sweeps[k].parameter)) {
+                ++k;
+            }
+            ok = k < sweep_count;
+            if (ok) {
+                selected.push_back(&sweeps[k]);
+            }
+        } else if (!strncmp(arg, "--strategy=", 11)) {
+            ok = find_strategy(arg + 11, &strategy);
+        } else if (!strncmp(arg, "--min-time=", 11)) {
+            min_time_ms = strtod(arg + 11, 0);
+        } else {
+            ok = parse_corpus_option(arg, base);
+        }
+        if (!ok) {
+            fprintf(
+                stderr,
+                "usage: bench_sweep [--sweep=NAME] [--strategy=NAME] "
+                "[--min-time=MS] [--json] [corpus options]\n\n%s",
+                corpus_options_help());
+            return 2;
+        }
+    }
+    if (selected.empty()) {
+        for (const sweep& s : sweeps) {
+            selected.push_back(&s);
+        }
+    }
+
+    if (!json) {
+        printf(
+            "%zu-byte documents, %s allocation\n\n",
+            base.size,
+            strategy_names[strategy]);
+    }
+
+    std::vector<std::vector<point>> results;
+    for (const sweep* s : selected) {
+        std::vector<point> points;
+        for (double value : s->values) {
+            corpus_parameters params = base;
+            set_corpus_parameter(params, s->parameter, value);
+            const std::string text = corpus_generator(params).generate();
+            const double ns = median_parse_ns(strategy, text, min_time_ms);
+            if (ns < 0) {
+                fprintf(
+                    stderr,
+                    "%s=%g: generated document does not parse\n",
+                    s->parameter,
+                    value);
+                return 1;
+            }
+            points.push_back(point{ value, text.size(), ns });
+        }
+        if (!json) {
+            plot(*s, points);
+        }
+        results.push_back(points);
+    }
+
+    if (json) {
+        print_json(strategy, selected, results);
+    }
+}
@@ -0,0 +1,211 @@
+// Compares walking a parsed document by switching on get_type() against
+// sajson::visit, which dispatches on the AST tag directly.
+
+#include <sajson.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+const char* default_files[] = {
+    "testdata/apache_builds.json", "testdata/github_events.json",
+    "testdata/instruments.json",   "testdata/mesh.json",
+    "testdata/mesh.pretty.json",   "testdata/nested.json",
+    "testdata/svg_menu.json",      "testdata/truenull.json",
+    "testdata/twitter.json",       "testdata/update-center.json",
+    "testdata/whitespace.json",
+};
+const size_t default_files_count
+    = sizeof(default_files) / sizeof(*default_files);
+
+const size_t N = 1000;
+
+struct counts {
+    counts()
+        : nodes(0)
+        , string_length(0)
+        , number_total(0) {}
+
+    size_t nodes;
+    size_t string_length;
+    double number_total;
+};
+
+void traverse_switch(counts& c, const sajson::value& node) {
+    using namespace sajson;
+
+    ++c.nodes;
+    switch (node.get_type()) {
+    case TYPE_NULL:
+    case TYPE_FALSE:
+    case TYPE_TRUE:
+        break;
+
+    case TYPE_ARRAY: {
+        auto length = node.get_length();
+        for (size_t i = 0; i < length; ++i) {
+            traverse_switch(c, node.get_array_element(i));
+        }
+        break;
+    }
+
+    case TYPE_OBJECT: {
+        auto length = node.get_length();
+        for (size_t i = 0; i < length; ++i) {
+            traverse_switch(c, node.get_object_value(i));
+        }
+        break;
+    }
+
+    case TYPE_STRING:
+        c.string_length += node.get_string_length();
+        break;
+
+    case TYPE_DOUBLE:
+    case TYPE_INTEGER:
+        c.number_total += node.get_number_value();
+        break;
+    }
+}
+
+struct counting_visitor {
+    explicit counting_visitor(counts& c_)
+        : c(c_) {}
+
+    void visit_null() { ++c.nodes; }
+
+    void visit_boolean(bool) { ++c.nodes; }
+
+    void visit_integer(int i) {
+        ++c.nodes;
+        c.number_total += i;
+    }
+
+    void visit_double(double d) {
+        ++c.nodes;
+        c.number_total += d;
+    }
+
+    void visit_string(const sajson::string& s) {
+        ++c.nodes;
+        c.string_length += s.length();
+    }
+
+    void visit_array(const sajson::array_range& elements) {
+        ++c.nodes;
+        for (const auto& element : elements) {
+            sajson::visit(element, *this);
+        }
+    }
+
+    void visit_object(const sajson::object_range& members) {
+        ++c.nodes;
+        for (auto it = members.begin(); it != members.end(); ++it) {
+            sajson::visit(it.get_value(), *this);
+        }
+    }
+
+    counts& c;
+};
+
+// Runs fn N times and returns the fastest run in nanoseconds.
+template <typename Function>
+double time_minimum_ns(Function fn) {
+    typedef std::chrono::steady_clock clock;
+    clock::duration minimum = clock::duration::max();
+    for (size_t i = 0; i < N; ++i) {
+        clock::time_point before = clock::now();
+        fn();
+        minimum = std::min(minimum, clock::now() - before);
+    }
+    return std::chrono::duration<double, std::nano>(minimum).count();
+}
+
+void run_benchmark(size_t max_string_length, const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        perror("fopen failed");
+        return;
+    }
+
+    std::unique_ptr<FILE, int (*)(FILE*)> deleter(file, fclose);
+
+    if (fseek(file, 0, SEEK_END)) {
+        perror("fseek failed");
+        return;
+    }
+    size_t length = ftell(file);
+    if (fseek(file, 0, SEEK_SET)) {
+        perror("fseek failed");
+        return;
+    }
+
+    std::vector<char> buffer(length);
+    if (fread(buffer.data(), length, 1, file) != 1) {
+        perror("fread failed");
+        return;
+    }
+
+    deleter.reset();
+
+    const sajson::document& document = sajson::parse(
+        sajson::single_allocation(),
+        sajson::string(buffer.data(), buffer.size()));
+    if (!document.is_valid()) {
+        fprintf(stderr, "%s: parse failed\n", filename);
+        return;
+    }
+    const sajson::value root = document.get_root();
+
+    counts switch_counts;
+    double switch_ns = time_minimum_ns([&] {
+        switch_counts = counts();
+        traverse_switch(switch_counts, root);
+    });
+
+    counts visit_counts;
+    double visit_ns = time_minimum_ns([&] {
+        visit_counts = counts();
+        sajson::visit(root, counting_visitor(visit_counts));
+    });
+
+    if (switch_counts.nodes != visit_counts.nodes
+        || switch_counts.string_length != visit_counts.string_length) {
+        fprintf(stderr, "%s: traversals disagree\n", filename);
+        return;
+    }
+
+    printf(
+        "%*s - %8zu - %7.2f ns - %7.2f ns - %5.2fx\n",
+        static_cast<int>(max_string_length),
+        filename,
+        switch_counts.nodes,
+        switch_ns / switch_counts.nodes,
+        visit_ns / visit_counts.nodes,
+        switch_ns / visit_ns);
+}
+
+int main(int argc, const char** argv) {
+    size_t files_count = default_files_count;
+    const char** files = default_files;
+    if (argc > 1) {
+        files_count = argc - 1;
+        files = argv + 1;
+    }
+
+    size_t max_string_length = 0;
+    for (size_t i = 0; i < files_count; ++i) {
+        max_string_length = std::max(max_string_length, strlen(files[i]));
+    }
+    printf(
+        "%*s - %8s - %10s - %10s - %6s\n",
+        static_cast<int>(max_string_length),
+        "file",
+        "nodes",
+        "switch/node",
+        "visit/node",
+        "speedup");
+    for (size_t i = 0; i < files_count; ++i) {
+        run_benchmark(max_string_length, files[i]);
+    }
+}
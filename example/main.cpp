@@ -1,5 +1,7 @@
 #include "sajson.h"
+#include "sajson_parallel.h"
 #include <assert.h>
+#include <stdlib.h>
 
 using namespace sajson;
 
@@ -37,61 +39,101 @@ struct jsonstats {
     size_t total_array_length;
     size_t total_object_length;
     double total_number_value;
+
+    jsonstats& operator+=(const jsonstats& other) {
+        null_count += other.null_count;
+        false_count += other.false_count;
+        true_count += other.true_count;
+        number_count += other.number_count;
+        object_count += other.object_count;
+        array_count += other.array_count;
+        string_count += other.string_count;
+        total_string_length += other.total_string_length;
+        total_array_length += other.total_array_length;
+        total_object_length += other.total_object_length;
+        total_number_value += other.total_number_value;
+        return *this;
+    }
 };
 
-void traverse(jsonstats& stats, const sajson::value& node) {
-    using namespace sajson;
+struct stats_visitor {
+    explicit stats_visitor(jsonstats& stats_)
+        : stats(stats_) {}
 
-    switch (node.get_type()) {
-    case TYPE_NULL:
-        ++stats.null_count;
-        break;
+    void visit_null() { ++stats.null_count; }
+
+    void visit_boolean(bool b) {
+        if (b) {
+            ++stats.true_count;
+        } else {
+            ++stats.false_count;
+        }
+    }
 
-    case TYPE_FALSE:
-        ++stats.false_count;
-        break;
+    void visit_integer(int i) {
+        ++stats.number_count;
+        stats.total_number_value += i;
+    }
 
-    case TYPE_TRUE:
-        ++stats.true_count;
-        break;
+    void visit_double(double d) {
+        ++stats.number_count;
+        stats.total_number_value += d;
+    }
 
-    case TYPE_ARRAY: {
+    void visit_string(const sajson::string& s) {
+        ++stats.string_count;
+        stats.total_string_length += s.length();
+    }
+
+    void visit_array(const sajson::array_range& elements) {
         ++stats.array_count;
-        auto length = node.get_length();
-        stats.total_array_length += length;
-        for (size_t i = 0; i < length; ++i) {
-            traverse(stats, node.get_array_element(i));
+        stats.total_array_length += elements.size();
+        for (const auto& element : elements) {
+            sajson::visit(element, *this);
         }
-        break;
     }
 
-    case TYPE_OBJECT: {
+    void visit_object(const sajson::object_range& members) {
         ++stats.object_count;
-        auto length = node.get_length();
-        stats.total_object_length += length;
-        for (auto i = 0u; i < length; ++i) {
-            traverse(stats, node.get_object_value(i));
+        stats.total_object_length += members.size();
+        for (auto it = members.begin(); it != members.end(); ++it) {
+            sajson::visit(it.get_value(), *this);
         }
-        break;
     }
 
-    case TYPE_STRING:
-        ++stats.string_count;
-        stats.total_string_length += node.get_string_length();
-        break;
+    jsonstats& stats;
+};
 
-    case TYPE_DOUBLE:
-    case TYPE_INTEGER:
-        ++stats.number_count;
-        stats.total_number_value += node.get_number_value();
-        break;
+void traverse(jsonstats& stats, const sajson::value& node) {
+    sajson::visit(node, stats_visitor(stats));
+}
 
-    default:
-        assert(false && "unknown node type");
-    }
+// Traverses a root array's elements on thread_count threads.
+void traverse_parallel(
+    jsonstats& stats, const sajson::value& root, size_t thread_count) {
+    sajson::thread_pool pool(thread_count);
+    ++stats.array_count;
+    stats.total_array_length += root.get_length();
+    stats += sajson::parallel_map_reduce(
+        root,
+        jsonstats(),
+        [](const sajson::value& element) {
+            jsonstats element_stats;
+            traverse(element_stats, element);
+            return element_stats;
+        },
+        [](jsonstats a, const jsonstats& b) { return a += b; },
+        pool);
 }
 
+// usage: parse_stats file [threads]
 int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file [threads]\n", argv[0]);
+        return 1;
+    }
+    const size_t thread_count = argc > 2 ? strtoul(argv[2], 0, 10) : 1;
+
     FILE* file = fopen(argv[1], "rb");
     if (!file) {
         fprintf(stderr, "Failed to open file\n");
@@ -116,7 +158,12 @@ int main(int argc, char** argv) {
     }
 
     jsonstats stats;
-    traverse(stats, document.get_root());
+    const sajson::value root = document.get_root();
+    if (thread_count != 1 && root.get_type() == sajson::TYPE_ARRAY) {
+        traverse_parallel(stats, root, thread_count);
+    } else {
+        traverse(stats, root);
+    }
 
     printf("object count: %d\n", (int)stats.object_count);
     printf("array count: %d\n", (int)stats.array_count);
@@ -27,12 +27,15 @@
 #include <algorithm>
 #include <assert.h>
 #include <cstdio>
+#include <float.h>
+#include <iterator>
 #include <limits.h>
 #include <limits>
 #include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <utility>
 
 #ifndef SAJSON_NO_STD_STRING
 #include <string> // for convenient access to error messages and string values.
@@ -122,6 +125,8 @@ inline size_t make_element(tag t, size_t value) {
 template <typename unused = void>
 struct globals_struct {
     static const unsigned char parse_flags[256];
+    static const uint64_t pow5_split[326][2];
+    static const uint64_t pow5_inv_split[342][2];
 };
 typedef globals_struct<> globals;
 
@@ -129,16 +134,17 @@ typedef globals_struct<> globals;
 
     // bit 0 (1) - set if: plain ASCII string character
     // bit 1 (2) - set if: whitespace
+    // bit 2 (4) - set if: must be escaped when written
     // bit 4 (0x10) - set if: 0-9 e E .
     template <typename unused>
     const uint8_t globals_struct<unused>::parse_flags[256] = {
      // 0    1    2    3    4    5    6    7      8    9    A    B    C    D    E    F
-        0,   0,   0,   0,   0,   0,   0,   0,     0,   2,   2,   0,   0,   2,   0,   0, // 0
-        0,   0,   0,   0,   0,   0,   0,   0,     0,   0,   0,   0,   0,   0,   0,   0, // 1
-        3,   1,   0,   1,   1,   1,   1,   1,     1,   1,   1,   1,   1,   1,   0x11,1, // 2
+        4,   4,   4,   4,   4,   4,   4,   4,     4,   6,   6,   4,   4,   6,   4,   4, // 0
+        4,   4,   4,   4,   4,   4,   4,   4,     4,   4,   4,   4,   4,   4,   4,   4, // 1
+        3,   1,   4,   1,   1,   1,   1,   1,     1,   1,   1,   1,   1,   1,   0x11,1, // 2
         0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,  0x11,0x11,1,   1,   1,   1,   1,   1, // 3
         1,   1,   1,   1,   1,   0x11,1,   1,     1,   1,   1,   1,   1,   1,   1,   1, // 4
-        1,   1,   1,   1,   1,   1,   1,   1,     1,   1,   1,   1,   0,   1,   1,   1, // 5
+        1,   1,   1,   1,   1,   1,   1,   1,     1,   1,   1,   1,   4,   1,   1,   1, // 5
         1,   1,   1,   1,   1,   0x11,1,   1,     1,   1,   1,   1,   1,   1,   1,   1, // 6
         1,   1,   1,   1,   1,   1,   1,   1,     1,   1,   1,   1,   1,   1,   1,   1, // 7
 
@@ -149,6 +155,684 @@ typedef globals_struct<> globals;
         0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0
     };
 
+    // 5^i to 125 significant bits, truncated, as {low, high} words.
+    template <typename unused>
+    const uint64_t globals_struct<unused>::pow5_split[326][2] = {
+    {0x0000000000000000ULL, 0x1000000000000000ULL},
+    {0x0000000000000000ULL, 0x1400000000000000ULL},
+    {0x0000000000000000ULL, 0x1900000000000000ULL},
+    {0x0000000000000000ULL, 0x1f40000000000000ULL},
+    {0x0000000000000000ULL, 0x1388000000000000ULL},
+    {0x0000000000000000ULL, 0x186a000000000000ULL},
+    {0x0000000000000000ULL, 0x1e84800000000000ULL},
+    {0x0000000000000000ULL, 0x1312d00000000000ULL},
+    {0x0000000000000000ULL, 0x17d7840000000000ULL},
+    {0x0000000000000000ULL, 0x1dcd650000000000ULL},
+    {0x0000000000000000ULL, 0x12a05f2000000000ULL},
+    {0x0000000000000000ULL, 0x174876e800000000ULL},
+    {0x0000000000000000ULL, 0x1d1a94a200000000ULL},
+    {0x0000000000000000ULL, 0x12309ce540000000ULL},
+    {0x0000000000000000ULL, 0x16bcc41e90000000ULL},
+    {0x0000000000000000ULL, 0x1c6bf52634000000ULL},
+    {0x0000000000000000ULL, 0x11c37937e0800000ULL},
+    {0x0000000000000000ULL, 0x16345785d8a00000ULL},
+    {0x0000000000000000ULL, 0x1bc16d674ec80000ULL},
+    {0x0000000000000000ULL, 0x1158e460913d0000ULL},
+    {0x0000000000000000ULL, 0x15af1d78b58c4000ULL},
+    {0x0000000000000000ULL, 0x1b1ae4d6e2ef5000ULL},
+    {0x0000000000000000ULL, 0x10f0cf064dd59200ULL},
+    {0x0000000000000000ULL, 0x152d02c7e14af680ULL},
+    {0x0000000000000000ULL, 0x1a784379d99db420ULL},
+    {0x0000000000000000ULL, 0x108b2a2c28029094ULL},
+    {0x0000000000000000ULL, 0x14adf4b7320334b9ULL},
+    {0x4000000000000000ULL, 0x19d971e4fe8401e7ULL},
+    {0x8800000000000000ULL, 0x1027e72f1f128130ULL},
+    {0xaa00000000000000ULL, 0x1431e0fae6d7217cULL},
+    {0xd480000000000000ULL, 0x193e5939a08ce9dbULL},
+    {0xc9a0000000000000ULL, 0x1f8def8808b02452ULL},
+    {0xbe04000000000000ULL, 0x13b8b5b5056e16b3ULL},
+    {0xad85000000000000ULL, 0x18a6e32246c99c60ULL},
+    {0xd8e6400000000000ULL, 0x1ed09bead87c0378ULL},
+    {0x878fe80000000000ULL, 0x13426172c74d822bULL},
+    {0x6973e20000000000ULL, 0x1812f9cf7920e2b6ULL},
+    {0x03d0da8000000000ULL, 0x1e17b84357691b64ULL},
+    {0x8262889000000000ULL, 0x12ced32a16a1b11eULL},
+    {0x22fb2ab400000000ULL, 0x178287f49c4a1d66ULL},
+    {0xabb9f56100000000ULL, 0x1d6329f1c35ca4bfULL},
+    {0xcb54395ca0000000ULL, 0x125dfa371a19e6f7ULL},
+    {0xbe2947b3c8000000ULL, 0x16f578c4e0a060b5ULL},
+    {0x2db399a0ba000000ULL, 0x1cb2d6f618c878e3ULL},
+    {0xfc90400474400000ULL, 0x11efc659cf7d4b8dULL},
+    {0x7bb4500591500000ULL, 0x166bb7f0435c9e71ULL},
+    {0xdaa16406f5a40000ULL, 0x1c06a5ec5433c60dULL},
+    {0xa8a4de8459868000ULL, 0x118427b3b4a05bc8ULL},
+    {0xd2ce16256fe82000ULL, 0x15e531a0a1c872baULL},
+    {0x87819baecbe22800ULL, 0x1b5e7e08ca3a8f69ULL},
+    {0xf4b1014d3f6d5900ULL, 0x111b0ec57e6499a1ULL},
+    {0x71dd41a08f48af40ULL, 0x1561d276ddfdc00aULL},
+    {0x0e549208b31adb10ULL, 0x1aba4714957d300dULL},
+    {0x28f4db456ff0c8eaULL, 0x10b46c6cdd6e3e08ULL},
+    {0x33321216cbecfb24ULL, 0x14e1878814c9cd8aULL},
+    {0xbffe969c7ee839edULL, 0x1a19e96a19fc40ecULL},
+    {0xf7ff1e21cf512434ULL, 0x105031e2503da893ULL},
+    {0xf5fee5aa43256d41ULL, 0x14643e5ae44d12b8ULL},
+    {0x337e9f14d3eec892ULL, 0x197d4df19d605767ULL},
+    {0x005e46da08ea7ab6ULL, 0x1fdca16e04b86d41ULL},
+    {0xa03aec4845928cb2ULL, 0x13e9e4e4c2f34448ULL},
+    {0xc849a75a56f72fdeULL, 0x18e45e1df3b0155aULL},
+    {0x7a5c1130ecb4fbd6ULL, 0x1f1d75a5709c1ab1ULL},
+    {0xec798abe93f11d65ULL, 0x13726987666190aeULL},
+    {0xa797ed6e38ed64bfULL, 0x184f03e93ff9f4daULL},
+    {0x517de8c9c728bdefULL, 0x1e62c4e38ff87211ULL},
+    {0xd2eeb17e1c7976b5ULL, 0x12fdbb0e39fb474aULL},
+    {0x87aa5ddda397d462ULL, 0x17bd29d1c87a191dULL},
+    {0xe994f5550c7dc97bULL, 0x1dac74463a989f64ULL},
+    {0x11fd195527ce9dedULL, 0x128bc8abe49f639fULL},
+    {0xd67c5faa71c24568ULL, 0x172ebad6ddc73c86ULL},
+    {0x8c1b77950e32d6c2ULL, 0x1cfa698c95390ba8ULL},
+    {0x57912abd28dfc639ULL, 0x121c81f7dd43a749ULL},
+    {0xad75756c7317b7c8ULL, 0x16a3a275d494911bULL},
+    {0x98d2d2c78fdda5baULL, 0x1c4c8b1349b9b562ULL},
+    {0x9f83c3bcb9ea8794ULL, 0x11afd6ec0e14115dULL},
+    {0x0764b4abe8652979ULL, 0x161bcca7119915b5ULL},
+    {0x493de1d6e27e73d7ULL, 0x1ba2bfd0d5ff5b22ULL},
+    {0x6dc6ad264d8f0866ULL, 0x1145b7e285bf98f5ULL},
+    {0xc938586fe0f2ca80ULL, 0x159725db272f7f32ULL},
+    {0x7b866e8bd92f7d20ULL, 0x1afcef51f0fb5effULL},
+    {0xad34051767bdae34ULL, 0x10de1593369d1b5fULL},
+    {0x9881065d41ad19c1ULL, 0x15159af804446237ULL},
+    {0x7ea147f492186032ULL, 0x1a5b01b605557ac5ULL},
+    {0x6f24ccf8db4f3c1fULL, 0x1078e111c3556cbbULL},
+    {0x4aee003712230b27ULL, 0x14971956342ac7eaULL},
+    {0xdda98044d6abcdf0ULL, 0x19bcdfabc13579e4ULL},
+    {0x0a89f02b062b60b6ULL, 0x10160bcb58c16c2fULL},
+    {0xcd2c6c35c7b638e4ULL, 0x141b8ebe2ef1c73aULL},
+    {0x8077874339a3c71dULL, 0x1922726dbaae3909ULL},
+    {0xe0956914080cb8e4ULL, 0x1f6b0f092959c74bULL},
+    {0x6c5d61ac8507f38eULL, 0x13a2e965b9d81c8fULL},
+    {0x4774ba17a649f072ULL, 0x188ba3bf284e23b3ULL},
+    {0x1951e89d8fdc6c8fULL, 0x1eae8caef261aca0ULL},
+    {0x0fd3316279e9c3d9ULL, 0x132d17ed577d0be4ULL},
+    {0x13c7fdbb186434cfULL, 0x17f85de8ad5c4eddULL},
+    {0x58b9fd29de7d4203ULL, 0x1df67562d8b36294ULL},
+    {0xb7743e3a2b0e4942ULL, 0x12ba095dc7701d9cULL},
+    {0xe5514dc8b5d1db92ULL, 0x17688bb5394c2503ULL},
+    {0xdea5a13ae3465277ULL, 0x1d42aea2879f2e44ULL},
+    {0x0b2784c4ce0bf38aULL, 0x1249ad2594c37cebULL},
+    {0xcdf165f6018ef06dULL, 0x16dc186ef9f45c25ULL},
+    {0x416dbf7381f2ac88ULL, 0x1c931e8ab871732fULL},
+    {0x88e497a83137abd5ULL, 0x11dbf316b346e7fdULL},
+    {0xeb1dbd923d8596caULL, 0x1652efdc6018a1fcULL},
+    {0x25e52cf6cce6fc7dULL, 0x1be7abd3781eca7cULL},
+    {0x97af3c1a40105dceULL, 0x1170cb642b133e8dULL},
+    {0xfd9b0b20d0147542ULL, 0x15ccfe3d35d80e30ULL},
+    {0x3d01cde904199292ULL, 0x1b403dcc834e11bdULL},
+    {0x462120b1a28ffb9bULL, 0x1108269fd210cb16ULL},
+    {0xd7a968de0b33fa82ULL, 0x154a3047c694fddbULL},
+    {0xcd93c3158e00f923ULL, 0x1a9cbc59b83a3d52ULL},
+    {0xc07c59ed78c09bb6ULL, 0x10a1f5b813246653ULL},
+    {0xb09b7068d6f0c2a3ULL, 0x14ca732617ed7fe8ULL},
+    {0xdcc24c830cacf34cULL, 0x19fd0fef9de8dfe2ULL},
+    {0xc9f96fd1e7ec180fULL, 0x103e29f5c2b18bedULL},
+    {0x3c77cbc661e71e13ULL, 0x144db473335deee9ULL},
+    {0x8b95beb7fa60e598ULL, 0x1961219000356aa3ULL},
+    {0x6e7b2e65f8f91efeULL, 0x1fb969f40042c54cULL},
+    {0xc50cfcffbb9bb35fULL, 0x13d3e2388029bb4fULL},
+    {0xb6503c3faa82a037ULL, 0x18c8dac6a0342a23ULL},
+    {0xa3e44b4f95234844ULL, 0x1efb1178484134acULL},
+    {0xe66eaf11bd360d2bULL, 0x135ceaeb2d28c0ebULL},
+    {0xe00a5ad62c839075ULL, 0x183425a5f872f126ULL},
+    {0x980cf18bb7a47493ULL, 0x1e412f0f768fad70ULL},
+    {0x5f0816f752c6c8dcULL, 0x12e8bd69aa19cc66ULL},
+    {0xf6ca1cb527787b13ULL, 0x17a2ecc414a03f7fULL},
+    {0xf47ca3e2715699d7ULL, 0x1d8ba7f519c84f5fULL},
+    {0xf8cde66d86d62026ULL, 0x127748f9301d319bULL},
+    {0xf7016008e88ba830ULL, 0x17151b377c247e02ULL},
+    {0xb4c1b80b22ae923cULL, 0x1cda62055b2d9d83ULL},
+    {0x50f91306f5ad1b65ULL, 0x12087d4358fc8272ULL},
+    {0xe53757c8b318623fULL, 0x168a9c942f3ba30eULL},
+    {0x9e852dbadfde7acfULL, 0x1c2d43b93b0a8bd2ULL},
+    {0xa3133c94cbeb0cc1ULL, 0x119c4a53c4e69763ULL},
+    {0x8bd80bb9fee5cff1ULL, 0x16035ce8b6203d3cULL},
+    {0xaece0ea87e9f43eeULL, 0x1b843422e3a84c8bULL},
+    {0x4d40c9294f238a75ULL, 0x1132a095ce492fd7ULL},
+    {0x2090fb73a2ec6d12ULL, 0x157f48bb41db7bcdULL},
+    {0x68b53a508ba78856ULL, 0x1adf1aea12525ac0ULL},
+    {0x417144725748b536ULL, 0x10cb70d24b7378b8ULL},
+    {0x51cd958eed1ae283ULL, 0x14fe4d06de5056e6ULL},
+    {0xe640faf2a8619b24ULL, 0x1a3de04895e46c9fULL},
+    {0xefe89cd7a93d00f7ULL, 0x1066ac2d5daec3e3ULL},
+    {0xebe2c40d938c4134ULL, 0x14805738b51a74dcULL},
+    {0x26db7510f86f5181ULL, 0x19a06d06e2611214ULL},
+    {0x9849292a9b4592f1ULL, 0x100444244d7cab4cULL},
+    {0xbe5b73754216f7adULL, 0x1405552d60dbd61fULL},
+    {0xadf25052929cb598ULL, 0x1906aa78b912cba7ULL},
+    {0x996ee4673743e2ffULL, 0x1f485516e7577e91ULL},
+    {0xffe54ec0828a6ddfULL, 0x138d352e5096af1aULL},
+    {0xbfdea270a32d0957ULL, 0x18708279e4bc5ae1ULL},
+    {0x2fd64b0ccbf84badULL, 0x1e8ca3185deb719aULL},
+    {0x5de5eee7ff7b2f4cULL, 0x1317e5ef3ab32700ULL},
+    {0x755f6aa1ff59fb1fULL, 0x17dddf6b095ff0c0ULL},
+    {0x92b7454a7f3079e7ULL, 0x1dd55745cbb7ecf0ULL},
+    {0x5bb28b4e8f7e4c30ULL, 0x12a5568b9f52f416ULL},
+    {0xf29f2e22335ddf3cULL, 0x174eac2e8727b11bULL},
+    {0xef46f9aac035570bULL, 0x1d22573a28f19d62ULL},
+    {0xd58c5c0ab8215667ULL, 0x123576845997025dULL},
+    {0x4aef730d6629ac01ULL, 0x16c2d4256ffcc2f5ULL},
+    {0x9dab4fd0bfb41701ULL, 0x1c73892ecbfbf3b2ULL},
+    {0xa28b11e277d08e60ULL, 0x11c835bd3f7d784fULL},
+    {0x8b2dd65b15c4b1f9ULL, 0x163a432c8f5cd663ULL},
+    {0x6df94bf1db35de77ULL, 0x1bc8d3f7b3340bfcULL},
+    {0xc4bbcf772901ab0aULL, 0x115d847ad000877dULL},
+    {0x35eac354f34215cdULL, 0x15b4e5998400a95dULL},
+    {0x8365742a30129b40ULL, 0x1b221effe500d3b4ULL},
+    {0xd21f689a5e0ba108ULL, 0x10f5535fef208450ULL},
+    {0x06a742c0f58e894aULL, 0x1532a837eae8a565ULL},
+    {0x4851137132f22b9dULL, 0x1a7f5245e5a2cebeULL},
+    {0xed32ac26bfd75b42ULL, 0x108f936baf85c136ULL},
+    {0xa87f57306fcd3212ULL, 0x14b378469b673184ULL},
+    {0xd29f2cfc8bc07e97ULL, 0x19e056584240fde5ULL},
+    {0xa3a37c1dd7584f1eULL, 0x102c35f729689eafULL},
+    {0x8c8c5b254d2e62e6ULL, 0x14374374f3c2c65bULL},
+    {0x6faf71eea079fb9fULL, 0x1945145230b377f2ULL},
+    {0x0b9b4e6a48987a87ULL, 0x1f965966bce055efULL},
+    {0x674111026d5f4c94ULL, 0x13bdf7e0360c35b5ULL},
+    {0xc111554308b71fbaULL, 0x18ad75d8438f4322ULL},
+    {0x7155aa93cae4e7a8ULL, 0x1ed8d34e547313ebULL},
+    {0x26d58a9c5ecf10c9ULL, 0x13478410f4c7ec73ULL},
+    {0xf08aed437682d4fbULL, 0x1819651531f9e78fULL},
+    {0xecada89454238a3aULL, 0x1e1fbe5a7e786173ULL},
+    {0x73ec895cb4963664ULL, 0x12d3d6f88f0b3ce8ULL},
+    {0x90e7abb3e1bbc3fdULL, 0x1788ccb6b2ce0c22ULL},
+    {0x352196a0da2ab4fdULL, 0x1d6affe45f818f2bULL},
+    {0x0134fe24885ab11eULL, 0x1262dfeebbb0f97bULL},
+    {0xc1823dadaa715d65ULL, 0x16fb97ea6a9d37d9ULL},
+    {0x31e2cd19150db4bfULL, 0x1cba7de5054485d0ULL},
+    {0x1f2dc02fad2890f7ULL, 0x11f48eaf234ad3a2ULL},
+    {0xa6f9303b9872b535ULL, 0x1671b25aec1d888aULL},
+    {0x50b77c4a7e8f6282ULL, 0x1c0e1ef1a724eaadULL},
+    {0x5272adae8f199d91ULL, 0x1188d357087712acULL},
+    {0x670f591a32e004f6ULL, 0x15eb082cca94d757ULL},
+    {0x40d32f60bf980633ULL, 0x1b65ca37fd3a0d2dULL},
+    {0x4883fd9c77bf03e0ULL, 0x111f9e62fe44483cULL},
+    {0x5aa4fd0395aec4d8ULL, 0x156785fbbdd55a4bULL},
+    {0x314e3c447b1a760eULL, 0x1ac1677aad4ab0deULL},
+    {0xded0e5aaccf089c9ULL, 0x10b8e0acac4eae8aULL},
+    {0x96851f15802cac3bULL, 0x14e718d7d7625a2dULL},
+    {0xfc2666dae037d74aULL, 0x1a20df0dcd3af0b8ULL},
+    {0x9d980048cc22e68eULL, 0x10548b68a044d673ULL},
+    {0x84fe005aff2ba032ULL, 0x1469ae42c8560c10ULL},
+    {0xa63d8071bef6883eULL, 0x198419d37a6b8f14ULL},
+    {0xcfcce08e2eb42a4eULL, 0x1fe52048590672d9ULL},
+    {0x21e00c58dd309a70ULL, 0x13ef342d37a407c8ULL},
+    {0x2a580f6f147cc10dULL, 0x18eb0138858d09baULL},
+    {0xb4ee134ad99bf150ULL, 0x1f25c186a6f04c28ULL},
+    {0x7114cc0ec80176d2ULL, 0x137798f428562f99ULL},
+    {0xcd59ff127a01d486ULL, 0x18557f31326bbb7fULL},
+    {0xc0b07ed7188249a8ULL, 0x1e6adefd7f06aa5fULL},
+    {0xd86e4f466f516e09ULL, 0x1302cb5e6f642a7bULL},
+    {0xce89e3180b25c98bULL, 0x17c37e360b3d351aULL},
+    {0x822c5bde0def3beeULL, 0x1db45dc38e0c8261ULL},
+    {0xf15bb96ac8b58575ULL, 0x1290ba9a38c7d17cULL},
+    {0x2db2a7c57ae2e6d2ULL, 0x1734e940c6f9c5dcULL},
+    {0x391f51b6d99ba086ULL, 0x1d022390f8b83753ULL},
+    {0x03b3931248014454ULL, 0x1221563a9b732294ULL},
+    {0x04a077d6da019569ULL, 0x16a9abc9424feb39ULL},
+    {0x45c895cc9081fac3ULL, 0x1c5416bb92e3e607ULL},
+    {0x8b9d5d9fda513cbaULL, 0x11b48e353bce6fc4ULL},
+    {0xae84b507d0e58be8ULL, 0x1621b1c28ac20bb5ULL},
+    {0x1a25e249c51eeee3ULL, 0x1baa1e332d728ea3ULL},
+    {0xf057ad6e1b33554dULL, 0x114a52dffc679925ULL},
+    {0x6c6d98c9a2002aa1ULL, 0x159ce797fb817f6fULL},
+    {0x4788fefc0a803549ULL, 0x1b04217dfa61df4bULL},
+    {0x0cb59f5d8690214eULL, 0x10e294eebc7d2b8fULL},
+    {0xcfe30734e83429a1ULL, 0x151b3a2a6b9c7672ULL},
+    {0x83dbc9022241340aULL, 0x1a6208b50683940fULL},
+    {0xb2695da15568c086ULL, 0x107d457124123c89ULL},
+    {0x1f03b509aac2f0a7ULL, 0x149c96cd6d16cbacULL},
+    {0x26c4a24c1573acd1ULL, 0x19c3bc80c85c7e97ULL},
+    {0x783ae56f8d684c03ULL, 0x101a55d07d39cf1eULL},
+    {0x16499ecb70c25f03ULL, 0x1420eb449c8842e6ULL},
+    {0x9bdc067e4cf2f6c4ULL, 0x19292615c3aa539fULL},
+    {0x82d3081de02fb476ULL, 0x1f736f9b3494e887ULL},
+    {0xb1c3e512ac1dd0c9ULL, 0x13a825c100dd1154ULL},
+    {0xde34de57572544fcULL, 0x18922f31411455a9ULL},
+    {0x55c215ed2cee963bULL, 0x1eb6bafd91596b14ULL},
+    {0xb5994db43c151de5ULL, 0x133234de7ad7e2ecULL},
+    {0xe2ffa1214b1a655eULL, 0x17fec216198ddba7ULL},
+    {0xdbbf89699de0feb6ULL, 0x1dfe729b9ff15291ULL},
+    {0x2957b5e202ac9f31ULL, 0x12bf07a143f6d39bULL},
+    {0xf3ada35a8357c6feULL, 0x176ec98994f48881ULL},
+    {0x70990c31242db8bdULL, 0x1d4a7bebfa31aaa2ULL},
+    {0x865fa79eb69c9376ULL, 0x124e8d737c5f0aa5ULL},
+    {0xe7f791866443b854ULL, 0x16e230d05b76cd4eULL},
+    {0xa1f575e7fd54a669ULL, 0x1c9abd04725480a2ULL},
+    {0xa53969b0fe54e801ULL, 0x11e0b622c774d065ULL},
+    {0x0e87c41d3dea2202ULL, 0x1658e3ab7952047fULL},
+    {0xd229b5248d64aa82ULL, 0x1bef1c9657a6859eULL},
+    {0x435a1136d85eea91ULL, 0x117571ddf6c81383ULL},
+    {0x143095848e76a536ULL, 0x15d2ce55747a1864ULL},
+    {0x193cbae5b2144e83ULL, 0x1b4781ead1989e7dULL},
+    {0x2fc5f4cf8f4cb112ULL, 0x110cb132c2ff630eULL},
+    {0xbbb77203731fdd56ULL, 0x154fdd7f73bf3bd1ULL},
+    {0x2aa54e844fe7d4acULL, 0x1aa3d4df50af0ac6ULL},
+    {0xdaa75112b1f0e4ebULL, 0x10a6650b926d66bbULL},
+    {0xd15125575e6d1e26ULL, 0x14cffe4e7708c06aULL},
+    {0x85a56ead360865b0ULL, 0x1a03fde214caf085ULL},
+    {0x7387652c41c53f8eULL, 0x10427ead4cfed653ULL},
+    {0x50693e7752368f71ULL, 0x14531e58a03e8be8ULL},
+    {0x64838e1526c4334eULL, 0x1967e5eec84e2ee2ULL},
+    {0xfda4719a70754022ULL, 0x1fc1df6a7a61ba9aULL},
+    {0xde86c70086494815ULL, 0x13d92ba28c7d14a0ULL},
+    {0x162878c0a7db9a1aULL, 0x18cf768b2f9c59c9ULL},
+    {0x5bb296f0d1d280a1ULL, 0x1f03542dfb83703bULL},
+    {0x194f9e5683239064ULL, 0x1362149cbd322625ULL},
+    {0x5fa385ec23ec747eULL, 0x183a99c3ec7eafaeULL},
+    {0xf78c67672ce7919dULL, 0x1e494034e79e5b99ULL},
+    {0x3ab7c0a07c10bb02ULL, 0x12edc82110c2f940ULL},
+    {0x4965b0c89b14e9c3ULL, 0x17a93a2954f3b790ULL},
+    {0x5bbf1cfac1da2433ULL, 0x1d9388b3aa30a574ULL},
+    {0xb957721cb92856a0ULL, 0x127c35704a5e6768ULL},
+    {0xe7ad4ea3e7726c48ULL, 0x171b42cc5cf60142ULL},
+    {0xa198a24ce14f075aULL, 0x1ce2137f74338193ULL},
+    {0x44ff65700cd16498ULL, 0x120d4c2fa8a030fcULL},
+    {0x563f3ecc1005bdbeULL, 0x16909f3b92c83d3bULL},
+    {0x2bcf0e7f14072d2eULL, 0x1c34c70a777a4c8aULL},
+    {0x5b61690f6c847c3dULL, 0x11a0fc668aac6fd6ULL},
+    {0xf239c35347a59b4cULL, 0x16093b802d578bcbULL},
+    {0xeec83428198f021fULL, 0x1b8b8a6038ad6ebeULL},
+    {0x553d20990ff96153ULL, 0x1137367c236c6537ULL},
+    {0x2a8c68bf53f7b9a8ULL, 0x1585041b2c477e85ULL},
+    {0x752f82ef28f5a812ULL, 0x1ae64521f7595e26ULL},
+    {0x093db1d57999890bULL, 0x10cfeb353a97dad8ULL},
+    {0x0b8d1e4ad7ffeb4eULL, 0x1503e602893dd18eULL},
+    {0x8e7065dd8dffe622ULL, 0x1a44df832b8d45f1ULL},
+    {0xf9063faa78bfefd5ULL, 0x106b0bb1fb384bb6ULL},
+    {0xb747cf9516efebcaULL, 0x1485ce9e7a065ea4ULL},
+    {0xe519c37a5cabe6bdULL, 0x19a742461887f64dULL},
+    {0xaf301a2c79eb7036ULL, 0x1008896bcf54f9f0ULL},
+    {0xdafc20b798664c43ULL, 0x140aabc6c32a386cULL},
+    {0x11bb28e57e7fdf54ULL, 0x190d56b873f4c688ULL},
+    {0x1629f31ede1fd72aULL, 0x1f50ac6690f1f82aULL},
+    {0x4dda37f34ad3e67aULL, 0x13926bc01a973b1aULL},
+    {0xe150c5f01d88e019ULL, 0x187706b0213d09e0ULL},
+    {0x19a4f76c24eb181fULL, 0x1e94c85c298c4c59ULL},
+    {0xb0071aa39712ef13ULL, 0x131cfd3999f7afb7ULL},
+    {0x9c08e14c7cd7aad8ULL, 0x17e43c8800759ba5ULL},
+    {0x030b199f9c0d958eULL, 0x1ddd4baa0093028fULL},
+    {0x61e6f003c1887d79ULL, 0x12aa4f4a405be199ULL},
+    {0xba60ac04b1ea9cd7ULL, 0x1754e31cd072d9ffULL},
+    {0xa8f8d705de65440dULL, 0x1d2a1be4048f907fULL},
+    {0xc99b8663aaff4a88ULL, 0x123a516e82d9ba4fULL},
+    {0xbc0267fc95bf1d2aULL, 0x16c8e5ca239028e3ULL},
+    {0xab0301fbbb2ee474ULL, 0x1c7b1f3cac74331cULL},
+    {0xeae1e13d54fd4ec9ULL, 0x11ccf385ebc89ff1ULL},
+    {0x659a598caa3ca27bULL, 0x1640306766bac7eeULL},
+    {0xff00efefd4cbcb1aULL, 0x1bd03c81406979e9ULL},
+    {0x3f6095f5e4ff5ef0ULL, 0x116225d0c841ec32ULL},
+    {0xcf38bb735e3f36acULL, 0x15baaf44fa52673eULL},
+    {0x8306ea5035cf0457ULL, 0x1b295b1638e7010eULL},
+    {0x11e4527221a162b6ULL, 0x10f9d8ede39060a9ULL},
+    {0x565d670eaa09bb64ULL, 0x15384f295c7478d3ULL},
+    {0x2bf4c0d2548c2a3dULL, 0x1a8662f3b3919708ULL},
+    {0x1b78f88374d79a66ULL, 0x1093fdd8503afe65ULL},
+    {0x625736a4520d8100ULL, 0x14b8fd4e6449bdfeULL},
+    {0xfaed044d6690e140ULL, 0x19e73ca1fd5c2d7dULL},
+    {0xbcd422b0601a8cc8ULL, 0x103085e53e599c6eULL},
+    {0x6c092b5c78212ffaULL, 0x143ca75e8df0038aULL},
+    {0x070b763396297bf8ULL, 0x194bd136316c046dULL},
+    {0x48ce53c07bb3daf6ULL, 0x1f9ec583bdc70588ULL},
+    {0x2d80f4584d5068daULL, 0x13c33b72569c6375ULL},
+    {0x78e1316e60a48310ULL, 0x18b40a4eec437c52ULL}
+    };
+
+    // 2^(floor(log2(5^i)) + 125) / 5^i, rounded up, as {low, high} words.
+    template <typename unused>
+    const uint64_t globals_struct<unused>::pow5_inv_split[342][2] = {
+    {0x0000000000000001ULL, 0x2000000000000000ULL},
+    {0x999999999999999aULL, 0x1999999999999999ULL},
+    {0x47ae147ae147ae15ULL, 0x147ae147ae147ae1ULL},
+    {0x6c8b4395810624deULL, 0x10624dd2f1a9fbe7ULL},
+    {0x7a786c226809d496ULL, 0x1a36e2eb1c432ca5ULL},
+    {0x61f9f01b866e43abULL, 0x14f8b588e368f084ULL},
+    {0xb4c7f34938583622ULL, 0x10c6f7a0b5ed8d36ULL},
+    {0x87a6520ec08d236aULL, 0x1ad7f29abcaf4857ULL},
+    {0x9fb841a566d74f88ULL, 0x15798ee2308c39dfULL},
+    {0xe62d01511f12a607ULL, 0x112e0be826d694b2ULL},
+    {0xd6ae6881cb5109a4ULL, 0x1b7cdfd9d7bdbab7ULL},
+    {0xdef1ed34a2a73aeaULL, 0x15fd7fe17964955fULL},
+    {0x7f27f0f6e885c8bbULL, 0x119799812dea1119ULL},
+    {0x650cb4be40d60df8ULL, 0x1c25c268497681c2ULL},
+    {0xea70909833de7193ULL, 0x16849b86a12b9b01ULL},
+    {0x21f3a6e0297ec143ULL, 0x1203af9ee756159bULL},
+    {0x6985d7cd0f313537ULL, 0x1cd2b297d889bc2bULL},
+    {0x2137dfd73f5a90f9ULL, 0x170ef54646d49689ULL},
+    {0xe75fe645cc4873faULL, 0x12725dd1d243aba0ULL},
+    {0xa5663d3c7a0d865dULL, 0x1d83c94fb6d2ac34ULL},
+    {0x511e976394d79eb1ULL, 0x179ca10c9242235dULL},
+    {0xda7edf82dd794bc1ULL, 0x12e3b40a0e9b4f7dULL},
+    {0x2a6498d1625bac68ULL, 0x1e392010175ee596ULL},
+    {0xeeb6e0a781e2f053ULL, 0x182db34012b25144ULL},
+    {0x58924d52ce4f26a9ULL, 0x1357c299a88ea76aULL},
+    {0x27507bb7b07ea441ULL, 0x1ef2d0f5da7dd8aaULL},
+    {0x52a6c95fc0655034ULL, 0x18c240c4aecb13bbULL},
+    {0x0eebd44c99eaa690ULL, 0x13ce9a36f23c0fc9ULL},
+    {0xb17953adc3110a80ULL, 0x1fb0f6be50601941ULL},
+    {0xc12ddc8b02740867ULL, 0x195a5efea6b34767ULL},
+    {0x3424b06f3529a052ULL, 0x14484bfeebc29f86ULL},
+    {0x901d59f290ee19dbULL, 0x1039d66589687f9eULL},
+    {0x4cfbc31db4b0295fULL, 0x19f623d5a8a73297ULL},
+    {0x3d9635b15d59bab2ULL, 0x14c4e977ba1f5bacULL},
+    {0x97ab5e277de16228ULL, 0x109d8792fb4c4956ULL},
+    {0xf2abc9d8c9689d0dULL, 0x1a95a5b7f87a0ef0ULL},
+    {0x5bbca17a3aba173eULL, 0x154484932d2e725aULL},
+    {0xafca1ac82efb45cbULL, 0x11039d428a8b8eaeULL},
+    {0xb2dcf7a6b1920945ULL, 0x1b38fb9daa78e44aULL},
+    {0xf57d92ebc141a104ULL, 0x15c72fb1552d836eULL},
+    {0xc46475896767b403ULL, 0x116c262777579c58ULL},
+    {0x6d6d88dbd8a5ecd2ULL, 0x1be03d0bf225c6f4ULL},
+    {0x8abe071646eb23dbULL, 0x164cfda3281e38c3ULL},
+    {0x6efe6c11d255b649ULL, 0x11d7314f534b609cULL},
+    {0xb197134fb6ef8a0eULL, 0x1c8b821885456760ULL},
+    {0x27ac0f72f8bfa1a5ULL, 0x16d601ad376ab91aULL},
+    {0xb95672c260994e1eULL, 0x1244ce242c5560e1ULL},
+    {0xf5571e03cdc21695ULL, 0x1d3ae36d13bbce35ULL},
+    {0x2aac18030b01ababULL, 0x17624f8a762fd82bULL},
+    {0xbbbce0026f348956ULL, 0x12b50c6ec4f31355ULL},
+    {0x92c7ccd0b1eda889ULL, 0x1dee7a4ad4b81eefULL},
+    {0xdbd30a408e57ba07ULL, 0x17f1fb6f10934bf2ULL},
+    {0x7ca8d50071dfc806ULL, 0x1327fc58da0f6ff5ULL},
+    {0xfaa7bb33e9660cd6ULL, 0x1ea6608e29b24cbbULL},
+    {0x9552fc298784d711ULL, 0x18851a0b548ea3c9ULL},
+    {0xaaa8c9bad2d0ac0eULL, 0x139dae6f76d88307ULL},
+    {0xdddadc5e1e1aace3ULL, 0x1f62b0b257c0d1a5ULL},
+    {0x7e48b04b4b488a4fULL, 0x191bc08eac9a4151ULL},
+    {0xcb6d59d5d5d3a1d9ULL, 0x141633a556e1cddaULL},
+    {0x3c577b1177dc817bULL, 0x1011c2eaabe7d7e2ULL},
+    {0xc6f25e825960cf2aULL, 0x19b604aaaca62636ULL},
+    {0x6bf518684780a5bbULL, 0x14919d5556eb51c5ULL},
+    {0x232a79ed06008496ULL, 0x10747ddddf22a7d1ULL},
+    {0xd1dd8fe1a3340756ULL, 0x1a53fc9631d10c81ULL},
+    {0xa7e4731ae8f66c45ULL, 0x150ffd44f4a73d34ULL},
+    {0x531d28e253f8569eULL, 0x10d9976a5d52975dULL},
+    {0xeb61db03b98d5762ULL, 0x1af5bf109550f22eULL},
+    {0xbc4e48cfc7a445e8ULL, 0x159165a6ddda5b58ULL},
+    {0x6371d3d96c836b20ULL, 0x11411e1f17e1e2adULL},
+    {0x9f1c8628ad9f11cdULL, 0x1b9b6364f3030448ULL},
+    {0xe5b06b53be18db0bULL, 0x1615e91d8f359d06ULL},
+    {0xeaf3890fcb4715a2ULL, 0x11ab20e472914a6bULL},
+    {0x44b8db4c7871bc37ULL, 0x1c45016d841baa46ULL},
+    {0x03c715d6c6c1635fULL, 0x169d9abe03495505ULL},
+    {0x3638de456bcde919ULL, 0x1217aefe69077737ULL},
+    {0x56c163a2461641c1ULL, 0x1cf2b1970e725858ULL},
+    {0xdf011c81d1ab67ceULL, 0x17288e1271f51379ULL},
+    {0x7f3416ce4155eca5ULL, 0x1286d80ec190dc61ULL},
+    {0x6520247d3556476eULL, 0x1da48ce468e7c702ULL},
+    {0xea801d30f7783925ULL, 0x17b6d71d20b96c01ULL},
+    {0xbb99b0f3f92cfa84ULL, 0x12f8ac174d612334ULL},
+    {0x5f5c4e532847f739ULL, 0x1e5aacf215683854ULL},
+    {0x7f7d0b75b9d32c2eULL, 0x18488a5b44536043ULL},
+    {0x9930d5f7c7dc2358ULL, 0x136d3b7c36a919cfULL},
+    {0x8eb4898c72f9d226ULL, 0x1f152bf9f10e8fb2ULL},
+    {0x722a07a38f2e41b8ULL, 0x18ddbcc7f40ba628ULL},
+    {0xc1bb394fa5be9afaULL, 0x13e497065cd61e86ULL},
+    {0x9c5ec2190930f7f6ULL, 0x1fd424d6faf030d7ULL},
+    {0x49e56814075a5ff8ULL, 0x197683df2f268d79ULL},
+    {0x6e51201005e1e660ULL, 0x145ecfe5bf520ac7ULL},
+    {0xf1da800cd181851aULL, 0x104bd984990e6f05ULL},
+    {0x4fc400148268d4f5ULL, 0x1a12f5a0f4e3e4d6ULL},
+    {0xd96999aa01ed772bULL, 0x14dbf7b3f71cb711ULL},
+    {0xadee1488018ac5bcULL, 0x10aff95cc5b09274ULL},
+    {0x497ceda668de092cULL, 0x1ab328946f80ea54ULL},
+    {0x3aca57b853e4d424ULL, 0x155c2076bf9a5510ULL},
+    {0x623b7960431d7683ULL, 0x1116805effaeaa73ULL},
+    {0x9d2bf566d1c8bd9eULL, 0x1b5733cb32b110b8ULL},
+    {0x7dbcc452416d647fULL, 0x15df5ca28ef40d60ULL},
+    {0xcafd69db678ab6ccULL, 0x117f7d4ed8c33de6ULL},
+    {0xab2f0fc572778adfULL, 0x1bff2ee48e052fd7ULL},
+    {0x88f273045b92d580ULL, 0x1665bf1d3e6a8cacULL},
+    {0xd3f528d049424466ULL, 0x11eaff4a98553d56ULL},
+    {0xb988414d4203a0a3ULL, 0x1cab3210f3bb9557ULL},
+    {0x6139cdd76802e6e9ULL, 0x16ef5b40c2fc7779ULL},
+    {0xe761717920025254ULL, 0x125915cd68c9f92dULL},
+    {0xa568b58e999d5086ULL, 0x1d5b561574765b7cULL},
+    {0x5120913ee14aa6d2ULL, 0x177c44ddf6c515fdULL},
+    {0xa74d40ff1aa21f0eULL, 0x12c9d0b1923744caULL},
+    {0x0baece64f769cb4aULL, 0x1e0fb44f50586e11ULL},
+    {0x3c8bd850c5ee3c3bULL, 0x180c903f7379f1a7ULL},
+    {0xca0979da37f1c9c9ULL, 0x133d4032c2c7f485ULL},
+    {0xa9a8c2f6bfe942dbULL, 0x1ec866b79e0cba6fULL},
+    {0x2153cf2bccba9be3ULL, 0x18a0522c7e709526ULL},
+    {0x1aa9728970954982ULL, 0x13b374f06526ddb8ULL},
+    {0xf775840f1a88759dULL, 0x1f8587e7083e2f8cULL},
+    {0x5f9136727ba05e17ULL, 0x19379fec0698260aULL},
+    {0x1940f85b9619e4dfULL, 0x142c7ff0054684d5ULL},
+    {0xe100c6afab47ea4cULL, 0x1023998cd1053710ULL},
+    {0xce67a44c453fdd47ULL, 0x19d28f47b4d524e7ULL},
+    {0xd852e9d69dccb106ULL, 0x14a8729fc3ddb71fULL},
+    {0x79dbee454b0a2738ULL, 0x1086c219697e2c19ULL},
+    {0x295fe3a211a9d859ULL, 0x1a71368f0f30468fULL},
+    {0xbab31c81a7bb137aULL, 0x15275ed8d8f36ba5ULL},
+    {0x6228e39aec95a92fULL, 0x10ec4be0ad8f8951ULL},
+    {0x9d0e38f7e0ef7517ULL, 0x1b13ac9aaf4c0ee8ULL},
+    {0xb0d82d931a592a79ULL, 0x15a956e225d67253ULL},
+    {0x8d79be0f4847552eULL, 0x11544581b7dec1dcULL},
+    {0x158f967eda0bbb7cULL, 0x1bba08cf8c979c94ULL},
+    {0x77a611ff14d62f97ULL, 0x162e6d72d6dfb076ULL},
+    {0xf951a7ff43de8c79ULL, 0x11bebdf578b2f391ULL},
+    {0xc21c3ffed2fdad8eULL, 0x1c6463225ab7ec1cULL},
+    {0x01b0333242648ad8ULL, 0x16b6b5b5155ff017ULL},
+    {0x0159c28e9b83a246ULL, 0x122bc490dde659acULL},
+    {0xcef604175f3903a3ULL, 0x1d12d41afca3c2acULL},
+    {0x725e69ac4c2d9c83ULL, 0x17424348ca1c9bbdULL},
+    {0xf5185489d68ae39cULL, 0x129b69070816e2fdULL},
+    {0xee8d540fbdab05c6ULL, 0x1dc574d80cf16b2fULL},
+    {0xbed77672fe226b05ULL, 0x17d12a4670c1228cULL},
+    {0xff12c528cb4ebc04ULL, 0x130dbb6b8d674ed6ULL},
+    {0xcb513b74787df9a0ULL, 0x1e7c5f127bd87e24ULL},
+    {0x090dc929f9fe614dULL, 0x18637f41fcad31b7ULL},
+    {0xa0d7d42194cb810aULL, 0x1382cc34ca2427c5ULL},
+    {0x67bfb9cf5478ce77ULL, 0x1f37ad21436d0c6fULL},
+    {0x1fcc94a5dd2d71f9ULL, 0x18f9574dcf8a7059ULL},
+    {0x7fd6dd517dbdf4c7ULL, 0x13faac3e3fa1f37aULL},
+    {0xffbe2ee8c92fee0bULL, 0x1ff779fd329cb8c3ULL},
+    {0x6631bf20a0f324d6ULL, 0x1992c7fdc216fa36ULL},
+    {0xb827cc1a1a5c1d78ULL, 0x14756ccb01abfb5eULL},
+    {0x935309ae7b7ce460ULL, 0x105df0a267bcc918ULL},
+    {0x1eeb42b0c594a099ULL, 0x1a2fe76a3f9474f4ULL},
+    {0xe58902270476e6e1ULL, 0x14f31f8832dd2a5cULL},
+    {0xb7a0ce859d2bebe7ULL, 0x10c27fa028b0eeb0ULL},
+    {0x59014a6f61dfdfd8ULL, 0x1ad0cc33744e4ab4ULL},
+    {0xe0cdd525e7e64cadULL, 0x1573d68f903ea229ULL},
+    {0x4d7177518651d6f1ULL, 0x11297872d9cbb4eeULL},
+    {0x7be8bee8d6e957e8ULL, 0x1b758d848fac54b0ULL},
+    {0xfcba3253df211320ULL, 0x15f7a46a0c89dd59ULL},
+    {0x63c8284318e74280ULL, 0x1192e9ee706e4aaeULL},
+    {0x060d0d3827d86a66ULL, 0x1c1e43171a4a1117ULL},
+    {0x6b3da42cecad21ebULL, 0x167e9c127b6e7412ULL},
+    {0x88fe1cf0bd574e56ULL, 0x11fee341fc585cdbULL},
+    {0x419694b462254a23ULL, 0x1ccb0536608d615fULL},
+    {0x67abaa29e81dd4e9ULL, 0x1708d0f84d3de77fULL},
+    {0xb95621bb2017dd87ULL, 0x126d73f9d764b932ULL},
+    {0xc223692b668c95a5ULL, 0x1d7becc2f23ac1eaULL},
+    {0xce82ba891ed6de1dULL, 0x179657025b6234bbULL},
+    {0xa53562074bdf1818ULL, 0x12deac01e2b4f6fcULL},
+    {0x3b889cd87964f359ULL, 0x1e3113363787f194ULL},
+    {0xfc6d4a46c783f5e1ULL, 0x18274291c6065adcULL},
+    {0x30576e9f06032b1aULL, 0x13529ba7d19eaf17ULL},
+    {0x1a257dcb3cd1de90ULL, 0x1eea92a61c311825ULL},
+    {0x481dfe3c30a7e540ULL, 0x18bba884e35a79b7ULL},
+    {0xd34b31c9c0865100ULL, 0x13c9539d82aec7c5ULL},
+    {0x5211e942cda3b4cdULL, 0x1fa885c8d117a609ULL},
+    {0x74db21023e1c90a4ULL, 0x19539e3a40dfb807ULL},
+    {0xf715b401cb4a0d50ULL, 0x1442e4fb67196005ULL},
+    {0xf8de299b09080aa7ULL, 0x103583fc527ab337ULL},
+    {0x8e304291a80cddd7ULL, 0x19ef3993b72ab859ULL},
+    {0x3e8d020e200a4b13ULL, 0x14bf6142f8eef9e1ULL},
+    {0x653d9b3e80083c0fULL, 0x10991a9bfa58c7e7ULL},
+    {0x6ec8f864000d2ce4ULL, 0x1a8e90f9908e0ca5ULL},
+    {0x8bd3f9e999a423eaULL, 0x153eda614071a3b7ULL},
+    {0x3ca994bae1501cbbULL, 0x10ff151a99f482f9ULL},
+    {0xc775bac49bb3612bULL, 0x1b31bb5dc320d18eULL},
+    {0xd2c4956a16291a89ULL, 0x15c162b168e70e0bULL},
+    {0xdbd0778811ba7ba1ULL, 0x11678227871f3e6fULL},
+    {0x2c80bf401c5d929bULL, 0x1bd8d03f3e9863e6ULL},
+    {0xbd33cc3349e47549ULL, 0x16470cff6546b651ULL},
+    {0xca8fd68f6e505dd4ULL, 0x11d270cc51055ea7ULL},
+    {0x4419574be3b3c953ULL, 0x1c83e7ad4e6efdd9ULL},
+    {0x0347790982f63aa9ULL, 0x16cfec8aa52597e1ULL},
+    {0xcf6c60d468c4fbbaULL, 0x123ff06eea847980ULL},
+    {0xe57a34870e07f92aULL, 0x1d331a4b10d3f59aULL},
+    {0x512e906c0b399422ULL, 0x175c1508da432ae2ULL},
+    {0xda8ba6bcd5c7a9b5ULL, 0x12b010d3e1cf5581ULL},
+    {0x90df712e22d90f87ULL, 0x1de6815302e5559cULL},
+    {0xda4c5a8b4f140c6cULL, 0x17eb9aa8cf1dde16ULL},
+    {0xaea37ba2a5a9a38aULL, 0x1322e220a5b17e78ULL},
+    {0x7dd25f6aa2a905a9ULL, 0x1e9e369aa2b59727ULL},
+    {0x97db7f888220d154ULL, 0x187e92154ef7ac1fULL},
+    {0x797c6606ce80a777ULL, 0x139874ddd8c6234cULL},
+    {0x8f2d700ae4010bf1ULL, 0x1f5a549627a36badULL},
+    {0x0c2459a25000d65aULL, 0x191510781fb5efbeULL},
+    {0x701d1481d99a4515ULL, 0x1410d9f9b2f7f2feULL},
+    {0xc017439b147b6a77ULL, 0x100d7b2e28c65bfeULL},
+    {0xccf205c4ed9243f2ULL, 0x19af2b7d0e0a2ccaULL},
+    {0x0a5b37d0be0e9cc2ULL, 0x148c22ca71a1bd6fULL},
+    {0x0848f973cb3ee3ceULL, 0x10701bd527b4978cULL},
+    {0xda0e5bec78649fb0ULL, 0x1a4cf9550c5425acULL},
+    {0x7b3eaff060507fc0ULL, 0x150a6110d6a9b7bdULL},
+    {0x95cbbff380406633ULL, 0x10d51a73deee2c97ULL},
+    {0xefac665266cd7052ULL, 0x1aee90b964b04758ULL},
+    {0x2623850eb8a459dbULL, 0x158ba6fab6f36c47ULL},
+    {0x1e82d0d893b6ae49ULL, 0x113c85955f29236cULL},
+    {0xfd9e1af41f8ab075ULL, 0x1b9408eefea838acULL},
+    {0x97b1af29b2d559f7ULL, 0x16100725988693bdULL},
+    {0xac8e25baf5777b2cULL, 0x11a66c1e139edc97ULL},
+    {0x7a7d092b2258c513ULL, 0x1c3d79c9b8fe2dbfULL},
+    {0x61fda0ef4ead6a76ULL, 0x169794a160cb57ccULL},
+    {0xe7fe1a590bbdeec5ULL, 0x1212dd4de7091309ULL},
+    {0xa6635d5b45fcb13aULL, 0x1ceafbafd80e84dcULL},
+    {0x851c4aaf6b308dc8ULL, 0x172262f3133ed0b0ULL},
+    {0xd0e36ef2bc26d7d4ULL, 0x1281e8c275cbda26ULL},
+    {0xb49f17eac6a48c86ULL, 0x1d9ca79d894629d7ULL},
+    {0x2a18dfef0550706bULL, 0x17b08617a104ee46ULL},
+    {0x54e0b3259dd9f389ULL, 0x12f39e794d9d8b6bULL},
+    {0x87cdeb6f62f65274ULL, 0x1e5297287c2f4578ULL},
+    {0xd30b22bf825ea85dULL, 0x18421286c9bf6ac6ULL},
+    {0x0f3c1bcc684bb9e4ULL, 0x13680ed23aff889fULL},
+    {0x18602c7a4079296dULL, 0x1f0ce4839198da98ULL},
+    {0x46b356c833942124ULL, 0x18d71d360e13e213ULL},
+    {0x388f78a029434db6ULL, 0x13df4a91a4dcb4dcULL},
+    {0x5a7f2766a86baf8aULL, 0x1fcbaa82a1612160ULL},
+    {0x153285ebb9efbfa2ULL, 0x196fbb9bb44db44dULL},
+    {0xaa8ed189618c994eULL, 0x145962e2f6a4903dULL},
+    {0xeed8a7a11ad6e10cULL, 0x1047824f2bb6d9caULL},
+    {0x7e27729b5e249b45ULL, 0x1a0c03b1df8af611ULL},
+    {0xfe85f549181d4904ULL, 0x14d6695b193bf80dULL},
+    {0xcb9e5dd4134aa0d0ULL, 0x10ab877c142ff9a4ULL},
+    {0xdf63c9535211014dULL, 0x1aac0bf9b9e65c3aULL},
+    {0x191ca10f74da6771ULL, 0x15566ffafb1eb02fULL},
+    {0xadb080d92a4852c1ULL, 0x1111f32f2f4bc025ULL},
+    {0x15e7348eaa0d5134ULL, 0x1b4feb7eb212cd09ULL},
+    {0xab1f5d3eee710dc4ULL, 0x15d98932280f0a6dULL},
+    {0xbc1917658b8da49dULL, 0x117ad428200c0857ULL},
+    {0x2cf4f23c127c3a94ULL, 0x1bf7b9d9cce00d59ULL},
+    {0xf0c3f4fcdb969543ULL, 0x165fc7e170b33de0ULL},
+    {0x5a365d9716121103ULL, 0x11e6398126f5cb1aULL},
+    {0x9056fc24f01ce804ULL, 0x1ca38f350b22de90ULL},
+    {0xd9df301d8ce3ecd0ULL, 0x16e93f5da2824ba6ULL},
+    {0xe17f59b13d8323daULL, 0x125432b14ecea2ebULL},
+    {0x68cbc2b52f38395cULL, 0x1d53844ee47dd179ULL},
+    {0x53d6355dbf602de3ULL, 0x177603725064a794ULL},
+    {0xa9782ab165e68b1cULL, 0x12c4cf8ea6b6ec76ULL},
+    {0x0f26aab56fd744faULL, 0x1e07b27dd78b13f1ULL},
+    {0x3f52222abfdf6a62ULL, 0x18062864ac6f4327ULL},
+    {0x65db4e88997f884eULL, 0x1338205089f29c1fULL},
+    {0x6fc54a7428cc0d4aULL, 0x1ec033b40fea9365ULL},
+    {0x596aa1f68709a43bULL, 0x1899c2f673220f84ULL},
+    {0xadeee7f86c07b696ULL, 0x13ae3591f5b4d936ULL},
+    {0x497e3ff3e00c5756ULL, 0x1f7d228322baf524ULL},
+    {0xd464fff64cd6ac45ULL, 0x1930e868e89590e9ULL},
+    {0x4383fff83d7889d1ULL, 0x14272053ed4473eeULL},
+    {0xcf9cccc69793a174ULL, 0x101f4d0ff1038ff1ULL},
+    {0x7f6147a425b90252ULL, 0x19cbae7fe805b31cULL},
+    {0xcc4dd2e9b7c7350fULL, 0x14a2f1ffecd15c16ULL},
+    {0x3d0b0f215fd290d9ULL, 0x10825b3323dab012ULL},
+    {0x61ab4b689950e7c1ULL, 0x1a6a2b85062ab350ULL},
+    {0x4e22a2ba1440b967ULL, 0x1521bc6a6b555c40ULL},
+    {0x0b4ee894dd009453ULL, 0x10e7c9eebc4449cdULL},
+    {0x1217da87c800ed51ULL, 0x1b0c764ac6d3a948ULL},
+    {0xdb46486ca000bddaULL, 0x15a391d56bdc876cULL},
+    {0x490506bd4ccd64afULL, 0x114fa7ddefe39f8aULL},
+    {0xa8080ac87ae23ab1ULL, 0x1bb2a62fe638ff43ULL},
+    {0x5339a239fbe82ef4ULL, 0x162884f31e93ff69ULL},
+    {0x75c7b4fb2fecf25dULL, 0x11ba03f5b20fff87ULL},
+    {0x22d92191e647ea2eULL, 0x1c5cd322b67fff3fULL},
+    {0xb57a8141850654f2ULL, 0x16b0a8e891ffff65ULL},
+    {0xc4620101373843f5ULL, 0x1226ed86db3332b7ULL},
+    {0x3a366801f1f39feeULL, 0x1d0b15a491eb8459ULL},
+    {0xfb5eb99b27f6198bULL, 0x173c115074bc69e0ULL},
+    {0x2f7efae2865e7ad6ULL, 0x129674405d6387e7ULL},
+    {0xe597f7d0d6fd9156ULL, 0x1dbd86cd6238d971ULL},
+    {0x8479930d78cadaabULL, 0x17cad23de82d7ac1ULL},
+    {0xd06142712d6f1556ULL, 0x1308a831868ac89aULL},
+    {0x4d686a4eaf182222ULL, 0x1e74404f3daada91ULL},
+    {0xa453883ef279b4e8ULL, 0x185d003f6488aedaULL},
+    {0xe9dc6cff28615d87ULL, 0x137d99cc506d58aeULL},
+    {0xa960ae650d6895a4ULL, 0x1f2f5c7a1a488de4ULL},
+    {0xbab3beb73ded4483ULL, 0x18f2b061aea07183ULL},
+    {0x2ef6322c318a9d36ULL, 0x13f559e7bee6c136ULL},
+    {0xe4bd1d13827761f0ULL, 0x1feef63f97d79b89ULL},
+    {0x83ca7da9352c4e5aULL, 0x198bf832dfdfafa1ULL},
+    {0x9ca1fe20f756a515ULL, 0x146ff9c24cb2f2e7ULL},
+    {0x4a1b31b3f9121daaULL, 0x1059949b708f28b9ULL},
+    {0x435eb5ecc1b695ddULL, 0x1a28edc580e50df5ULL},
+    {0x35e55e57015ede4aULL, 0x14ed8b04671da4c4ULL},
+    {0xc4b77eac0118b1d5ULL, 0x10be08d0527e1d69ULL},
+    {0xa12597799b5ab622ULL, 0x1ac9a7b3b7302f0fULL},
+    {0x4db7ac6149155e81ULL, 0x156e1fc2f8f358d9ULL},
+    {0xd7c6238107444b9bULL, 0x1124e63593f5e0adULL},
+    {0x593d059b3ed3ac2bULL, 0x1b6e3d2286563449ULL},
+    {0xe0fd9e15cbdc89bcULL, 0x15f1ca820511c36dULL},
+    {0xb3fe18116fe3a163ULL, 0x118e3b9b37416924ULL},
+    {0x866359b57fd29bd1ULL, 0x1c16c5c525357507ULL},
+    {0xd1e91491330ee30eULL, 0x16789e3750f790d2ULL},
+    {0x74ba76da8f3f1c0bULL, 0x11fa182c40c60d75ULL},
+    {0xedf72490e531c678ULL, 0x1cc359e067a348bbULL},
+    {0x8b2c1d40b75b052dULL, 0x1702ae4d1fb5d3c9ULL},
+    {0x6f567dcd5f7c0424ULL, 0x12688b70e62b0fd4ULL},
+    {0x7ef0c94898c66d06ULL, 0x1d74124e3d11b2edULL},
+    {0x98c0a106e09ebd9fULL, 0x17900ea4fda7c257ULL},
+    {0x470080d24d4bcae6ULL, 0x12d9a550caec9b79ULL},
+    {0xd800ce1d487944a2ULL, 0x1e29088144adc58eULL},
+    {0x1333d8176d2dd082ULL, 0x1820d39a9d57d13fULL},
+    {0xa8f646792424a6ceULL, 0x134d76154aaca765ULL},
+    {0x74bd3d8ea03aa47dULL, 0x1ee25688777aa56fULL},
+    {0x5d64313ee6955064ULL, 0x18b51206c5fbb78cULL},
+    {0x4ab68dcbebaaa6b7ULL, 0x13c40e6bd1962c70ULL},
+    {0x1124161312aaa457ULL, 0x1fa01712e8f0471aULL},
+    {0xda8344dc0eeee9dfULL, 0x194cdf4253f36c14ULL},
+    {0xe2029d7cd8bf2180ULL, 0x143d7f6843292343ULL},
+    {0x4e687dfd7a328133ULL, 0x103132b9cf541c36ULL},
+    {0x4a40c9959050ceb8ULL, 0x19e851294bb9c6bdULL},
+    {0x0833d477a6a70bc6ULL, 0x14b9da876fc7d231ULL},
+    {0xa02976c61eec096bULL, 0x1094aed2bfd30e8dULL},
+    {0x004257a364acdbdfULL, 0x1a877e1dffb81749ULL},
+    {0xcd01dfb5ea23e319ULL, 0x153931b1996012a0ULL},
+    {0x70ce4c91881cb5aeULL, 0x10fa8e27ade6754dULL},
+    {0x1ae3adb5a69455e2ULL, 0x1b2a7d0c4970bbafULL},
+    {0x7be957c4854377e8ULL, 0x15bb973d078d62f2ULL},
+    {0xc987796a0435f987ULL, 0x1162df64060ab58eULL},
+    {0x75a58f1006bcc271ULL, 0x1bd1656cd67788e4ULL},
+    {0xf7b7a5a66bca3527ULL, 0x16411df0ab92d3e9ULL},
+    {0x5fc61e1ebca1c41fULL, 0x11cdb18d560f0feeULL},
+    {0xffa363646102d365ULL, 0x1c7c4f4889b1b316ULL},
+    {0x32e91c504d9bdc51ULL, 0x16c9d906d48e28dfULL},
+    {0x8f20e37371497d0eULL, 0x123b140576d820b2ULL},
+    {0x7e9b0585820f2e7cULL, 0x1d2b533bf159cdeaULL},
+    {0xcbaf379e01a5becaULL, 0x1755dc2ff447d7eeULL},
+    {0x0958f94b348498a1ULL, 0x12ab168cc36cacbfULL}
+    };
+
 // clang-format on
 
 inline bool is_plain_string_character(char c) {
@@ -161,6 +845,251 @@ inline bool is_whitespace(char c) {
     return (globals::parse_flags[static_cast<unsigned char>(c)] & 2) != 0;
 }
 
+inline bool must_escape(char c) {
+    // return c < 0x20 || c == 0x22 || c == 0x5c;
+    return (globals::parse_flags[static_cast<unsigned char>(c)] & 4) != 0;
+}
+
+// Returns 10 to the given power, saturating to infinity and zero.
+inline double pow10(int64_t exponent) {
+    if (SAJSON_UNLIKELY(exponent > 308)) {
+        return std::numeric_limits<double>::infinity();
+    } else if (SAJSON_UNLIKELY(exponent < -323)) {
+        return 0.0;
+    }
+
+    // clang-format off
+    static const double constants[] = {
+        1e-323,1e-322,1e-321,1e-320,1e-319,1e-318,1e-317,1e-316,1e-315,1e-314,
+        1e-313,1e-312,1e-311,1e-310,1e-309,1e-308,1e-307,1e-306,1e-305,1e-304,
+        1e-303,1e-302,1e-301,1e-300,1e-299,1e-298,1e-297,1e-296,1e-295,1e-294,
+        1e-293,1e-292,1e-291,1e-290,1e-289,1e-288,1e-287,1e-286,1e-285,1e-284,
+        1e-283,1e-282,1e-281,1e-280,1e-279,1e-278,1e-277,1e-276,1e-275,1e-274,
+        1e-273,1e-272,1e-271,1e-270,1e-269,1e-268,1e-267,1e-266,1e-265,1e-264,
+        1e-263,1e-262,1e-261,1e-260,1e-259,1e-258,1e-257,1e-256,1e-255,1e-254,
+        1e-253,1e-252,1e-251,1e-250,1e-249,1e-248,1e-247,1e-246,1e-245,1e-244,
+        1e-243,1e-242,1e-241,1e-240,1e-239,1e-238,1e-237,1e-236,1e-235,1e-234,
+        1e-233,1e-232,1e-231,1e-230,1e-229,1e-228,1e-227,1e-226,1e-225,1e-224,
+        1e-223,1e-222,1e-221,1e-220,1e-219,1e-218,1e-217,1e-216,1e-215,1e-214,
+        1e-213,1e-212,1e-211,1e-210,1e-209,1e-208,1e-207,1e-206,1e-205,1e-204,
+        1e-203,1e-202,1e-201,1e-200,1e-199,1e-198,1e-197,1e-196,1e-195,1e-194,
+        1e-193,1e-192,1e-191,1e-190,1e-189,1e-188,1e-187,1e-186,1e-185,1e-184,
+        1e-183,1e-182,1e-181,1e-180,1e-179,1e-178,1e-177,1e-176,1e-175,1e-174,
+        1e-173,1e-172,1e-171,1e-170,1e-169,1e-168,1e-167,1e-166,1e-165,1e-164,
+        1e-163,1e-162,1e-161,1e-160,1e-159,1e-158,1e-157,1e-156,1e-155,1e-154,
+        1e-153,1e-152,1e-151,1e-150,1e-149,1e-148,1e-147,1e-146,1e-145,1e-144,
+        1e-143,1e-142,1e-141,1e-140,1e-139,1e-138,1e-137,1e-136,1e-135,1e-134,
+        1e-133,1e-132,1e-131,1e-130,1e-129,1e-128,1e-127,1e-126,1e-125,1e-124,
+        1e-123,1e-122,1e-121,1e-120,1e-119,1e-118,1e-117,1e-116,1e-115,1e-114,
+        1e-113,1e-112,1e-111,1e-110,1e-109,1e-108,1e-107,1e-106,1e-105,1e-104,
+        1e-103,1e-102,1e-101,1e-100,1e-99,1e-98,1e-97,1e-96,1e-95,1e-94,1e-93,
+        1e-92,1e-91,1e-90,1e-89,1e-88,1e-87,1e-86,1e-85,1e-84,1e-83,1e-82,1e-81,
+        1e-80,1e-79,1e-78,1e-77,1e-76,1e-75,1e-74,1e-73,1e-72,1e-71,1e-70,1e-69,
+        1e-68,1e-67,1e-66,1e-65,1e-64,1e-63,1e-62,1e-61,1e-60,1e-59,1e-58,1e-57,
+        1e-56,1e-55,1e-54,1e-53,1e-52,1e-51,1e-50,1e-49,1e-48,1e-47,1e-46,1e-45,
+        1e-44,1e-43,1e-42,1e-41,1e-40,1e-39,1e-38,1e-37,1e-36,1e-35,1e-34,1e-33,
+        1e-32,1e-31,1e-30,1e-29,1e-28,1e-27,1e-26,1e-25,1e-24,1e-23,1e-22,1e-21,
+        1e-20,1e-19,1e-18,1e-17,1e-16,1e-15,1e-14,1e-13,1e-12,1e-11,1e-10,1e-9,
+        1e-8,1e-7,1e-6,1e-5,1e-4,1e-3,1e-2,1e-1,1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,
+        1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,
+        1e22,1e23,1e24,1e25,1e26,1e27,1e28,1e29,1e30,1e31,1e32,1e33,1e34,1e35,
+        1e36,1e37,1e38,1e39,1e40,1e41,1e42,1e43,1e44,1e45,1e46,1e47,1e48,1e49,
+        1e50,1e51,1e52,1e53,1e54,1e55,1e56,1e57,1e58,1e59,1e60,1e61,1e62,1e63,
+        1e64,1e65,1e66,1e67,1e68,1e69,1e70,1e71,1e72,1e73,1e74,1e75,1e76,1e77,
+        1e78,1e79,1e80,1e81,1e82,1e83,1e84,1e85,1e86,1e87,1e88,1e89,1e90,1e91,
+        1e92,1e93,1e94,1e95,1e96,1e97,1e98,1e99,1e100,1e101,1e102,1e103,1e104,
+        1e105,1e106,1e107,1e108,1e109,1e110,1e111,1e112,1e113,1e114,1e115,1e116,
+        1e117,1e118,1e119,1e120,1e121,1e122,1e123,1e124,1e125,1e126,1e127,1e128,
+        1e129,1e130,1e131,1e132,1e133,1e134,1e135,1e136,1e137,1e138,1e139,1e140,
+        1e141,1e142,1e143,1e144,1e145,1e146,1e147,1e148,1e149,1e150,1e151,1e152,
+        1e153,1e154,1e155,1e156,1e157,1e158,1e159,1e160,1e161,1e162,1e163,1e164,
+        1e165,1e166,1e167,1e168,1e169,1e170,1e171,1e172,1e173,1e174,1e175,1e176,
+        1e177,1e178,1e179,1e180,1e181,1e182,1e183,1e184,1e185,1e186,1e187,1e188,
+        1e189,1e190,1e191,1e192,1e193,1e194,1e195,1e196,1e197,1e198,1e199,1e200,
+        1e201,1e202,1e203,1e204,1e205,1e206,1e207,1e208,1e209,1e210,1e211,1e212,
+        1e213,1e214,1e215,1e216,1e217,1e218,1e219,1e220,1e221,1e222,1e223,1e224,
+        1e225,1e226,1e227,1e228,1e229,1e230,1e231,1e232,1e233,1e234,1e235,1e236,
+        1e237,1e238,1e239,1e240,1e241,1e242,1e243,1e244,1e245,1e246,1e247,1e248,
+        1e249,1e250,1e251,1e252,1e253,1e254,1e255,1e256,1e257,1e258,1e259,1e260,
+        1e261,1e262,1e263,1e264,1e265,1e266,1e267,1e268,1e269,1e270,1e271,1e272,
+        1e273,1e274,1e275,1e276,1e277,1e278,1e279,1e280,1e281,1e282,1e283,1e284,
+        1e285,1e286,1e287,1e288,1e289,1e290,1e291,1e292,1e293,1e294,1e295,1e296,
+        1e297,1e298,1e299,1e300,1e301,1e302,1e303,1e304,1e305,1e306,1e307,1e308
+    };
+    // clang-format on
+
+    return constants[exponent + 323];
+}
+
+// The helpers below implement Ulf Adams' Ryu algorithms for converting between
+// doubles and decimals, sharing the tables above.  See "Ryu: Fast
+// Float-to-String Conversion" (PLDI 2018) and "Ryū Revisited: Printf Floating
+// Point Conversion" (OOPSLA 2019).
+static const int POW5_BITCOUNT = 125;
+static const int POW5_INV_BITCOUNT = 125;
+static const int DOUBLE_MANTISSA_BITS = 52;
+static const int DOUBLE_BIAS = 1023;
+
+// Returns floor(log2(5^e)) for 0 <= e <= 3528.
+inline int log2_pow5(int e) {
+    return static_cast<int>((static_cast<uint32_t>(e) * 1217359) >> 19);
+}
+
+// Returns ceil(log2(5^e)) for 0 < e <= 3528, and 1 for e = 0.
+inline int pow5_bits(int e) { return log2_pow5(e) + 1; }
+
+// Returns floor(log10(2^e)) for 0 <= e <= 1650.
+inline int log10_pow2(int e) {
+    return static_cast<int>((static_cast<uint32_t>(e) * 78913) >> 18);
+}
+
+// Returns floor(log10(5^e)) for 0 <= e <= 2620.
+inline int log10_pow5(int e) {
+    return static_cast<int>((static_cast<uint32_t>(e) * 732923) >> 20);
+}
+
+inline bool multiple_of_pow5(uint64_t v, int p) {
+    // v is never zero.
+    int count = 0;
+    while (v % 5 == 0 && count < p) {
+        v /= 5;
+        ++count;
+    }
+    return count >= p;
+}
+
+inline bool multiple_of_pow2(uint64_t v, int p) {
+    return (v & ((uint64_t(1) << p) - 1)) == 0;
+}
+
+inline int floor_log2(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    int result = 0;
+    while (v >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+// Returns (m * factor) >> shift, where factor is a {low, high} table entry and
+// 64 <= shift < 128.
+inline uint64_t mul_shift(uint64_t m, const uint64_t* factor, int shift) {
+#ifdef __SIZEOF_INT128__
+    typedef unsigned __int128 uint128;
+    const uint128 low = static_cast<uint128>(m) * factor[0];
+    const uint128 high = static_cast<uint128>(m) * factor[1];
+    return static_cast<uint64_t>(((low >> 64) + high) >> (shift - 64));
+#else
+    // Schoolbook multiplication in 32-bit halves for targets without a
+    // 128-bit integer type.
+    struct product {
+        uint64_t low;
+        uint64_t high;
+        product(uint64_t a, uint64_t b) {
+            const uint64_t a0 = static_cast<uint32_t>(a);
+            const uint64_t a1 = a >> 32;
+            const uint64_t b0 = static_cast<uint32_t>(b);
+            const uint64_t b1 = b >> 32;
+            const uint64_t p00 = a0 * b0;
+            const uint64_t mid1 = a1 * b0 + (p00 >> 32);
+            const uint64_t mid2 = a0 * b1 + static_cast<uint32_t>(mid1);
+            high = a1 * b1 + (mid1 >> 32) + (mid2 >> 32);
+            low = (mid2 << 32) | static_cast<uint32_t>(p00);
+        }
+    };
+    const product low(m, factor[0]);
+    const product high(m, factor[1]);
+    const uint64_t middle = low.high + high.low;
+    const uint64_t top = high.high + (middle < low.high);
+    const int distance = shift - 64;
+    if (distance == 0) {
+        return middle;
+    }
+    return (top << (64 - distance)) | (middle >> distance);
+#endif
+}
+
+// Returns the number of decimal digits in v, which is less than 10^17.
+inline int decimal_length(uint64_t v) {
+    int length = 1;
+    for (uint64_t limit = 10; length < 17 && v >= limit; limit *= 10) {
+        ++length;
+    }
+    return length;
+}
+
+// Returns m10 * 10^e10 correctly rounded to the nearest double, ties to even.
+// m10 must be less than 10^17.  This is Ryu's s2d, preceded by Clinger's exact
+// fast path where the target's double arithmetic allows it.
+inline double decimal_to_double(uint64_t m10, int64_t e10) {
+    if (m10 == 0) {
+        return 0.0;
+    }
+    const int m10_digits = decimal_length(m10);
+    if (e10 + m10_digits <= -324) {
+        return 0.0;
+    }
+    if (e10 + m10_digits >= 310) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD >= 0 && FLT_EVAL_METHOD <= 1
+    // Both operands are exact, so one correctly rounded operation suffices.
+    // x87 extended precision would round twice, so it takes the slow path.
+    if (m10 <= (uint64_t(1) << 53) && e10 >= -22 && e10 <= 22) {
+        const double d = static_cast<double>(m10);
+        return e10 < 0 ? d / pow10(-e10) : d * pow10(e10);
+    }
+#endif
+
+    const int e = static_cast<int>(e10);
+    // Compute the top bits of m10 * 10^e as m2 * 2^e2, with at least two
+    // bits beyond the mantissa, and whether any discarded bits were set.
+    int e2;
+    uint64_t m2;
+    bool trailing_zeros;
+    if (e >= 0) {
+        e2 = floor_log2(m10) + e + log2_pow5(e) - (DOUBLE_MANTISSA_BITS + 1);
+        const int j = e2 - e - pow5_bits(e) + POW5_BITCOUNT;
+        m2 = mul_shift(m10, globals::pow5_split[e], j);
+        trailing_zeros
+            = e2 < e || (e2 - e < 64 && multiple_of_pow2(m10, e2 - e));
+    } else {
+        e2 = floor_log2(m10) + e - pow5_bits(-e) - (DOUBLE_MANTISSA_BITS + 1);
+        const int j = e2 - e + pow5_bits(-e) - 1 + POW5_INV_BITCOUNT;
+        m2 = mul_shift(m10, globals::pow5_inv_split[-e], j);
+        trailing_zeros = multiple_of_pow5(m10, -e);
+    }
+
+    int ieee_e2 = std::max(0, e2 + DOUBLE_BIAS + floor_log2(m2));
+    if (ieee_e2 > 0x7fe) {
+        return std::numeric_limits<double>::infinity();
+    }
+    // Subnormals keep fewer mantissa bits.
+    const int shift = (ieee_e2 == 0 ? 1 : ieee_e2) - e2 - DOUBLE_BIAS
+        - DOUBLE_MANTISSA_BITS;
+    trailing_zeros = trailing_zeros
+        && (m2 & ((uint64_t(1) << (shift - 1)) - 1)) == 0;
+    const bool last_removed_bit = ((m2 >> (shift - 1)) & 1) != 0;
+    const bool round_up
+        = last_removed_bit && (!trailing_zeros || ((m2 >> shift) & 1) != 0);
+    uint64_t ieee_m2 = (m2 >> shift) + round_up;
+    ieee_m2 &= (uint64_t(1) << DOUBLE_MANTISSA_BITS) - 1;
+    if (ieee_m2 == 0 && round_up) {
+        // Rounding carried into the exponent.
+        ++ieee_e2;
+    }
+
+    const uint64_t bits
+        = (static_cast<uint64_t>(ieee_e2) << DOUBLE_MANTISSA_BITS) | ieee_m2;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
 class allocated_buffer {
 public:
     allocated_buffer()
@@ -261,6 +1190,35 @@ public:
     }
 };
 
+namespace internal {
+// Orders object keys the way parse sorts them: shorter keys first, then keys
+// of equal length by memcmp.  Returns <0, 0, or >0.
+inline int compare_keys(const string& a, const string& b) {
+    if (a.length() != b.length()) {
+        return a.length() < b.length() ? -1 : 1;
+    }
+    return memcmp(a.data(), b.data(), a.length());
+}
+
+#ifndef SAJSON_NO_STD_STRING
+// Appends key to path as a JSON Pointer reference token, escaping ~ and / as
+// ~0 and ~1.
+inline void append_pointer_token(std::string& path, const string& key) {
+    path += '/';
+    for (size_t i = 0; i < key.length(); ++i) {
+        const char c = key.data()[i];
+        if (c == '~') {
+            path += "~0";
+        } else if (c == '/') {
+            path += "~1";
+        } else {
+            path += c;
+        }
+    }
+}
+#endif
+} // namespace internal
+
 /// A pointer to a mutable buffer, its size in bytes, and strong ownership of
 /// any copied memory.
 class mutable_string_view {
@@ -315,6 +1273,19 @@ public:
         that.data = 0;
     }
 
+    /// \cond INTERNAL
+
+    // WARNING: Internal constructor exposed for companion headers that
+    // produce their input into an allocated buffer.  The view takes shared
+    // ownership of the buffer, which must hold at least length bytes.
+    mutable_string_view(
+        size_t length, const internal::allocated_buffer& buffer_)
+        : length_(length)
+        , data(buffer_.get_data())
+        , buffer(buffer_) {}
+
+    /// \endcond
+
     mutable_string_view& operator=(mutable_string_view&& that) {
         if (this != &that) {
             length_ = that.length_;
@@ -357,14 +1328,7 @@ struct object_key_comparator {
         : data(object_data) {}
 
     bool operator()(const object_key_record& lhs, const string& rhs) const {
-        const size_t lhs_length = lhs.key_end - lhs.key_start;
-        const size_t rhs_length = rhs.length();
-        if (lhs_length < rhs_length) {
-            return true;
-        } else if (lhs_length > rhs_length) {
-            return false;
-        }
-        return memcmp(data + lhs.key_start, rhs.data(), lhs_length) < 0;
+        return compare_keys(key_of(lhs), rhs) < 0;
     }
 
     bool operator()(const string& lhs, const object_key_record& rhs) const {
@@ -373,19 +1337,112 @@ struct object_key_comparator {
 
     bool
     operator()(const object_key_record& lhs, const object_key_record& rhs) {
-        const size_t lhs_length = lhs.key_end - lhs.key_start;
-        const size_t rhs_length = rhs.key_end - rhs.key_start;
-        if (lhs_length < rhs_length) {
-            return true;
-        } else if (lhs_length > rhs_length) {
-            return false;
-        }
-        return memcmp(data + lhs.key_start, data + rhs.key_start, lhs_length)
-            < 0;
+        return compare_keys(key_of(lhs), key_of(rhs)) < 0;
+    }
+
+    string key_of(const object_key_record& record) const {
+        return string(
+            data + record.key_start, record.key_end - record.key_start);
     }
 
     const char* data;
 };
+
+// Hashing for value::hash().  The definition is part of the interface:
+// hashes are stable across platforms and releases.
+static const uint64_t hash_k0 = 0xa0761d6478bd642fULL;
+static const uint64_t hash_k1 = 0xe7037ed1a0b428dbULL;
+static const uint64_t hash_k2 = 0x8ebc6af09c88c6e3ULL;
+static const uint64_t hash_k3 = 0x589965cc75374cc3ULL;
+
+// Returns the low and high halves of a * b, XORed together.
+inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    typedef unsigned __int128 uint128;
+    const uint128 product = static_cast<uint128>(a) * b;
+    return static_cast<uint64_t>(product)
+        ^ static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t a0 = static_cast<uint32_t>(a);
+    const uint64_t a1 = a >> 32;
+    const uint64_t b0 = static_cast<uint32_t>(b);
+    const uint64_t b1 = b >> 32;
+    const uint64_t p00 = a0 * b0;
+    const uint64_t mid1 = a1 * b0 + (p00 >> 32);
+    const uint64_t mid2 = a0 * b1 + static_cast<uint32_t>(mid1);
+    const uint64_t high = a1 * b1 + (mid1 >> 32) + (mid2 >> 32);
+    const uint64_t low = (mid2 << 32) | static_cast<uint32_t>(p00);
+    return low ^ high;
+#endif
+}
+
+// Reads little-endian words, whatever the host's byte order.
+inline uint64_t hash_read32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return uint64_t(u[0]) | (uint64_t(u[1]) << 8) | (uint64_t(u[2]) << 16)
+        | (uint64_t(u[3]) << 24);
+}
+
+inline uint64_t hash_read64(const char* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+#else
+    return hash_read32(p) | (hash_read32(p + 4) << 32);
+#endif
+}
+
+// Hashes length bytes with a multiply-fold in the style of wyhash.  Long
+// inputs are consumed 48 bytes per round in three independent lanes, so
+// the multiplies overlap.
+inline uint64_t hash_bytes(const char* p, size_t length, uint64_t seed) {
+    seed ^= hash_mix(seed ^ hash_k0, hash_k1);
+    uint64_t a;
+    uint64_t b;
+    if (length <= 16) {
+        if (length >= 4) {
+            const size_t middle = (length >> 3) << 2;
+            a = (hash_read32(p) << 32) | hash_read32(p + middle);
+            b = (hash_read32(p + length - 4) << 32)
+                | hash_read32(p + length - 4 - middle);
+        } else if (length > 0) {
+            const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+            a = (uint64_t(u[0]) << 16) | (uint64_t(u[length >> 1]) << 8)
+                | u[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) {
+            uint64_t lane1 = seed;
+            uint64_t lane2 = seed;
+            do {
+                seed = hash_mix(
+                    hash_read64(p) ^ hash_k1, hash_read64(p + 8) ^ seed);
+                lane1 = hash_mix(
+                    hash_read64(p + 16) ^ hash_k2, hash_read64(p + 24) ^ lane1);
+                lane2 = hash_mix(
+                    hash_read64(p + 32) ^ hash_k3, hash_read64(p + 40) ^ lane2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while (i > 16) {
+            seed = hash_mix(
+                hash_read64(p) ^ hash_k1, hash_read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
+    }
+    return hash_mix(
+        hash_k1 ^ length, hash_mix(a ^ hash_k1, b ^ seed) ^ hash_k0 ^ length);
+}
 } // namespace internal
 
 namespace integer_storage {
@@ -425,6 +1482,9 @@ inline void store(size_t* location, double value) {
 }
 } // namespace double_storage
 
+class array_range;
+class object_range;
+
 /// Represents a JSON value.  First, call get_type() to check its type,
 /// which determines which methods are available.
 ///
@@ -435,6 +1495,7 @@ class value {
 public:
     value()
         : value_tag{ tag::null }
+        , has_ranges{ false }
         , payload{ nullptr }
         , text{ nullptr } {}
 
@@ -488,6 +1549,18 @@ public:
         return payload[0];
     }
 
+    /// Returns a range over the elements of an array, for use in range-based
+    /// for loops.  Iterating walks the AST directly, so it is cheaper than
+    /// calling get_array_element() for each index.
+    /// Only legal if get_type() is TYPE_ARRAY.
+    array_range elements() const;
+
+    /// Returns a range over the (key, value) pairs of an object, in the
+    /// order sajson stores them: sorted by key unless
+    /// SAJSON_UNSORTED_OBJECT_KEYS is defined.
+    /// Only legal if get_type() is TYPE_OBJECT.
+    object_range members() const;
+
     /// Returns the nth element of an array.  Calling with an out-of-bound
     /// index is undefined behavior.
     /// Only legal if get_type() is TYPE_ARRAY.
@@ -498,7 +1571,8 @@ public:
         return value(
             get_element_tag(element),
             payload + get_element_value(element),
-            text);
+            text,
+            has_ranges);
     }
 
     /// Returns the nth key of an object.  Calling with an out-of-bound
@@ -519,7 +1593,8 @@ public:
         return value(
             get_element_tag(element),
             payload + get_element_value(element),
-            text);
+            text,
+            has_ranges);
     }
 
     /// Given a string key, returns the value with that key or a null value
@@ -531,7 +1606,7 @@ public:
         if (i < get_length()) {
             return get_object_value(i);
         } else {
-            return value(tag::null, 0, 0);
+            return value(tag::null, 0, 0, false);
         }
     }
 
@@ -558,6 +1633,68 @@ public:
         return get_length();
     }
 
+    /// Looks up n keys at once, writing the value of sorted_keys[i], or a
+    /// null value if the key is not found, to out[i].  The keys must be
+    /// sorted the way sajson sorts object keys: shorter keys first, and
+    /// keys of equal length by memcmp.
+    /// Because the object's keys are sorted the same way, this is a single
+    /// galloping merge over them, which is cheaper than n calls to
+    /// get_value_of_key() when the keys cover much of the object.
+    /// Only legal if get_type() is TYPE_OBJECT.
+    void
+    get_values_of_keys(const string* sorted_keys, size_t n, value* out) const {
+        using namespace internal;
+        assert_tag(tag::object);
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+        for (size_t k = 0; k < n; ++k) {
+            out[k] = get_value_of_key(sorted_keys[k]);
+        }
+#else
+        const object_key_record* const start
+            = reinterpret_cast<const object_key_record*>(payload + 1);
+        const object_key_record* const end = start + get_length();
+        const object_key_record* cursor = start;
+        for (size_t k = 0; k < n; ++k) {
+            const string& key = sorted_keys[k];
+            out[k] = value(tag::null, 0, 0, false);
+            // Dense lookups usually find the key right at the cursor.
+            int c = cursor == end ? 1 : compare_key(*cursor, key);
+            if (c == 0) {
+                out[k] = get_object_value(cursor - start);
+                continue;
+            } else if (c > 0) {
+                continue;
+            }
+            ++cursor;
+
+            // Gallop forward until overshooting the key, then binary
+            // search the last step.
+            size_t step = 1;
+            while (static_cast<size_t>(end - cursor) > step
+                   && compare_key(cursor[step - 1], key) < 0) {
+                cursor += step;
+                step *= 2;
+            }
+            const object_key_record* high
+                = static_cast<size_t>(end - cursor) > step ? cursor + step
+                                                           : end;
+            while (cursor < high) {
+                const object_key_record* middle = cursor + (high - cursor) / 2;
+                c = compare_key(*middle, key);
+                if (c < 0) {
+                    cursor = middle + 1;
+                } else if (c > 0) {
+                    high = middle;
+                } else {
+                    cursor = middle;
+                    out[k] = get_object_value(cursor - start);
+                    break;
+                }
+            }
+        }
+#endif
+    }
+
     /// If a numeric value was parsed as a 32-bit integer, returns it.
     /// Only legal if get_type() is TYPE_INTEGER.
     int get_integer_value() const {
@@ -645,15 +1782,69 @@ public:
     }
 #endif
 
+    /// Returns true if the two values have the same content, possibly from
+    /// different documents.  Numbers compare by value, so 1 equals 1.0,
+    /// strings compare their unescaped bytes, and objects compare members
+    /// regardless of the order they were written in.
+    bool equals(const value& other) const;
+
+    /// Returns a 64-bit hash of the value's content, computed by walking
+    /// the AST without serializing.  Values that equals() considers equal
+    /// hash alike.  The definition is stable across platforms, builds, and
+    /// allocation modes, so hashes may be stored:
+    ///
+    /// - null, false, and true hash to fixed constants.
+    /// - Numbers hash the bits of their value as a double, with -0 as 0.
+    /// - Strings hash their unescaped UTF-8 bytes with a multiply-fold hash
+    ///   that reads sixteen bytes at a time.
+    /// - Arrays fold their elements' hashes in order.
+    /// - Objects sum a hash of each key and value pair, so member order
+    ///   does not matter.
+    uint64_t hash() const;
+
+    /// Returns true if the value's document was parsed by
+    /// \ref parse_with_source_ranges, so get_source_start() and
+    /// get_source_end() are available.
+    bool has_source_range() const { return has_ranges; }
+
+    /// Returns the offset of the value's first byte in the input text: its
+    /// opening bracket or quote, or the first character of a number or
+    /// literal.
+    /// Only legal if has_source_range().
+    size_t get_source_start() const {
+        assert(has_ranges);
+        return payload[-2];
+    }
+
+    /// Returns the offset one past the value's last byte in the input text,
+    /// so [get_source_start(), get_source_end()) spans the value as it was
+    /// written, including brackets and a string's quotes and escapes.
+    /// Parsing unescapes strings in place, so slice a copy of the input
+    /// that parsing did not modify.
+    /// Only legal if has_source_range().
+    size_t get_source_end() const {
+        assert(has_ranges);
+        return payload[-1];
+    }
+
     /// \cond INTERNAL
     const size_t* _internal_get_payload() const { return payload; }
+
+    // WARNING: Internal function exposed only for high-performance
+    // traversal, such as \ref visit.
+    internal::tag _internal_get_tag() const { return value_tag; }
     /// \endcond
 
 private:
     using tag = internal::tag;
 
-    explicit value(tag value_tag_, const size_t* payload_, const char* text_)
+    explicit value(
+        tag value_tag_,
+        const size_t* payload_,
+        const char* text_,
+        bool has_ranges_)
         : value_tag(value_tag_)
+        , has_ranges(has_ranges_)
         , payload(payload_)
         , text(text_) {}
 
@@ -665,13 +1856,415 @@ private:
 
     void assert_in_bounds(size_t i) const { assert(i < get_length()); }
 
-    const tag value_tag;
-    const size_t* const payload;
-    const char* const text;
+    // Orders keys like object_key_comparator, returning <0, 0, or >0.
+    int compare_key(
+        const internal::object_key_record& record, const string& key) const {
+        return internal::compare_keys(
+            string(text + record.key_start, record.key_end - record.key_start),
+            key);
+    }
+
+    tag value_tag;
+    // Whether each value's source range sits in the two words below its
+    // payload.
+    bool has_ranges;
+    const size_t* payload;
+    const char* text;
 
     friend class document;
+    friend class array_range;
+    friend class object_range;
 };
 
+/// A range over the elements of an array.  See value::elements().
+///
+/// Like \ref value, a range does not maintain any backing memory and must
+/// not outlive its \ref document.
+class array_range {
+public:
+    class iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef sajson::value value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const value* pointer;
+        typedef value reference;
+
+        value operator*() const {
+            using namespace internal;
+            const size_t element = *cursor;
+            return value(
+                get_element_tag(element),
+                payload + get_element_value(element),
+                text,
+                has_ranges);
+        }
+
+        iterator& operator++() {
+            ++cursor;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator rv = *this;
+            ++cursor;
+            return rv;
+        }
+
+        bool operator==(const iterator& that) const {
+            return cursor == that.cursor;
+        }
+
+        bool operator!=(const iterator& that) const {
+            return cursor != that.cursor;
+        }
+
+    private:
+        iterator(
+            const size_t* cursor_,
+            const size_t* payload_,
+            const char* text_,
+            bool has_ranges_)
+            : cursor(cursor_)
+            , payload(payload_)
+            , text(text_)
+            , has_ranges(has_ranges_) {}
+
+        const size_t* cursor;
+        const size_t* payload;
+        const char* text;
+        bool has_ranges;
+
+        friend class array_range;
+    };
+
+    iterator begin() const {
+        return iterator(payload + 1, payload, text, has_ranges);
+    }
+
+    iterator end() const {
+        return iterator(payload + 1 + payload[0], payload, text, has_ranges);
+    }
+
+    /// Returns the number of elements in the array.
+    size_t size() const { return payload[0]; }
+
+private:
+    array_range(const size_t* payload_, const char* text_, bool has_ranges_)
+        : payload(payload_)
+        , text(text_)
+        , has_ranges(has_ranges_) {}
+
+    const size_t* payload;
+    const char* text;
+    bool has_ranges;
+
+    friend class value;
+};
+
+/// A range over the members of an object.  See value::members().
+///
+/// Like \ref value, a range does not maintain any backing memory and must
+/// not outlive its \ref document.
+class object_range {
+public:
+    class iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::pair<string, sajson::value> value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef value_type reference;
+
+        /// Returns the member's key and value.
+        value_type operator*() const {
+            return value_type(get_key(), get_value());
+        }
+
+        string get_key() const {
+            return string(text + cursor[0], cursor[1] - cursor[0]);
+        }
+
+        sajson::value get_value() const {
+            using namespace internal;
+            const size_t element = cursor[2];
+            return sajson::value(
+                get_element_tag(element),
+                payload + get_element_value(element),
+                text,
+                has_ranges);
+        }
+
+        iterator& operator++() {
+            cursor += 3;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator rv = *this;
+            cursor += 3;
+            return rv;
+        }
+
+        bool operator==(const iterator& that) const {
+            return cursor == that.cursor;
+        }
+
+        bool operator!=(const iterator& that) const {
+            return cursor != that.cursor;
+        }
+
+    private:
+        iterator(
+            const size_t* cursor_,
+            const size_t* payload_,
+            const char* text_,
+            bool has_ranges_)
+            : cursor(cursor_)
+            , payload(payload_)
+            , text(text_)
+            , has_ranges(has_ranges_) {}
+
+        const size_t* cursor;
+        const size_t* payload;
+        const char* text;
+        bool has_ranges;
+
+        friend class object_range;
+    };
+
+    iterator begin() const {
+        return iterator(payload + 1, payload, text, has_ranges);
+    }
+
+    iterator end() const {
+        return iterator(
+            payload + 1 + payload[0] * 3, payload, text, has_ranges);
+    }
+
+    /// Returns the number of members in the object.
+    size_t size() const { return payload[0]; }
+
+private:
+    object_range(const size_t* payload_, const char* text_, bool has_ranges_)
+        : payload(payload_)
+        , text(text_)
+        , has_ranges(has_ranges_) {}
+
+    const size_t* payload;
+    const char* text;
+    bool has_ranges;
+
+    friend class value;
+};
+
+inline array_range value::elements() const {
+    assert_tag(tag::array);
+    return array_range(payload, text, has_ranges);
+}
+
+inline object_range value::members() const {
+    assert_tag(tag::object);
+    return object_range(payload, text, has_ranges);
+}
+
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+namespace internal {
+// An unsorted object's member indices, stably sorted by key.  Members with
+// duplicate keys keep the order they were written in, so walking two of
+// these side by side pairs the members of two objects as multisets.
+class members_by_key {
+public:
+    explicit members_by_key(const value& object)
+        : indices(new size_t[object.get_length()]) {
+        const size_t length = object.get_length();
+        for (size_t i = 0; i < length; ++i) {
+            indices[i] = i;
+        }
+        std::stable_sort(
+            indices, indices + length, [&object](size_t a, size_t b) {
+                return compare_keys(
+                           object.get_object_key(a), object.get_object_key(b))
+                    < 0;
+            });
+    }
+
+    ~members_by_key() { delete[] indices; }
+
+    members_by_key(const members_by_key&) = delete;
+    void operator=(const members_by_key&) = delete;
+
+    // Returns the index of the nth member in key order.
+    size_t operator[](size_t n) const { return indices[n]; }
+
+private:
+    size_t* const indices;
+};
+} // namespace internal
+#endif
+
+inline bool value::equals(const value& other) const {
+    using namespace internal;
+    const bool is_number
+        = value_tag == tag::integer || value_tag == tag::double_;
+    const bool other_is_number
+        = other.value_tag == tag::integer || other.value_tag == tag::double_;
+    if (is_number || other_is_number) {
+        return is_number && other_is_number
+            && get_number_value() == other.get_number_value();
+    }
+    if (value_tag != other.value_tag) {
+        return false;
+    }
+    switch (value_tag) {
+    case tag::string:
+        return get_string_length() == other.get_string_length()
+            && memcmp(as_cstring(), other.as_cstring(), get_string_length())
+            == 0;
+    case tag::array: {
+        const size_t length = get_length();
+        if (length != other.get_length()) {
+            return false;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            if (!get_array_element(i).equals(other.get_array_element(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    case tag::object: {
+        const size_t length = get_length();
+        if (length != other.get_length()) {
+            return false;
+        }
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+        const members_by_key order(*this);
+        const members_by_key other_order(other);
+#endif
+        for (size_t k = 0; k < length; ++k) {
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+            const size_t i = order[k];
+            const size_t j = other_order[k];
+#else
+            // Both objects' keys are sorted, so members pair up by index.
+            const size_t i = k;
+            const size_t j = k;
+#endif
+            if (compare_keys(get_object_key(i), other.get_object_key(j))
+                != 0) {
+                return false;
+            }
+            if (!get_object_value(i).equals(other.get_object_value(j))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+inline uint64_t value::hash() const {
+    using namespace internal;
+    // Each type's seed keeps, say, [] and {} or "" apart.
+    enum {
+        null_seed = 1,
+        false_seed,
+        true_seed,
+        number_seed,
+        string_seed,
+        array_seed,
+        object_seed,
+    };
+    switch (value_tag) {
+    case tag::null:
+        return hash_mix(hash_k0 ^ null_seed, hash_k1);
+    case tag::false_:
+        return hash_mix(hash_k0 ^ false_seed, hash_k1);
+    case tag::true_:
+        return hash_mix(hash_k0 ^ true_seed, hash_k1);
+    case tag::integer:
+    case tag::double_: {
+        double d = get_number_value();
+        if (d == 0) {
+            d = 0; // -0
+        }
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        return hash_mix(hash_k0 ^ bits, hash_k1 ^ number_seed);
+    }
+    case tag::string:
+        return hash_bytes(as_cstring(), get_string_length(), string_seed);
+    case tag::array: {
+        uint64_t h = hash_mix(hash_k0 ^ array_seed, hash_k1 ^ get_length());
+        for (const value& element : elements()) {
+            h = hash_mix(h ^ hash_k2, element.hash() ^ hash_k3);
+        }
+        return h;
+    }
+    case tag::object: {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < get_length(); ++i) {
+            const string key = get_object_key(i);
+            sum += hash_mix(
+                hash_bytes(key.data(), key.length(), object_seed) ^ hash_k2,
+                get_object_value(i).hash() ^ hash_k3);
+        }
+        return hash_mix(hash_k0 ^ object_seed ^ sum, hash_k1 ^ get_length());
+    }
+    }
+    SAJSON_UNREACHABLE();
+}
+
+/**
+ * Calls the visitor method matching the value's type, passing the value's
+ * contents already decoded:
+ *
+ *     struct visitor {
+ *         R visit_null();
+ *         R visit_boolean(bool b);
+ *         R visit_integer(int i);
+ *         R visit_double(double d);
+ *         R visit_string(const sajson::string& s);
+ *         R visit_array(const sajson::array_range& elements);
+ *         R visit_object(const sajson::object_range& members);
+ *     };
+ *
+ * All methods must return the same type R, which visit() returns.  To walk a
+ * whole document, the array and object methods call visit() on their
+ * children.
+ *
+ * Unlike switching on get_type(), which first maps the internal tag onto
+ * \ref type, visit() switches on the AST tag directly.
+ */
+template <typename Visitor>
+auto visit(const value& v, Visitor&& visitor)
+    -> decltype(visitor.visit_null()) {
+    using namespace internal;
+    switch (v._internal_get_tag()) {
+    case tag::integer:
+        return visitor.visit_integer(v.get_integer_value());
+    case tag::double_:
+        return visitor.visit_double(v.get_double_value());
+    case tag::null:
+        return visitor.visit_null();
+    case tag::false_:
+        return visitor.visit_boolean(false);
+    case tag::true_:
+        return visitor.visit_boolean(true);
+    case tag::string:
+        return visitor.visit_string(
+            string(v.as_cstring(), v.get_string_length()));
+    case tag::array:
+        return visitor.visit_array(v.elements());
+    case tag::object:
+        return visitor.visit_object(v.members());
+    }
+    SAJSON_UNREACHABLE();
+}
+
 /// Error code indicating why parse failed.
 enum error {
     ERROR_NO_ERROR,
@@ -698,6 +2291,9 @@ enum error {
     ERROR_UNKNOWN_ESCAPE,
     ERROR_INVALID_UTF8,
     ERROR_UNINITIALIZED,
+    ERROR_DECOMPRESSION_FAILED,
+    ERROR_INVALID_BINARY,
+    ERROR_READ_FAILED,
 };
 
 namespace internal {
@@ -773,6 +2369,12 @@ inline const char* get_error_text(error error_code) {
         return "invalid UTF-8";
     case ERROR_UNINITIALIZED:
         return "uninitialized document";
+    case ERROR_DECOMPRESSION_FAILED:
+        return "failed to decompress input";
+    case ERROR_INVALID_BINARY:
+        return "invalid or unsupported binary item";
+    case ERROR_READ_FAILED:
+        return "failed to read input file";
     }
 
     SAJSON_UNREACHABLE();
@@ -798,6 +2400,7 @@ public:
         , structure(std::move(rhs.structure))
         , root_tag(rhs.root_tag)
         , root(rhs.root)
+        , has_ranges(rhs.has_ranges)
         , error_line(rhs.error_line)
         , error_column(rhs.error_column)
         , error_code(rhs.error_code)
@@ -819,7 +2422,14 @@ public:
     }
 
     /// If is_valid(), returns the document's root \ref value.
-    value get_root() const { return value(root_tag, root, input.get_data()); }
+    value get_root() const {
+        return value(root_tag, root, input.get_data(), has_ranges);
+    }
+
+    /// Returns true if the document was parsed by
+    /// \ref parse_with_source_ranges, so every value records where it
+    /// appeared in the input.  See value::get_source_start().
+    bool has_source_ranges() const { return has_ranges; }
 
     /// If not is_valid(), returns the one-based line number where the parse
     /// failed.
@@ -868,6 +2478,26 @@ public:
     // bindings.
     const mutable_string_view& _internal_get_input() const { return input; }
 
+    // WARNING: Internal function exposed for companion headers that can fail
+    // before the parse begins or that decode input other than JSON text.
+    static document _internal_make_error(
+        const mutable_string_view& input,
+        error error_code,
+        size_t error_line = 0,
+        size_t error_column = 0) {
+        return document(input, error_line, error_column, error_code, 0);
+    }
+
+    // WARNING: Internal function exposed for companion headers that build
+    // an AST themselves.  String payloads index input's data.
+    static document _internal_make_document(
+        const mutable_string_view& input,
+        internal::ownership&& structure,
+        internal::tag root_tag,
+        const size_t* root) {
+        return document(input, std::move(structure), root_tag, root, false);
+    }
+
     /// \endcond
 
 private:
@@ -880,11 +2510,13 @@ private:
         const mutable_string_view& input_,
         internal::ownership&& structure_,
         tag root_tag_,
-        const size_t* root_)
+        const size_t* root_,
+        bool has_ranges_)
         : input(input_)
         , structure(std::move(structure_))
         , root_tag(root_tag_)
         , root(root_)
+        , has_ranges(has_ranges_)
         , error_line(0)
         , error_column(0)
         , error_code(ERROR_NO_ERROR)
@@ -902,6 +2534,7 @@ private:
         , structure(0)
         , root_tag(tag::null)
         , root(0)
+        , has_ranges(false)
         , error_line(error_line_)
         , error_column(error_column_)
         , error_code(error_code_)
@@ -931,6 +2564,7 @@ private:
     internal::ownership structure;
     const tag root_tag;
     const size_t* const root;
+    const bool has_ranges;
     const size_t error_line;
     const size_t error_column;
     const error error_code;
@@ -942,7 +2576,10 @@ private:
     template <typename AllocationStrategy, typename StringType>
     friend document
     parse(const AllocationStrategy& strategy, const StringType& string);
-    template <typename Allocator>
+    template <typename AllocationStrategy, typename StringType>
+    friend document parse_with_source_ranges(
+        const AllocationStrategy& strategy, const StringType& string);
+    template <typename Allocator, bool SourceRanges>
     friend class parser;
 };
 
@@ -1101,6 +2738,8 @@ public:
 
     /// \cond INTERNAL
 
+    bool _internal_has_existing_buffer() const { return has_existing_buffer; }
+
     allocator
     make_allocator(size_t input_document_size_in_bytes, bool* succeeded) const {
         if (has_existing_buffer) {
@@ -1539,10 +3178,83 @@ private:
     size_t existing_buffer_size;
 };
 
+namespace internal {
+// Moves an array's element words from the parse stack into the AST, making
+// their offsets relative to the array's payload.  The AST may overlap the
+// stack's top, so the copy runs back to front.
+template <typename Allocator>
+bool install_array(
+    Allocator& allocator, size_t* array_base, size_t* array_end) {
+    const size_t length = array_end - array_base;
+    bool success;
+    size_t* const new_base = allocator.reserve(length + 1, &success);
+    if (SAJSON_UNLIKELY(!success)) {
+        return false;
+    }
+    size_t* out = new_base + length + 1;
+    size_t* const structure_end = allocator.get_write_pointer_of(0);
+
+    while (array_end > array_base) {
+        size_t element = *--array_end;
+        tag element_type = get_element_tag(element);
+        size_t element_value = get_element_value(element);
+        size_t* element_ptr = structure_end - element_value;
+        *--out = make_element(element_type, element_ptr - new_base);
+    }
+    *--out = length;
+    return true;
+}
+
+// Like install_array, for an object's (key start, key end, element)
+// records, which are sorted first unless SAJSON_UNSORTED_OBJECT_KEYS.
+// Key offsets index text.
+template <typename Allocator>
+bool install_object(
+    Allocator& allocator,
+    const char* text,
+    size_t* object_base,
+    size_t* object_end) {
+    assert((object_end - object_base) % 3 == 0);
+    const size_t length_times_3 = object_end - object_base;
+#ifndef SAJSON_UNSORTED_OBJECT_KEYS
+    std::sort(
+        reinterpret_cast<object_key_record*>(object_base),
+        reinterpret_cast<object_key_record*>(object_end),
+        object_key_comparator(text));
+#else
+    (void)text;
+#endif
+
+    bool success;
+    size_t* const new_base = allocator.reserve(length_times_3 + 1, &success);
+    if (SAJSON_UNLIKELY(!success)) {
+        return false;
+    }
+    size_t* out = new_base + length_times_3 + 1;
+    size_t* const structure_end = allocator.get_write_pointer_of(0);
+
+    while (object_end > object_base) {
+        size_t element = *--object_end;
+        tag element_type = get_element_tag(element);
+        size_t element_value = get_element_value(element);
+        size_t* element_ptr = structure_end - element_value;
+
+        *--out = make_element(element_type, element_ptr - new_base);
+        *--out = *--object_end;
+        *--out = *--object_end;
+    }
+    *--out = length_times_3 / 3;
+    return true;
+}
+} // namespace internal
+
 // I thought about putting parser in the internal namespace but I don't
 // want to indent it further...
 /// \cond INTERNAL
-template <typename Allocator>
+// With SourceRanges, each value's [start, end) input offsets are stored in
+// the two AST words below its payload, and each open array or object keeps
+// its start offset on the stack after its parent's marker.
+template <typename Allocator, bool SourceRanges = false>
 class parser {
 public:
     parser(const mutable_string_view& msv, Allocator&& allocator_)
@@ -1555,9 +3267,15 @@ public:
 
     document get_document() {
         if (parse()) {
-            size_t* ast_root = allocator.get_ast_root();
+            // The root's range is the last thing written.
+            size_t* ast_root
+                = allocator.get_ast_root() + (SourceRanges ? 2 : 0);
             return document(
-                input, allocator.transfer_ownership(), root_tag, ast_root);
+                input,
+                allocator.transfer_ownership(),
+                root_tag,
+                ast_root,
+                SourceRanges);
         } else {
             return document(
                 input, error_line, error_column, error_code, error_arg);
@@ -1570,6 +3288,10 @@ private:
         operator char*() const { return 0; }
     };
 
+    // Words at the base of an open structure's stack frame: the parent's
+    // marker, then the start offset if SourceRanges.
+    static const size_t frame_header = SourceRanges ? 2 : 1;
+
     bool at_eof(const char* p) { return p == input_end; }
 
     char* skip_whitespace(char* p) {
@@ -1659,7 +3381,7 @@ private:
             current_structure_tag = tag::array;
             bool s
                 = stack.push(make_element(current_structure_tag, ROOT_MARKER));
-            if (SAJSON_UNLIKELY(!s)) {
+            if (SAJSON_UNLIKELY(!s || !push_start(stack, p))) {
                 return oom(p);
             }
             goto array_close_or_element;
@@ -1667,7 +3389,7 @@ private:
             current_structure_tag = tag::object;
             bool s
                 = stack.push(make_element(current_structure_tag, ROOT_MARKER));
-            if (SAJSON_UNLIKELY(!s)) {
+            if (SAJSON_UNLIKELY(!s || !push_start(stack, p))) {
                 return oom(p);
             }
             goto object_close_or_element;
@@ -1678,6 +3400,7 @@ private:
         // BEGIN STATE MACHINE
 
         size_t pop_element; // used as an argument into the `pop` routine
+        size_t value_start; // input offset of the value, if SourceRanges
 
         if (0) { // purely for structure
 
@@ -1743,8 +3466,14 @@ private:
             ++p;
             size_t* base_ptr = stack.get_pointer_from_offset(current_base);
             pop_element = *base_ptr;
-            if (SAJSON_UNLIKELY(
-                    !install_object(base_ptr + 1, stack.get_top()))) {
+            if (SourceRanges) {
+                value_start = base_ptr[1];
+            }
+            if (SAJSON_UNLIKELY(!install_object(
+                    allocator,
+                    input.get_data(),
+                    base_ptr + frame_header,
+                    stack.get_top()))) {
                 return oom(p);
             }
             goto pop;
@@ -1755,8 +3484,11 @@ private:
             ++p;
             size_t* base_ptr = stack.get_pointer_from_offset(current_base);
             pop_element = *base_ptr;
-            if (SAJSON_UNLIKELY(
-                    !install_array(base_ptr + 1, stack.get_top()))) {
+            if (SourceRanges) {
+                value_start = base_ptr[1];
+            }
+            if (SAJSON_UNLIKELY(!install_array(
+                    allocator, base_ptr + frame_header, stack.get_top()))) {
                 return oom(p);
             }
             goto pop;
@@ -1796,6 +3528,7 @@ private:
             }
 
             tag value_tag_result;
+            value_start = p - input.get_data();
             switch (*p) {
             case 0:
                 return unexpected_end(p);
@@ -1858,7 +3591,7 @@ private:
                 current_base = stack.get_size();
                 bool s = stack.push(
                     make_element(current_structure_tag, previous_base));
-                if (SAJSON_UNLIKELY(!s)) {
+                if (SAJSON_UNLIKELY(!s || !push_start(stack, p))) {
                     return oom(p);
                 }
                 current_structure_tag = tag::array;
@@ -1869,7 +3602,7 @@ private:
                 current_base = stack.get_size();
                 bool s = stack.push(
                     make_element(current_structure_tag, previous_base));
-                if (SAJSON_UNLIKELY(!s)) {
+                if (SAJSON_UNLIKELY(!s || !push_start(stack, p))) {
                     return oom(p);
                 }
                 current_structure_tag = tag::object;
@@ -1879,6 +3612,10 @@ private:
                 size_t parent = get_element_value(pop_element);
                 if (parent == ROOT_MARKER) {
                     root_tag = current_structure_tag;
+                    if (SourceRanges
+                        && SAJSON_UNLIKELY(!install_range(value_start, p))) {
+                        return oom(p);
+                    }
                     p = skip_whitespace(p);
                     if (SAJSON_UNLIKELY(p)) {
                         return make_error(p, ERROR_EXPECTED_END_OF_INPUT);
@@ -1898,8 +3635,13 @@ private:
                 return make_error(p, ERROR_EXPECTED_VALUE);
             }
 
-            bool s = stack.push(
-                make_element(value_tag_result, allocator.get_write_offset()));
+            // The element points at the payload; the range goes below it.
+            const size_t element_offset = allocator.get_write_offset();
+            if (SourceRanges
+                && SAJSON_UNLIKELY(!install_range(value_start, p))) {
+                return oom(p);
+            }
+            bool s = stack.push(make_element(value_tag_result, element_offset));
             if (SAJSON_UNLIKELY(!s)) {
                 return oom(p);
             }
@@ -1910,6 +3652,24 @@ private:
         SAJSON_UNREACHABLE();
     }
 
+    // If SourceRanges, pushes the offset of the bracket at p.
+    template <typename Stack>
+    bool push_start(Stack& stack, const char* p) {
+        return !SourceRanges || stack.push(p - input.get_data());
+    }
+
+    // Writes [start, end) to two words below the value just installed.
+    bool install_range(size_t start, const char* end) {
+        bool success;
+        size_t* range = allocator.reserve(2, &success);
+        if (SAJSON_UNLIKELY(!success)) {
+            return false;
+        }
+        range[0] = start;
+        range[1] = end - input.get_data();
+        return true;
+    }
+
     bool has_remaining_characters(char* p, ptrdiff_t remaining) {
         return input_end - p >= remaining;
     }
@@ -1956,76 +3716,6 @@ private:
         return p + 4;
     }
 
-    static double pow10(int64_t exponent) {
-        if (SAJSON_UNLIKELY(exponent > 308)) {
-            return std::numeric_limits<double>::infinity();
-        } else if (SAJSON_UNLIKELY(exponent < -323)) {
-            return 0.0;
-        }
-
-        // clang-format off
-        static const double constants[] = {
-            1e-323,1e-322,1e-321,1e-320,1e-319,1e-318,1e-317,1e-316,1e-315,1e-314,
-            1e-313,1e-312,1e-311,1e-310,1e-309,1e-308,1e-307,1e-306,1e-305,1e-304,
-            1e-303,1e-302,1e-301,1e-300,1e-299,1e-298,1e-297,1e-296,1e-295,1e-294,
-            1e-293,1e-292,1e-291,1e-290,1e-289,1e-288,1e-287,1e-286,1e-285,1e-284,
-            1e-283,1e-282,1e-281,1e-280,1e-279,1e-278,1e-277,1e-276,1e-275,1e-274,
-            1e-273,1e-272,1e-271,1e-270,1e-269,1e-268,1e-267,1e-266,1e-265,1e-264,
-            1e-263,1e-262,1e-261,1e-260,1e-259,1e-258,1e-257,1e-256,1e-255,1e-254,
-            1e-253,1e-252,1e-251,1e-250,1e-249,1e-248,1e-247,1e-246,1e-245,1e-244,
-            1e-243,1e-242,1e-241,1e-240,1e-239,1e-238,1e-237,1e-236,1e-235,1e-234,
-            1e-233,1e-232,1e-231,1e-230,1e-229,1e-228,1e-227,1e-226,1e-225,1e-224,
-            1e-223,1e-222,1e-221,1e-220,1e-219,1e-218,1e-217,1e-216,1e-215,1e-214,
-            1e-213,1e-212,1e-211,1e-210,1e-209,1e-208,1e-207,1e-206,1e-205,1e-204,
-            1e-203,1e-202,1e-201,1e-200,1e-199,1e-198,1e-197,1e-196,1e-195,1e-194,
-            1e-193,1e-192,1e-191,1e-190,1e-189,1e-188,1e-187,1e-186,1e-185,1e-184,
-            1e-183,1e-182,1e-181,1e-180,1e-179,1e-178,1e-177,1e-176,1e-175,1e-174,
-            1e-173,1e-172,1e-171,1e-170,1e-169,1e-168,1e-167,1e-166,1e-165,1e-164,
-            1e-163,1e-162,1e-161,1e-160,1e-159,1e-158,1e-157,1e-156,1e-155,1e-154,
-            1e-153,1e-152,1e-151,1e-150,1e-149,1e-148,1e-147,1e-146,1e-145,1e-144,
-            1e-143,1e-142,1e-141,1e-140,1e-139,1e-138,1e-137,1e-136,1e-135,1e-134,
-            1e-133,1e-132,1e-131,1e-130,1e-129,1e-128,1e-127,1e-126,1e-125,1e-124,
-            1e-123,1e-122,1e-121,1e-120,1e-119,1e-118,1e-117,1e-116,1e-115,1e-114,
-            1e-113,1e-112,1e-111,1e-110,1e-109,1e-108,1e-107,1e-106,1e-105,1e-104,
-            1e-103,1e-102,1e-101,1e-100,1e-99,1e-98,1e-97,1e-96,1e-95,1e-94,1e-93,
-            1e-92,1e-91,1e-90,1e-89,1e-88,1e-87,1e-86,1e-85,1e-84,1e-83,1e-82,1e-81,
-            1e-80,1e-79,1e-78,1e-77,1e-76,1e-75,1e-74,1e-73,1e-72,1e-71,1e-70,1e-69,
-            1e-68,1e-67,1e-66,1e-65,1e-64,1e-63,1e-62,1e-61,1e-60,1e-59,1e-58,1e-57,
-            1e-56,1e-55,1e-54,1e-53,1e-52,1e-51,1e-50,1e-49,1e-48,1e-47,1e-46,1e-45,
-            1e-44,1e-43,1e-42,1e-41,1e-40,1e-39,1e-38,1e-37,1e-36,1e-35,1e-34,1e-33,
-            1e-32,1e-31,1e-30,1e-29,1e-28,1e-27,1e-26,1e-25,1e-24,1e-23,1e-22,1e-21,
-            1e-20,1e-19,1e-18,1e-17,1e-16,1e-15,1e-14,1e-13,1e-12,1e-11,1e-10,1e-9,
-            1e-8,1e-7,1e-6,1e-5,1e-4,1e-3,1e-2,1e-1,1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,
-            1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,
-            1e22,1e23,1e24,1e25,1e26,1e27,1e28,1e29,1e30,1e31,1e32,1e33,1e34,1e35,
-            1e36,1e37,1e38,1e39,1e40,1e41,1e42,1e43,1e44,1e45,1e46,1e47,1e48,1e49,
-            1e50,1e51,1e52,1e53,1e54,1e55,1e56,1e57,1e58,1e59,1e60,1e61,1e62,1e63,
-            1e64,1e65,1e66,1e67,1e68,1e69,1e70,1e71,1e72,1e73,1e74,1e75,1e76,1e77,
-            1e78,1e79,1e80,1e81,1e82,1e83,1e84,1e85,1e86,1e87,1e88,1e89,1e90,1e91,
-            1e92,1e93,1e94,1e95,1e96,1e97,1e98,1e99,1e100,1e101,1e102,1e103,1e104,
-            1e105,1e106,1e107,1e108,1e109,1e110,1e111,1e112,1e113,1e114,1e115,1e116,
-            1e117,1e118,1e119,1e120,1e121,1e122,1e123,1e124,1e125,1e126,1e127,1e128,
-            1e129,1e130,1e131,1e132,1e133,1e134,1e135,1e136,1e137,1e138,1e139,1e140,
-            1e141,1e142,1e143,1e144,1e145,1e146,1e147,1e148,1e149,1e150,1e151,1e152,
-            1e153,1e154,1e155,1e156,1e157,1e158,1e159,1e160,1e161,1e162,1e163,1e164,
-            1e165,1e166,1e167,1e168,1e169,1e170,1e171,1e172,1e173,1e174,1e175,1e176,
-            1e177,1e178,1e179,1e180,1e181,1e182,1e183,1e184,1e185,1e186,1e187,1e188,
-            1e189,1e190,1e191,1e192,1e193,1e194,1e195,1e196,1e197,1e198,1e199,1e200,
-            1e201,1e202,1e203,1e204,1e205,1e206,1e207,1e208,1e209,1e210,1e211,1e212,
-            1e213,1e214,1e215,1e216,1e217,1e218,1e219,1e220,1e221,1e222,1e223,1e224,
-            1e225,1e226,1e227,1e228,1e229,1e230,1e231,1e232,1e233,1e234,1e235,1e236,
-            1e237,1e238,1e239,1e240,1e241,1e242,1e243,1e244,1e245,1e246,1e247,1e248,
-            1e249,1e250,1e251,1e252,1e253,1e254,1e255,1e256,1e257,1e258,1e259,1e260,
-            1e261,1e262,1e263,1e264,1e265,1e266,1e267,1e268,1e269,1e270,1e271,1e272,
-            1e273,1e274,1e275,1e276,1e277,1e278,1e279,1e280,1e281,1e282,1e283,1e284,
-            1e285,1e286,1e287,1e288,1e289,1e290,1e291,1e292,1e293,1e294,1e295,1e296,
-            1e297,1e298,1e299,1e300,1e301,1e302,1e303,1e304,1e305,1e306,1e307,1e308
-        };
-        // clang-format on
-
-        return constants[exponent + 323];
-    }
-
     std::pair<char*, internal::tag> parse_number(char* p) {
         using internal::tag;
 
@@ -2043,8 +3733,13 @@ private:
         bool try_double = false;
 
         int i = 0;
-        double d = 0.0; // gcc complains that d might be used uninitialized
-                        // which isn't true. appease the warning anyway.
+        // Once the number needs a double, its digits accumulate exactly in
+        // mantissa, scaled by 10^exponent, so the conversion can round
+        // correctly.  Digits past 19 are dropped and noted in truncated.
+        uint64_t mantissa = 0;
+        int64_t exponent = 0;
+        bool truncated = false;
+        const uint64_t mantissa_limit = (UINT64_MAX - 9) / 10;
         if (*p == '0') {
             ++p;
             if (SAJSON_UNLIKELY(at_eof(p))) {
@@ -2070,10 +3765,15 @@ private:
                 if (SAJSON_UNLIKELY(!try_double && i > INT_MAX / 10 - 9)) {
                     // TODO: could split this into two loops
                     try_double = true;
-                    d = i;
+                    mantissa = i;
                 }
                 if (SAJSON_UNLIKELY(try_double)) {
-                    d = 10.0 * d + digit;
+                    if (SAJSON_LIKELY(mantissa <= mantissa_limit)) {
+                        mantissa = 10 * mantissa + digit;
+                    } else {
+                        ++exponent;
+                        truncated = truncated || digit != 0;
+                    }
                 } else {
                     i = 10 * i + digit;
                 }
@@ -2082,12 +3782,10 @@ private:
             } while (c >= '0' && c <= '9');
         }
 
-        int64_t exponent = 0;
-
         if ('.' == *p) {
             if (!try_double) {
                 try_double = true;
-                d = i;
+                mantissa = i;
             }
             ++p;
             if (SAJSON_UNLIKELY(at_eof(p))) {
@@ -2106,15 +3804,19 @@ private:
                     return std::make_pair(
                         make_error(p, ERROR_UNEXPECTED_END), tag::null);
                 }
-                d = d * 10 + (c - '0');
-                // One option to avoid underflow would be to clamp
-                // to INT_MIN, but int64 subtraction is cheap and
-                // in the absurd case of parsing 2 GB of digits
-                // with an extremely high exponent, this will
-                // produce accurate results.  Instead, we just
-                // leave exponent as int64_t and it will never
-                // underflow.
-                --exponent;
+                if (SAJSON_LIKELY(mantissa <= mantissa_limit)) {
+                    mantissa = 10 * mantissa + (c - '0');
+                    // One option to avoid underflow would be to clamp
+                    // to INT_MIN, but int64 subtraction is cheap and
+                    // in the absurd case of parsing 2 GB of digits
+                    // with an extremely high exponent, this will
+                    // produce accurate results.  Instead, we just
+                    // leave exponent as int64_t and it will never
+                    // underflow.
+                    --exponent;
+                } else {
+                    truncated = truncated || c != '0';
+                }
 
                 c = *p;
             } while (c >= '0' && c <= '9');
@@ -2124,7 +3826,7 @@ private:
         if ('e' == e || 'E' == e) {
             if (!try_double) {
                 try_double = true;
-                d = i;
+                mantissa = i;
             }
             ++p;
             if (SAJSON_UNLIKELY(at_eof(p))) {
@@ -2183,12 +3885,21 @@ private:
             exponent += (negativeExponent ? -exp : exp);
         }
 
-        if (exponent) {
-            assert(try_double);
-            // If d is zero but the exponent is huge, don't
-            // multiply zero by inf which gives nan.
-            if (d != 0.0) {
-                d *= pow10(exponent);
+        double d = 0.0;
+        if (try_double) {
+            static const uint64_t exact_limit = 100000000000000000ULL;
+            while (SAJSON_UNLIKELY(mantissa >= exact_limit)
+                   && mantissa % 10 == 0) {
+                mantissa /= 10;
+                ++exponent;
+            }
+            if (SAJSON_LIKELY(!truncated && mantissa < exact_limit)) {
+                d = internal::decimal_to_double(mantissa, exponent);
+            } else {
+                // Too many digits for an exact conversion.  The dropped
+                // digits are far below a double's precision.
+                d = static_cast<double>(mantissa)
+                    * internal::pow10(exponent);
             }
         }
 
@@ -2220,64 +3931,6 @@ private:
         }
     }
 
-    bool install_array(size_t* array_base, size_t* array_end) {
-        using namespace sajson::internal;
-
-        const size_t length = array_end - array_base;
-        bool success;
-        size_t* const new_base = allocator.reserve(length + 1, &success);
-        if (SAJSON_UNLIKELY(!success)) {
-            return false;
-        }
-        size_t* out = new_base + length + 1;
-        size_t* const structure_end = allocator.get_write_pointer_of(0);
-
-        while (array_end > array_base) {
-            size_t element = *--array_end;
-            tag element_type = get_element_tag(element);
-            size_t element_value = get_element_value(element);
-            size_t* element_ptr = structure_end - element_value;
-            *--out = make_element(element_type, element_ptr - new_base);
-        }
-        *--out = length;
-        return true;
-    }
-
-    bool install_object(size_t* object_base, size_t* object_end) {
-        using namespace internal;
-
-        assert((object_end - object_base) % 3 == 0);
-        const size_t length_times_3 = object_end - object_base;
-#ifndef SAJSON_UNSORTED_OBJECT_KEYS
-        std::sort(
-            reinterpret_cast<object_key_record*>(object_base),
-            reinterpret_cast<object_key_record*>(object_end),
-            object_key_comparator(input.get_data()));
-#endif
-
-        bool success;
-        size_t* const new_base
-            = allocator.reserve(length_times_3 + 1, &success);
-        if (SAJSON_UNLIKELY(!success)) {
-            return false;
-        }
-        size_t* out = new_base + length_times_3 + 1;
-        size_t* const structure_end = allocator.get_write_pointer_of(0);
-
-        while (object_end > object_base) {
-            size_t element = *--object_end;
-            tag element_type = get_element_tag(element);
-            size_t element_value = get_element_value(element);
-            size_t* element_ptr = structure_end - element_value;
-
-            *--out = make_element(element_type, element_ptr - new_base);
-            *--out = *--object_end;
-            *--out = *--object_end;
-        }
-        *--out = length_times_3 / 3;
-        return true;
-    }
-
     char* parse_string(char* p, size_t* tag) {
         using namespace internal;
 
@@ -2569,4 +4222,34 @@ document parse(const AllocationStrategy& strategy, const StringType& string) {
                input, std::move(allocator))
         .get_document();
 }
+
+/**
+ * Like \ref parse, but also records where each value appears in the input,
+ * so that value::get_source_start() and value::get_source_end() can slice
+ * subtrees out of the original text without re-serializing them.
+ *
+ * Each value costs two more AST words.  A single_allocation needs
+ * 2 * length + 1 words rather than one per input byte.
+ *
+ * The offsets index the input as it was before parsing.  Since parsing
+ * rewrites strings in place, slice the caller's original text, not the
+ * document's (possibly mutated) copy of it.
+ */
+template <typename AllocationStrategy, typename StringType>
+document parse_with_source_ranges(
+    const AllocationStrategy& strategy, const StringType& string) {
+    mutable_string_view input(string);
+
+    // n bytes hold at most (n + 1) / 2 values, and each adds two range
+    // words to the AST or, while it is open, its start to the stack.
+    bool success;
+    auto allocator = strategy.make_allocator(2 * input.length() + 1, &success);
+    if (!success) {
+        return document(input, 1, 1, ERROR_OUT_OF_MEMORY, 0);
+    }
+
+    return parser<typename AllocationStrategy::allocator, true>(
+               input, std::move(allocator))
+        .get_document();
+}
 } // namespace sajson
@@ -0,0 +1,769 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <string>
+
+/**
+ * MessagePack and CBOR (RFC 8949) encoding and decoding.
+ *
+ * write_msgpack() and write_cbor() encode a value with the shortest header
+ * for each integer, string, array, and map.  parse_msgpack() and
+ * parse_cbor() decode into the same AST that \ref parse builds, through the
+ * same allocation strategies, so the result is read with \ref value exactly
+ * like a parsed JSON document.  Like parse, decoding is in-situ: string
+ * bytes are moved down within the input buffer and NUL-terminated, so
+ * strings cost no allocation beyond the input copy, if any.
+ *
+ * Both formats are decoded into JSON's data model: integers that fit in 32
+ * bits become TYPE_INTEGER, other integers and all floats become
+ * TYPE_DOUBLE, and map keys must be strings.  Byte strings, extension
+ * types, CBOR's undefined and other simple values, and CBOR's
+ * indefinite-length items fail with ERROR_INVALID_BINARY.  CBOR tags are
+ * skipped and the tagged item is decoded.  Doubles are always encoded as
+ * 64-bit floats, so encoding and decoding a document reproduces it exactly.
+ */
+namespace sajson {
+
+namespace internal {
+inline void append_big_endian(std::string& out, uint64_t v, size_t bytes) {
+    char buffer[8];
+    for (size_t i = bytes; i--;) {
+        buffer[i] = static_cast<char>(v & 0xff);
+        v >>= 8;
+    }
+    out.append(buffer, bytes);
+}
+
+inline void append_double(std::string& out, char marker, double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    out += marker;
+    append_big_endian(out, bits, 8);
+}
+
+inline void write_msgpack_integer(int64_t i, std::string& out) {
+    if (i >= 0) {
+        if (i < 0x80) {
+            out += static_cast<char>(i);
+        } else if (i <= 0xff) {
+            out += '\xcc';
+            append_big_endian(out, i, 1);
+        } else if (i <= 0xffff) {
+            out += '\xcd';
+            append_big_endian(out, i, 2);
+        } else if (i <= 0xffffffffLL) {
+            out += '\xce';
+            append_big_endian(out, i, 4);
+        } else {
+            out += '\xcf';
+            append_big_endian(out, i, 8);
+        }
+    } else {
+        const uint64_t bits = static_cast<uint64_t>(i);
+        if (i >= -32) {
+            out += static_cast<char>(bits & 0xff);
+        } else if (i >= INT8_MIN) {
+            out += '\xd0';
+            append_big_endian(out, bits, 1);
+        } else if (i >= INT16_MIN) {
+            out += '\xd1';
+            append_big_endian(out, bits, 2);
+        } else if (i >= INT32_MIN) {
+            out += '\xd2';
+            append_big_endian(out, bits, 4);
+        } else {
+            out += '\xd3';
+            append_big_endian(out, bits, 8);
+        }
+    }
+}
+
+// Writes a str, array, or map header.  fix is the marker of the form that
+// holds lengths below fix_limit in its low bits; wide8 is the marker with a
+// one-byte length, or 0 if there is none; wide16 is the marker with a
+// two-byte length, and the next marker has a four-byte length.
+inline void write_msgpack_header(
+    std::string& out,
+    size_t length,
+    unsigned char fix,
+    size_t fix_limit,
+    unsigned char wide8,
+    unsigned char wide16) {
+    assert(length <= 0xffffffffULL);
+    if (length < fix_limit) {
+        out += static_cast<char>(fix | length);
+    } else if (wide8 && length <= 0xff) {
+        out += static_cast<char>(wide8);
+        append_big_endian(out, length, 1);
+    } else if (length <= 0xffff) {
+        out += static_cast<char>(wide16);
+        append_big_endian(out, length, 2);
+    } else {
+        out += static_cast<char>(wide16 + 1);
+        append_big_endian(out, length, 4);
+    }
+}
+
+inline void
+write_msgpack_string(const char* s, size_t length, std::string& out) {
+    write_msgpack_header(out, length, 0xa0, 32, 0xd9, 0xda);
+    out.append(s, length);
+}
+
+inline void write_msgpack_value(const value& v, std::string& out) {
+    switch (v.get_type()) {
+    case TYPE_NULL:
+        out += '\xc0';
+        return;
+    case TYPE_FALSE:
+        out += '\xc2';
+        return;
+    case TYPE_TRUE:
+        out += '\xc3';
+        return;
+    case TYPE_INTEGER:
+        write_msgpack_integer(v.get_integer_value(), out);
+        return;
+    case TYPE_DOUBLE:
+        append_double(out, '\xcb', v.get_double_value());
+        return;
+    case TYPE_STRING:
+        write_msgpack_string(v.as_cstring(), v.get_string_length(), out);
+        return;
+    case TYPE_ARRAY: {
+        const size_t length = v.get_length();
+        write_msgpack_header(out, length, 0x90, 16, 0, 0xdc);
+        for (size_t i = 0; i < length; ++i) {
+            write_msgpack_value(v.get_array_element(i), out);
+        }
+        return;
+    }
+    case TYPE_OBJECT: {
+        const size_t length = v.get_length();
+        write_msgpack_header(out, length, 0x80, 16, 0, 0xde);
+        for (size_t i = 0; i < length; ++i) {
+            const string key = v.get_object_key(i);
+            write_msgpack_string(key.data(), key.length(), out);
+            write_msgpack_value(v.get_object_value(i), out);
+        }
+        return;
+    }
+    }
+    SAJSON_UNREACHABLE();
+}
+
+// Writes a CBOR item head: the major type and its argument in the fewest
+// bytes.
+inline void write_cbor_head(std::string& out, unsigned major, uint64_t n) {
+    const char type = static_cast<char>(major << 5);
+    if (n < 24) {
+        out += static_cast<char>(type | n);
+    } else if (n <= 0xff) {
+        out += static_cast<char>(type | 24);
+        append_big_endian(out, n, 1);
+    } else if (n <= 0xffff) {
+        out += static_cast<char>(type | 25);
+        append_big_endian(out, n, 2);
+    } else if (n <= 0xffffffffULL) {
+        out += static_cast<char>(type | 26);
+        append_big_endian(out, n, 4);
+    } else {
+        out += static_cast<char>(type | 27);
+        append_big_endian(out, n, 8);
+    }
+}
+
+inline void write_cbor_string(const char* s, size_t length, std::string& out) {
+    write_cbor_head(out, 3, length);
+    out.append(s, length);
+}
+
+inline void write_cbor_value(const value& v, std::string& out) {
+    switch (v.get_type()) {
+    case TYPE_NULL:
+        out += '\xf6';
+        return;
+    case TYPE_FALSE:
+        out += '\xf4';
+        return;
+    case TYPE_TRUE:
+        out += '\xf5';
+        return;
+    case TYPE_INTEGER: {
+        const int64_t i = v.get_integer_value();
+        if (i >= 0) {
+            write_cbor_head(out, 0, i);
+        } else {
+            write_cbor_head(out, 1, static_cast<uint64_t>(-(i + 1)));
+        }
+        return;
+    }
+    case TYPE_DOUBLE:
+        append_double(out, '\xfb', v.get_double_value());
+        return;
+    case TYPE_STRING:
+        write_cbor_string(v.as_cstring(), v.get_string_length(), out);
+        return;
+    case TYPE_ARRAY: {
+        const size_t length = v.get_length();
+        write_cbor_head(out, 4, length);
+        for (size_t i = 0; i < length; ++i) {
+            write_cbor_value(v.get_array_element(i), out);
+        }
+        return;
+    }
+    case TYPE_OBJECT: {
+        const size_t length = v.get_length();
+        write_cbor_head(out, 5, length);
+        for (size_t i = 0; i < length; ++i) {
+            const string key = v.get_object_key(i);
+            write_cbor_string(key.data(), key.length(), out);
+            write_cbor_value(v.get_object_value(i), out);
+        }
+        return;
+    }
+    }
+    SAJSON_UNREACHABLE();
+}
+
+// One decoded item.  Containers are decoded as a header; their elements
+// follow as separate items.
+struct binary_item {
+    tag kind;
+    // The value of tag::integer.
+    int integer;
+    // The value of tag::double_.
+    double number;
+    // A string's length in bytes, or an array's or object's element count.
+    size_t length;
+    // The input offset of a string's bytes.
+    size_t data;
+
+    void set_integer(int64_t i) {
+        if (i >= INT_MIN && i <= INT_MAX) {
+            kind = tag::integer;
+            integer = static_cast<int>(i);
+        } else {
+            kind = tag::double_;
+            number = static_cast<double>(i);
+        }
+    }
+
+    void set_unsigned(uint64_t n) {
+        if (n <= static_cast<uint64_t>(INT_MAX)) {
+            kind = tag::integer;
+            integer = static_cast<int>(n);
+        } else {
+            kind = tag::double_;
+            number = static_cast<double>(n);
+        }
+    }
+
+    void set_double(double d) {
+        kind = tag::double_;
+        number = d;
+    }
+
+    void set_count(tag kind_, uint64_t count) {
+        kind = kind_;
+        length = static_cast<size_t>(count);
+    }
+};
+
+// Reads a bytes-long big-endian integer at offset and advances past it.
+inline bool read_big_endian(
+    const unsigned char* data,
+    size_t length,
+    size_t& offset,
+    size_t bytes,
+    uint64_t& n) {
+    if (SAJSON_UNLIKELY(length - offset < bytes)) {
+        return false;
+    }
+    n = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        n = (n << 8) | data[offset + i];
+    }
+    offset += bytes;
+    return true;
+}
+
+// Points item at the string of the given length at offset and advances
+// past it.
+inline error read_string_bytes(
+    size_t length, size_t& offset, uint64_t string_length, binary_item& item) {
+    if (SAJSON_UNLIKELY(length - offset < string_length)) {
+        return ERROR_UNEXPECTED_END;
+    }
+    item.kind = tag::string;
+    item.length = static_cast<size_t>(string_length);
+    item.data = offset;
+    offset += item.length;
+    return ERROR_NO_ERROR;
+}
+
+inline double float_from_bits(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline double double_from_bits(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// RFC 8949 appendix D.
+inline double half_from_bits(unsigned bits) {
+    const unsigned exponent = (bits >> 10) & 0x1f;
+    const unsigned mantissa = bits & 0x3ff;
+    double d;
+    if (exponent == 0) {
+        d = ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        d = ldexp(mantissa + 1024, static_cast<int>(exponent) - 25);
+    } else {
+        d = mantissa ? std::numeric_limits<double>::quiet_NaN()
+                     : std::numeric_limits<double>::infinity();
+    }
+    return (bits & 0x8000) ? -d : d;
+}
+
+struct msgpack_format {
+    static error read_item(
+        const unsigned char* data,
+        size_t length,
+        size_t& offset,
+        binary_item& item) {
+        if (SAJSON_UNLIKELY(offset == length)) {
+            return ERROR_UNEXPECTED_END;
+        }
+        const unsigned char marker = data[offset++];
+        if (marker <= 0x7f) {
+            item.set_integer(marker);
+            return ERROR_NO_ERROR;
+        } else if (marker <= 0x8f) {
+            item.set_count(tag::object, marker & 0x0f);
+            return ERROR_NO_ERROR;
+        } else if (marker <= 0x9f) {
+            item.set_count(tag::array, marker & 0x0f);
+            return ERROR_NO_ERROR;
+        } else if (marker <= 0xbf) {
+            return read_string_bytes(length, offset, marker & 0x1f, item);
+        } else if (marker >= 0xe0) {
+            item.set_integer(static_cast<signed char>(marker));
+            return ERROR_NO_ERROR;
+        }
+
+        uint64_t n;
+        switch (marker) {
+        case 0xc0:
+            item.kind = tag::null;
+            return ERROR_NO_ERROR;
+        case 0xc2:
+            item.kind = tag::false_;
+            return ERROR_NO_ERROR;
+        case 0xc3:
+            item.kind = tag::true_;
+            return ERROR_NO_ERROR;
+        case 0xca:
+            if (!read_big_endian(data, length, offset, 4, n)) {
+                return ERROR_UNEXPECTED_END;
+            }
+            item.set_double(float_from_bits(static_cast<uint32_t>(n)));
+            return ERROR_NO_ERROR;
+        case 0xcb:
+            if (!read_big_endian(data, length, offset, 8, n)) {
+                return ERROR_UNEXPECTED_END;
+            }
+            item.set_double(double_from_bits(n));
+            return ERROR_NO_ERROR;
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf:
+            if (!read_big_endian(
+                    data, length, offset, size_t(1) << (marker - 0xcc), n)) {
+                return ERROR_UNEXPECTED_END;
+            }
+            item.set_unsigned(n);
+            return ERROR_NO_ERROR;
+        case 0xd0:
+        case 0xd1:
+        case 0xd2:
+        case 0xd3:
+            if (!read_big_endian(
+                    data, length, offset, size_t(1) << (marker - 0xd0), n)) {
+                return ERROR_UNEXPECTED_END;
+            }
+            switch (marker) {
+            case 0xd0:
+                item.set_integer(static_cast<int8_t>(n));
+                break;
+            case 0xd1:
+                item.set_integer(static_cast<int16_t>(n));
+                break;
+            case 0xd2:
+                item.set_integer(static_cast<int32_t>(n));
+                break;
+            default:
+                item.set_integer(static_cast<int64_t>(n));
+                break;
+            }
+            return ERROR_NO_ERROR;
+        case 0xd9:
+        case 0xda:
+        case 0xdb:
+            if (!read_big_endian(
+                    data, length, offset, size_t(1) << (marker - 0xd9), n)) {
+                return ERROR_UNEXPECTED_END;
+            }
+            return read_string_bytes(length, offset, n, item);
+        case 0xdc:
+        case 0xdd:
+        case 0xde:
+        case 0xdf:
+            if (!read_big_endian(
+                    data, length, offset, (marker & 1) ? 4 : 2, n)) {
+                return ERROR_UNEXPECTED_END;
+            }
+            item.set_count(marker <= 0xdd ? tag::array : tag::object, n);
+            return ERROR_NO_ERROR;
+        default:
+            // Never used (0xc1), bin, ext, and fixext.
+            return ERROR_INVALID_BINARY;
+        }
+    }
+};
+
+struct cbor_format {
+    static error read_item(
+        const unsigned char* data,
+        size_t length,
+        size_t& offset,
+        binary_item& item) {
+        for (;;) {
+            if (SAJSON_UNLIKELY(offset == length)) {
+                return ERROR_UNEXPECTED_END;
+            }
+            const unsigned char initial = data[offset++];
+            const unsigned major = initial >> 5;
+            const unsigned info = initial & 0x1f;
+            uint64_t n = info;
+            if (info >= 24) {
+                // 28 through 30 are reserved; 31 is indefinite length.
+                if (SAJSON_UNLIKELY(info > 27)) {
+                    return ERROR_INVALID_BINARY;
+                }
+                if (!read_big_endian(
+                        data, length, offset, size_t(1) << (info - 24), n)) {
+                    return ERROR_UNEXPECTED_END;
+                }
+            }
+
+            switch (major) {
+            case 0:
+                item.set_unsigned(n);
+                return ERROR_NO_ERROR;
+            case 1:
+                if (n <= static_cast<uint64_t>(INT64_MAX)) {
+                    item.set_integer(-1 - static_cast<int64_t>(n));
+                } else {
+                    item.set_double(-1.0 - static_cast<double>(n));
+                }
+                return ERROR_NO_ERROR;
+            case 3:
+                return read_string_bytes(length, offset, n, item);
+            case 4:
+                item.set_count(tag::array, n);
+                return ERROR_NO_ERROR;
+            case 5:
+                item.set_count(tag::object, n);
+                return ERROR_NO_ERROR;
+            case 6:
+                // A tag annotates the item that follows it.
+                continue;
+            case 7:
+                switch (info) {
+                case 20:
+                    item.kind = tag::false_;
+                    return ERROR_NO_ERROR;
+                case 21:
+                    item.kind = tag::true_;
+                    return ERROR_NO_ERROR;
+                case 22:
+                    item.kind = tag::null;
+                    return ERROR_NO_ERROR;
+                case 25:
+                    item.set_double(half_from_bits(static_cast<unsigned>(n)));
+                    return ERROR_NO_ERROR;
+                case 26:
+                    item.set_double(float_from_bits(static_cast<uint32_t>(n)));
+                    return ERROR_NO_ERROR;
+                case 27:
+                    item.set_double(double_from_bits(n));
+                    return ERROR_NO_ERROR;
+                default:
+                    return ERROR_INVALID_BINARY;
+                }
+            default:
+                // Byte strings.
+                return ERROR_INVALID_BINARY;
+            }
+        }
+    }
+};
+
+// Builds the AST for a MessagePack or CBOR item the way parser does for
+// JSON text.  Each open array or object's stack frame holds its parent's
+// marker, then the number of elements still to read, then its elements as
+// parser lays them out.
+template <typename Format, typename Allocator>
+class binary_decoder {
+public:
+    binary_decoder(const mutable_string_view& msv, Allocator&& allocator_)
+        : input(msv)
+        , data(reinterpret_cast<unsigned char*>(input.get_data()))
+        , length(input.length())
+        , offset(0)
+        , text_end(0)
+        , allocator(std::move(allocator_))
+        , root_tag(tag::null)
+        , error_offset(0)
+        , error_code(ERROR_NO_ERROR) {}
+
+    document get_document() {
+        if (decode()) {
+            return document::_internal_make_document(
+                input,
+                allocator.transfer_ownership(),
+                root_tag,
+                allocator.get_ast_root());
+        } else {
+            return document::_internal_make_error(
+                input, error_code, 1, error_offset + 1);
+        }
+    }
+
+private:
+    static const size_t frame_header = 2;
+
+    bool make_error(size_t at, error code) {
+        error_offset = at;
+        error_code = code;
+        return false;
+    }
+
+    bool read(binary_item& item) {
+        const size_t start = offset;
+        const error code = Format::read_item(data, length, offset, item);
+        if (SAJSON_UNLIKELY(code != ERROR_NO_ERROR)) {
+            return make_error(start, code);
+        }
+        return true;
+    }
+
+    // Moves the string's bytes down to the end of the strings before it and
+    // NUL-terminates them.  Every item's header occupies at least a byte,
+    // so the moved bytes and terminator never pass the item's end.
+    void install_string(const binary_item& item, size_t* out) {
+        char* const text = input.get_data();
+        memmove(text + text_end, text + item.data, item.length);
+        text[text_end + item.length] = 0;
+        out[0] = text_end;
+        out[1] = text_end + item.length;
+        text_end += item.length + 1;
+    }
+
+    bool decode() {
+        bool success;
+        auto stack = allocator.get_stack_head(&success);
+        if (SAJSON_UNLIKELY(!success)) {
+            return make_error(0, ERROR_OUT_OF_MEMORY);
+        }
+        if (SAJSON_UNLIKELY(length == 0)) {
+            return make_error(0, ERROR_MISSING_ROOT_ELEMENT);
+        }
+
+        binary_item item;
+        if (!read(item)) {
+            return false;
+        }
+        if (SAJSON_UNLIKELY(
+                item.kind != tag::array && item.kind != tag::object)) {
+            return make_error(0, ERROR_BAD_ROOT);
+        }
+        size_t current_base = stack.get_size();
+        tag current_structure_tag = item.kind;
+        if (SAJSON_UNLIKELY(
+                !stack.push(make_element(item.kind, ROOT_MARKER))
+                || !stack.push(item.length))) {
+            return make_error(0, ERROR_OUT_OF_MEMORY);
+        }
+
+        for (;;) {
+            size_t* const base_ptr
+                = stack.get_pointer_from_offset(current_base);
+            tag value_tag;
+            if (base_ptr[1] == 0) {
+                const size_t pop_element = base_ptr[0];
+                const bool installed = current_structure_tag == tag::array
+                    ? install_array(
+                          allocator, base_ptr + frame_header, stack.get_top())
+                    : install_object(
+                          allocator,
+                          input.get_data(),
+                          base_ptr + frame_header,
+                          stack.get_top());
+                if (SAJSON_UNLIKELY(!installed)) {
+                    return make_error(offset, ERROR_OUT_OF_MEMORY);
+                }
+                const size_t parent = get_element_value(pop_element);
+                if (parent == ROOT_MARKER) {
+                    root_tag = current_structure_tag;
+                    if (SAJSON_UNLIKELY(offset != length)) {
+                        return make_error(offset, ERROR_EXPECTED_END_OF_INPUT);
+                    }
+                    return true;
+                }
+                stack.reset(current_base);
+                current_base = parent;
+                value_tag = current_structure_tag;
+                current_structure_tag = get_element_tag(pop_element);
+            } else {
+                --base_ptr[1];
+                if (current_structure_tag == tag::object) {
+                    const size_t key_offset = offset;
+                    if (!read(item)) {
+                        return false;
+                    }
+                    if (SAJSON_UNLIKELY(item.kind != tag::string)) {
+                        return make_error(key_offset, ERROR_MISSING_OBJECT_KEY);
+                    }
+                    size_t* key = stack.reserve(2, &success);
+                    if (SAJSON_UNLIKELY(!success)) {
+                        return make_error(key_offset, ERROR_OUT_OF_MEMORY);
+                    }
+                    install_string(item, key);
+                }
+
+                const size_t value_offset = offset;
+                if (!read(item)) {
+                    return false;
+                }
+                value_tag = item.kind;
+                size_t* out;
+                success = true;
+                switch (item.kind) {
+                case tag::array:
+                case tag::object: {
+                    const size_t previous_base = current_base;
+                    current_base = stack.get_size();
+                    if (SAJSON_UNLIKELY(
+                            !stack.push(make_element(
+                                current_structure_tag, previous_base))
+                            || !stack.push(item.length))) {
+                        return make_error(value_offset, ERROR_OUT_OF_MEMORY);
+                    }
+                    current_structure_tag = item.kind;
+                    continue;
+                }
+                case tag::integer:
+                    out = allocator.reserve(
+                        integer_storage::word_length, &success);
+                    if (success) {
+                        integer_storage::store(out, item.integer);
+                    }
+                    break;
+                case tag::double_:
+                    out = allocator.reserve(
+                        double_storage::word_length, &success);
+                    if (success) {
+                        double_storage::store(out, item.number);
+                    }
+                    break;
+                case tag::string:
+                    out = allocator.reserve(2, &success);
+                    if (success) {
+                        install_string(item, out);
+                    }
+                    break;
+                default:
+                    break;
+                }
+                if (SAJSON_UNLIKELY(!success)) {
+                    return make_error(value_offset, ERROR_OUT_OF_MEMORY);
+                }
+            }
+
+            if (SAJSON_UNLIKELY(!stack.push(
+                    make_element(value_tag, allocator.get_write_offset())))) {
+                return make_error(offset, ERROR_OUT_OF_MEMORY);
+            }
+        }
+    }
+
+    mutable_string_view input;
+    unsigned char* const data;
+    const size_t length;
+    size_t offset;
+    // Where the next decoded string's bytes go.
+    size_t text_end;
+    Allocator allocator;
+    tag root_tag;
+    size_t error_offset;
+    error error_code;
+};
+
+template <typename Format, typename AllocationStrategy, typename StringType>
+document
+decode_binary(const AllocationStrategy& strategy, const StringType& string) {
+    mutable_string_view input(string);
+
+    // Each item takes at least one byte and adds at most three words: a
+    // string's two plus its element word, or an object key's record.
+    bool success;
+    auto allocator = strategy.make_allocator(3 * input.length() + 1, &success);
+    if (!success) {
+        return document::_internal_make_error(
+            input, ERROR_OUT_OF_MEMORY, 1, 1);
+    }
+    return binary_decoder<Format, typename AllocationStrategy::allocator>(
+               input, std::move(allocator))
+        .get_document();
+}
+} // namespace internal
+
+/// Appends v to out as MessagePack.
+inline void write_msgpack(const value& v, std::string& out) {
+    internal::write_msgpack_value(v, out);
+}
+
+/// Appends v to out as CBOR.
+inline void write_cbor(const value& v, std::string& out) {
+    internal::write_cbor_value(v, out);
+}
+
+/**
+ * Decodes a MessagePack array or map into a \ref document, as \ref parse
+ * does for JSON text.  Like parse, a mutable_string_view is decoded in
+ * place and other inputs are copied first.  The error column of an invalid
+ * document is the one-based offset of the item that failed.  A
+ * single_allocation needs three words per input byte.
+ */
+template <typename AllocationStrategy, typename StringType>
+document
+parse_msgpack(const AllocationStrategy& strategy, const StringType& string) {
+    return internal::decode_binary<internal::msgpack_format>(strategy, string);
+}
+
+/// Like \ref parse_msgpack, for a CBOR array or map.
+template <typename AllocationStrategy, typename StringType>
+document
+parse_cbor(const AllocationStrategy& strategy, const StringType& string) {
+    return internal::decode_binary<internal::cbor_format>(strategy, string);
+}
+
+} // namespace sajson
@@ -0,0 +1,764 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Declarative decoding of JSON objects into structs.
+ *
+ *     struct point {
+ *         int x;
+ *         int y;
+ *         std::string label;
+ *     };
+ *     SAJSON_BIND(point, x, y, label)
+ *
+ *     point p;
+ *     if (!sajson::decode(doc.get_root(), p)) { ... }
+ *
+ * SAJSON_BIND must appear in the struct's namespace, after the struct, and
+ * accepts up to 32 fields.  Each field's JSON key is its member name.
+ *
+ * Fields may be bool, int, int64_t (from integers up to 53 bits), double,
+ * std::string, sajson::value (the raw value, valid as long as the
+ * document), std::vector of any supported type, or another bound struct.
+ *
+ * For high-volume message types with a fixed shape, SAJSON_SCHEMA also
+ * marks each field required or optional:
+ *
+ *     SAJSON_SCHEMA(trade, SAJSON_REQUIRED(symbol), SAJSON_REQUIRED(price),
+ *                   SAJSON_OPTIONAL(venue))
+ *
+ *     trade t;
+ *     if (!sajson::parse_into(sajson::dynamic_allocation(), text, t)) { ... }
+ *
+ * parse_into() reads flat objects of scalar fields straight from the text,
+ * without building an AST, and falls back to \ref parse and decode() for
+ * anything else.
+ */
+namespace sajson {
+
+namespace internal {
+// One entry of a bound struct's field table.
+struct bound_field {
+    const char* key;
+    size_t key_length;
+    bool required;
+    // Decodes the JSON value into the field of the struct at object.
+    bool (*decode)(const value& v, void* object);
+    // Parses the field straight from JSON text at *p, advancing *p, or
+    // returns false if the text needs the generic parser.
+    bool (*parse)(const char** p, const char* end, void* object);
+};
+
+// A bound struct's fields, sorted the way sajson sorts object keys so that
+// decoding is a merge join against the parsed object.
+class field_table {
+public:
+    template <size_t N>
+    explicit field_table(const bound_field (&fields_)[N])
+        : count(N) {
+        static_assert(N <= max_fields, "SAJSON_BIND supports 32 fields");
+        for (size_t i = 0; i < N; ++i) {
+            fields[i] = fields_[i];
+        }
+        std::sort(fields, fields + N, [](const bound_field& a,
+                                         const bound_field& b) {
+            return compare_keys(key_of(a), key_of(b)) < 0;
+        });
+        required_mask = 0;
+        for (size_t i = 0; i < N; ++i) {
+            prefixes[i] = load_prefix(fields[i].key, fields[i].key_length);
+            if (fields[i].required) {
+                required_mask |= uint32_t(1) << i;
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+
+    const bound_field& operator[](size_t i) const { return fields[i]; }
+
+    static string key_of(const bound_field& f) {
+        return string(f.key, f.key_length);
+    }
+
+    bool decode(const value& v, void* object) const {
+        if (v.get_type() != TYPE_OBJECT) {
+            return false;
+        }
+        uint32_t seen = 0;
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+        for (size_t i = 0; i < count; ++i) {
+            const size_t k = v.find_object_key(key_of(fields[i]));
+            if (k != v.get_length()) {
+                if (!fields[i].decode(v.get_object_value(k), object)) {
+                    return false;
+                }
+                seen |= uint32_t(1) << i;
+            }
+        }
+#else
+        size_t i = 0;
+        const object_range members = v.members();
+        for (auto it = members.begin(); it != members.end() && i < count;
+             ++it) {
+            const string key = it.get_key();
+            int c = 1;
+            while (i < count
+                   && (c = compare_keys(key_of(fields[i]), key)) < 0) {
+                ++i;
+            }
+            if (i < count && c == 0) {
+                if (!fields[i].decode(it.get_value(), object)) {
+                    return false;
+                }
+                seen |= uint32_t(1) << i;
+            }
+        }
+#endif
+        return (seen & required_mask) == required_mask;
+    }
+
+    // Parses a flat JSON object directly into the struct at object.
+    // Returns false if the text is anything else, including valid JSON
+    // that needs the generic parser, or a required field is missing.
+    bool parse(const char* p, const char* end, void* object) const {
+        uint32_t seen = 0;
+        p = skip_whitespace(p, end);
+        if (p == end || *p++ != '{') {
+            return false;
+        }
+        p = skip_whitespace(p, end);
+        if (p != end && *p == '}') {
+            ++p;
+        } else {
+            for (;;) {
+                if (p == end || *p++ != '"') {
+                    return false;
+                }
+                const char* key = p;
+                while (p != end && is_plain_string_character(*p)) {
+                    ++p;
+                }
+                if (p == end || *p != '"') {
+                    return false;
+                }
+                const size_t i = find(key, p - key);
+                p = skip_whitespace(p + 1, end);
+                if (i == count || p == end || *p++ != ':') {
+                    return false;
+                }
+                p = skip_whitespace(p, end);
+                if (!fields[i].parse(&p, end, object)) {
+                    return false;
+                }
+                seen |= uint32_t(1) << i;
+
+                p = skip_whitespace(p, end);
+                if (p == end) {
+                    return false;
+                }
+                const char c = *p++;
+                if (c == '}') {
+                    break;
+                } else if (c != ',') {
+                    return false;
+                }
+                p = skip_whitespace(p, end);
+            }
+        }
+        return skip_whitespace(p, end) == end
+            && (seen & required_mask) == required_mask;
+    }
+
+private:
+    static const size_t max_fields = 32;
+
+    static const char* skip_whitespace(const char* p, const char* end) {
+        while (p != end && is_whitespace(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    // The first eight bytes of a key, zero-padded, so most mismatches are
+    // rejected with one integer comparison.
+    static uint64_t load_prefix(const char* key, size_t length) {
+        uint64_t prefix = 0;
+        memcpy(&prefix, key, length < 8 ? length : 8);
+        return prefix;
+    }
+
+    // Returns the index of the field with the given key, or count.
+    size_t find(const char* key, size_t length) const {
+        const uint64_t prefix = load_prefix(key, length);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t field_length = fields[i].key_length;
+            if (field_length > length) {
+                break;
+            }
+            if (field_length == length && prefixes[i] == prefix
+                && (length <= 8
+                    || memcmp(key + 8, fields[i].key + 8, length - 8) == 0)) {
+                return i;
+            }
+        }
+        return count;
+    }
+
+    size_t count;
+    uint32_t required_mask;
+    bound_field fields[max_fields];
+    uint64_t prefixes[max_fields];
+};
+
+// Direct parsers read one value of a field's type straight from JSON text
+// and advance p past it.  They accept only what they can decode exactly as
+// parse() and decode() would, and otherwise return false so the caller
+// falls back to them.
+template <typename T>
+bool parse_direct(const char*&, const char*, T&) {
+    return false;
+}
+
+inline bool parse_direct(const char*& p, const char* end, bool& out) {
+    if (end - p >= 4 && memcmp(p, "true", 4) == 0) {
+        out = true;
+        p += 4;
+        return true;
+    }
+    if (end - p >= 5 && memcmp(p, "false", 5) == 0) {
+        out = false;
+        p += 5;
+        return true;
+    }
+    return false;
+}
+
+inline bool parse_direct(const char*& p, const char* end, std::string& out) {
+    if (p == end || *p != '"') {
+        return false;
+    }
+    const char* start = ++p;
+    while (p != end && is_plain_string_character(*p)) {
+        ++p;
+    }
+    // Escapes and non-ASCII text go through the generic parser, which
+    // decodes and validates them.
+    if (p == end || *p != '"') {
+        return false;
+    }
+    out.assign(start, p);
+    ++p;
+    return true;
+}
+
+// A JSON number with at most 15 significant digits, which is exact as
+// either an integer or a double.
+struct short_number {
+    bool negative;
+    // True if there was no fraction or exponent.
+    bool integral;
+    // True if parse() would store the number as a 32-bit integer.
+    bool fits_int;
+    uint64_t digits;
+    int64_t exponent;
+};
+
+inline bool scan_number(const char*& p, const char* end, short_number* n) {
+    n->negative = p != end && *p == '-';
+    if (n->negative) {
+        ++p;
+    }
+    n->integral = true;
+    n->fits_int = true;
+    n->digits = 0;
+    n->exponent = 0;
+    int count = 0;
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+    if (*p == '0') {
+        ++p;
+        count = 1;
+    } else {
+        while (p != end && *p >= '0' && *p <= '9') {
+            // Mirrors the integer overflow check in parse_number.
+            if (n->digits > INT_MAX / 10 - 9) {
+                n->fits_int = false;
+            }
+            n->digits = n->digits * 10 + (*p++ - '0');
+            ++count;
+        }
+    }
+    if (p != end && *p == '.') {
+        n->integral = false;
+        ++p;
+        if (p == end || *p < '0' || *p > '9') {
+            return false;
+        }
+        while (p != end && *p >= '0' && *p <= '9') {
+            n->digits = n->digits * 10 + (*p++ - '0');
+            --n->exponent;
+            ++count;
+        }
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        n->integral = false;
+        ++p;
+        const bool negative_exponent = p != end && *p == '-';
+        if (p != end && (*p == '-' || *p == '+')) {
+            ++p;
+        }
+        if (p == end || *p < '0' || *p > '9') {
+            return false;
+        }
+        int exponent = 0;
+        int exponent_digits = 0;
+        while (p != end && *p >= '0' && *p <= '9') {
+            exponent = exponent * 10 + (*p++ - '0');
+            if (++exponent_digits > 4) {
+                return false;
+            }
+        }
+        n->exponent += negative_exponent ? -exponent : exponent;
+    }
+    return count <= 15;
+}
+
+inline bool parse_direct(const char*& p, const char* end, int& out) {
+    short_number n;
+    if (!scan_number(p, end, &n) || !n.integral || !n.fits_int) {
+        return false;
+    }
+    out = static_cast<int>(n.digits);
+    if (n.negative) {
+        out = -out;
+    }
+    return true;
+}
+
+inline bool parse_direct(const char*& p, const char* end, int64_t& out) {
+    short_number n;
+    if (!scan_number(p, end, &n) || !n.integral) {
+        return false;
+    }
+    out = static_cast<int64_t>(n.digits);
+    if (n.negative) {
+        out = -out;
+    }
+    return true;
+}
+
+inline bool parse_direct(const char*& p, const char* end, double& out) {
+    short_number n;
+    if (!scan_number(p, end, &n)) {
+        return false;
+    }
+    // The same conversion as parse_number, so results are bit-identical.
+    if (n.integral && n.fits_int) {
+        // parse_number negates an int, so -0 is 0.
+        const int i = static_cast<int>(n.digits);
+        out = n.negative ? -i : i;
+        return true;
+    }
+    const double d = decimal_to_double(n.digits, n.exponent);
+    out = n.negative ? -d : d;
+    return true;
+}
+
+constexpr bool any_of() { return false; }
+
+template <typename... Rest>
+constexpr bool any_of(bool first, Rest... rest) {
+    return first || any_of(rest...);
+}
+
+// Whether a field of type T, once decoded, refers into the document it was
+// decoded from.  Bound structs answer with the sajson_bound_holds_value()
+// that SAJSON_BIND defines, found by argument-dependent lookup.
+constexpr bool holds_value(const bool*) { return false; }
+constexpr bool holds_value(const int*) { return false; }
+constexpr bool holds_value(const int64_t*) { return false; }
+constexpr bool holds_value(const double*) { return false; }
+constexpr bool holds_value(const std::string*) { return false; }
+constexpr bool holds_value(const value*) { return true; }
+template <typename T>
+constexpr bool holds_value(const std::vector<T>*);
+template <typename T>
+constexpr bool holds_value(const T*);
+
+template <typename T>
+constexpr bool holds_value(const std::vector<T>*) {
+    return holds_value(static_cast<const T*>(0));
+}
+
+template <typename T>
+constexpr bool holds_value(const T*) {
+    return sajson_bound_holds_value(static_cast<const T*>(0));
+}
+} // namespace internal
+
+/// \cond INTERNAL
+bool decode(const value& v, bool& out);
+bool decode(const value& v, int& out);
+bool decode(const value& v, int64_t& out);
+bool decode(const value& v, double& out);
+bool decode(const value& v, std::string& out);
+bool decode(const value& v, value& out);
+bool decode(const value& v, std::vector<bool>& out);
+template <typename T>
+bool decode(const value& v, std::vector<T>& out);
+template <typename T>
+bool decode(const value& v, T& out);
+/// \endcond
+
+/// Decodes true or false.
+inline bool decode(const value& v, bool& out) {
+    switch (v.get_type()) {
+    case TYPE_TRUE:
+        out = true;
+        return true;
+    case TYPE_FALSE:
+        out = false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Decodes a number that sajson parsed as a 32-bit integer.
+inline bool decode(const value& v, int& out) {
+    if (v.get_type() != TYPE_INTEGER) {
+        return false;
+    }
+    out = v.get_integer_value();
+    return true;
+}
+
+/// Decodes an integral number of up to 53 bits.
+inline bool decode(const value& v, int64_t& out) {
+    const type t = v.get_type();
+    return (t == TYPE_INTEGER || t == TYPE_DOUBLE) && v.get_int53_value(&out);
+}
+
+/// Decodes any number.
+inline bool decode(const value& v, double& out) {
+    const type t = v.get_type();
+    if (t != TYPE_INTEGER && t != TYPE_DOUBLE) {
+        return false;
+    }
+    out = v.get_number_value();
+    return true;
+}
+
+/// Decodes a string.
+inline bool decode(const value& v, std::string& out) {
+    if (v.get_type() != TYPE_STRING) {
+        return false;
+    }
+    out.assign(v.as_cstring(), v.get_string_length());
+    return true;
+}
+
+/// Stores the value itself, for fields decoded later or by hand.
+inline bool decode(const value& v, value& out) {
+    out = v;
+    return true;
+}
+
+/// Decodes an array whose elements all decode as T.
+template <typename T>
+bool decode(const value& v, std::vector<T>& out) {
+    if (v.get_type() != TYPE_ARRAY) {
+        return false;
+    }
+    out.resize(v.get_length());
+    size_t i = 0;
+    for (const value& element : v.elements()) {
+        if (!decode(element, out[i++])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Decodes an array of booleans.  std::vector<bool> has no bool& to decode
+/// each element into, so this overload appends them instead.
+inline bool decode(const value& v, std::vector<bool>& out) {
+    if (v.get_type() != TYPE_ARRAY) {
+        return false;
+    }
+    out.clear();
+    out.reserve(v.get_length());
+    for (const value& element : v.elements()) {
+        bool b;
+        if (!decode(element, b)) {
+            return false;
+        }
+        out.push_back(b);
+    }
+    return true;
+}
+
+/**
+ * Decodes an object into a struct bound with SAJSON_BIND.
+ *
+ * Walks the object's sorted keys and the struct's sorted field table
+ * together, so each key is compared against the fields once.  Keys with no
+ * matching field are ignored and fields with no matching key are left
+ * unchanged.  Returns false if v is not an object, a field's value has the
+ * wrong type, or a SAJSON_REQUIRED field is missing, in which case some
+ * fields may already have been written.
+ */
+template <typename T>
+bool decode(const value& v, T& out) {
+    // Found by argument-dependent lookup in T's namespace.
+    return sajson_bound_fields(static_cast<const T*>(0)).decode(v, &out);
+}
+
+/**
+ * Parses JSON text straight into a struct bound with SAJSON_SCHEMA or
+ * SAJSON_BIND, with the same result as parsing it and calling decode().
+ *
+ * If the text is a flat object whose keys all name fields and whose values
+ * are numbers, booleans, or strings without escapes or non-ASCII
+ * characters, the fields are written directly from the text: keys are
+ * matched against precomputed prefixes and no AST is built.  Any other
+ * input, including nested values, unknown keys, and errors, is parsed with
+ * \ref parse using the given allocation strategy and then decoded.
+ *
+ * Because the fallback document does not outlive the call, T must not
+ * contain sajson::value fields, directly or in nested structs and vectors;
+ * this is checked at compile time.  Parse and use decode() to keep them.
+ */
+template <typename T, typename AllocationStrategy>
+bool parse_into(
+    const AllocationStrategy& strategy, const string& input, T& out) {
+    static_assert(
+        !sajson_bound_holds_value(static_cast<const T*>(0)),
+        "parse_into cannot fill sajson::value fields: they would point into "
+        "a document destroyed before it returns");
+    const internal::field_table& fields
+        = sajson_bound_fields(static_cast<const T*>(0));
+    if (fields.parse(input.data(), input.data() + input.length(), &out)) {
+        return true;
+    }
+    const document doc = parse(strategy, input);
+    return doc.is_valid() && decode(doc.get_root(), out);
+}
+
+} // namespace sajson
+
+/// \cond INTERNAL
+#define SAJSON_INTERNAL_EXPAND(x) x
+
+#define SAJSON_INTERNAL_FIELD(field, required)                            \
+    {                                                                     \
+        #field, sizeof(#field) - 1, required,                             \
+            [](const ::sajson::value& v, void* object) {                  \
+                return ::sajson::decode(                                  \
+                    v, static_cast<sajson_bound_type*>(object)->field);   \
+            },                                                            \
+            [](const char** p, const char* end, void* object) {           \
+                return ::sajson::internal::parse_direct(                  \
+                    *p,                                                   \
+                    end,                                                  \
+                    static_cast<sajson_bound_type*>(object)->field);      \
+            }                                                             \
+    }
+
+#define SAJSON_INTERNAL_FIELD_HOLDS_VALUE(field, required)                \
+    ::sajson::internal::holds_value(                                      \
+        static_cast<const decltype(sajson_bound_type::field)*>(0))
+
+// Fields are passed around as (field, required) pairs.
+#define SAJSON_INTERNAL_TABLE_ENTRY(pair) SAJSON_INTERNAL_FIELD pair
+#define SAJSON_INTERNAL_HOLDS_VALUE_ENTRY(pair)                           \
+    SAJSON_INTERNAL_FIELD_HOLDS_VALUE pair
+#define SAJSON_INTERNAL_OPTIONAL_PAIR(field) (field, false)
+
+// Applies m to each argument, separating the results with commas.
+#define SAJSON_INTERNAL_EACH_1(m, f) m(f)
+#define SAJSON_INTERNAL_EACH_2(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_1(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_3(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_2(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_4(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_3(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_5(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_4(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_6(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_5(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_7(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_6(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_8(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_7(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_9(m, f, ...)                                 \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_8(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_10(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_9(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_11(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_10(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_12(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_11(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_13(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_12(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_14(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_13(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_15(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_14(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_16(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_15(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_17(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_16(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_18(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_17(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_19(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_18(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_20(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_19(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_21(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_20(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_22(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_21(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_23(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_22(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_24(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_23(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_25(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_24(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_26(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_25(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_27(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_26(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_28(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_27(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_29(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_28(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_30(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_29(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_31(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_30(m, __VA_ARGS__))
+#define SAJSON_INTERNAL_EACH_32(m, f, ...)                                \
+    m(f), SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_EACH_31(m, __VA_ARGS__))
+
+#define SAJSON_INTERNAL_COUNT(                                            \
+    _1,                                                                   \
+    _2,                                                                   \
+    _3,                                                                   \
+    _4,                                                                   \
+    _5,                                                                   \
+    _6,                                                                   \
+    _7,                                                                   \
+    _8,                                                                   \
+    _9,                                                                   \
+    _10,                                                                  \
+    _11,                                                                  \
+    _12,                                                                  \
+    _13,                                                                  \
+    _14,                                                                  \
+    _15,                                                                  \
+    _16,                                                                  \
+    _17,                                                                  \
+    _18,                                                                  \
+    _19,                                                                  \
+    _20,                                                                  \
+    _21,                                                                  \
+    _22,                                                                  \
+    _23,                                                                  \
+    _24,                                                                  \
+    _25,                                                                  \
+    _26,                                                                  \
+    _27,                                                                  \
+    _28,                                                                  \
+    _29,                                                                  \
+    _30,                                                                  \
+    _31,                                                                  \
+    _32,                                                                  \
+    n,                                                                    \
+    ...)                                                                  \
+    n
+#define SAJSON_INTERNAL_NARGS(...)                                        \
+    SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_COUNT(                         \
+        __VA_ARGS__,                                                      \
+        32,                                                               \
+        31,                                                               \
+        30,                                                               \
+        29,                                                               \
+        28,                                                               \
+        27,                                                               \
+        26,                                                               \
+        25,                                                               \
+        24,                                                               \
+        23,                                                               \
+        22,                                                               \
+        21,                                                               \
+        20,                                                               \
+        19,                                                               \
+        18,                                                               \
+        17,                                                               \
+        16,                                                               \
+        15,                                                               \
+        14,                                                               \
+        13,                                                               \
+        12,                                                               \
+        11,                                                               \
+        10,                                                               \
+        9,                                                                \
+        8,                                                                \
+        7,                                                                \
+        6,                                                                \
+        5,                                                                \
+        4,                                                                \
+        3,                                                                \
+        2,                                                                \
+        1))
+
+#define SAJSON_INTERNAL_CONCAT2(a, b) a##b
+#define SAJSON_INTERNAL_CONCAT(a, b) SAJSON_INTERNAL_CONCAT2(a, b)
+#define SAJSON_INTERNAL_EACH(m, ...)                                      \
+    SAJSON_INTERNAL_EXPAND(SAJSON_INTERNAL_CONCAT(                        \
+        SAJSON_INTERNAL_EACH_, SAJSON_INTERNAL_NARGS(__VA_ARGS__))(       \
+        m, __VA_ARGS__))
+
+// Defines the field table, and whether Type holds sajson::value fields,
+// from (field, required) pairs.
+#define SAJSON_INTERNAL_FIELD_TABLE(Type, ...)                            \
+    inline const ::sajson::internal::field_table& sajson_bound_fields(    \
+        const Type*) {                                                    \
+        typedef Type sajson_bound_type;                                   \
+        static const ::sajson::internal::bound_field fields[] = {         \
+            SAJSON_INTERNAL_EACH(                                         \
+                SAJSON_INTERNAL_TABLE_ENTRY, __VA_ARGS__)                 \
+        };                                                                \
+        static const ::sajson::internal::field_table table(fields);       \
+        return table;                                                     \
+    }                                                                     \
+    constexpr bool sajson_bound_holds_value(const Type*) {                \
+        typedef Type sajson_bound_type;                                   \
+        return ::sajson::internal::any_of(SAJSON_INTERNAL_EACH(           \
+            SAJSON_INTERNAL_HOLDS_VALUE_ENTRY, __VA_ARGS__));             \
+    }
+/// \endcond
+
+/// Binds the named members of Type to the JSON keys of the same names so
+/// that sajson::decode(value, Type&) can fill it.  See sajson_bind.h.
+#define SAJSON_BIND(Type, ...)                                            \
+    SAJSON_INTERNAL_FIELD_TABLE(                                          \
+        Type, SAJSON_INTERNAL_EACH(SAJSON_INTERNAL_OPTIONAL_PAIR, __VA_ARGS__))
+
+/// Like SAJSON_BIND, but each field is given as SAJSON_REQUIRED(field) or
+/// SAJSON_OPTIONAL(field).  decode() and parse_into() fail if a required
+/// field is missing.
+#define SAJSON_SCHEMA(Type, ...) SAJSON_INTERNAL_FIELD_TABLE(Type, __VA_ARGS__)
+
+/// A field that must be present.  See SAJSON_SCHEMA.
+#define SAJSON_REQUIRED(field) (field, true)
+
+/// A field that may be absent.  See SAJSON_SCHEMA.
+#define SAJSON_OPTIONAL(field) (field, false)
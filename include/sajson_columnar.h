@@ -0,0 +1,430 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Extraction of top-level fields from streams of JSON records into typed
+ * columns.
+ *
+ *     sajson::column_extractor extractor({
+ *         { "id", sajson::COLUMN_INT64 },
+ *         { "price", sajson::COLUMN_DOUBLE },
+ *         { "symbol", sajson::COLUMN_STRING },
+ *     });
+ *     if (!extractor.append_records(sajson::string(text, length))) { ... }
+ *     const sajson::column& price = extractor.get_column(1);
+ *
+ * Each record is parsed into an AST buffer that the extractor keeps between
+ * records and batches, and all requested keys are found with one merge
+ * over the record's sorted keys (value::get_values_of_keys), so steady-state
+ * extraction does not allocate except to grow the columns.
+ *
+ * Columns use Apache Arrow's memory layouts: a validity bitmap with bit i,
+ * least significant first, set if row i has a value, and then bit-packed
+ * booleans, int64 or float64 values, or int32 offsets into UTF-8 bytes.
+ * Every buffer comes from operator new and so meets Arrow's 8-byte
+ * alignment; callers can wrap them without copying.
+ */
+namespace sajson {
+
+/// The Arrow type a column's values are stored as.
+enum column_type {
+    /// Arrow Boolean, from true and false.
+    COLUMN_BOOLEAN,
+    /// Arrow Int64, from integers and from doubles that hold an integer of
+    /// at most 53 bits.
+    COLUMN_INT64,
+    /// Arrow Float64, from any number.
+    COLUMN_DOUBLE,
+    /// Arrow Utf8, from strings.
+    COLUMN_STRING,
+};
+
+/// A column to extract: a top-level key and the type to store it as.
+struct column_spec {
+    std::string key;
+    column_type type;
+};
+
+namespace internal {
+inline void append_bit(std::vector<uint8_t>& bits, size_t index, bool set) {
+    if ((index & 7) == 0) {
+        bits.push_back(0);
+    }
+    if (set) {
+        bits.back() |= static_cast<uint8_t>(1u << (index & 7));
+    }
+}
+
+inline bool get_bit(const std::vector<uint8_t>& bits, size_t index) {
+    return (bits[index >> 3] >> (index & 7)) & 1;
+}
+} // namespace internal
+
+/**
+ * One extracted column.  A row is null if its record lacks the key, or if
+ * the key's value is null or cannot be stored as the column's type; a null
+ * row's value is zero, false, or the empty string.
+ */
+class column {
+public:
+    column(const std::string& key_, column_type type_)
+        : key(key_)
+        , type(type_)
+        , length(0)
+        , null_count(0) {
+        offsets.push_back(0);
+    }
+
+    const std::string& get_key() const { return key; }
+
+    column_type get_type() const { return type; }
+
+    /// Returns the number of rows.
+    size_t get_length() const { return length; }
+
+    /// Returns the number of null rows.
+    size_t get_null_count() const { return null_count; }
+
+    /// Returns true if row is not null.
+    bool is_valid(size_t row) const {
+        assert(row < length);
+        return internal::get_bit(validity, row);
+    }
+
+    /// Returns the validity bitmap: (length + 7) / 8 bytes, with bit i, least
+    /// significant first, set if row i is not null.
+    const uint8_t* get_validity_bitmap() const { return validity.data(); }
+
+    /// Returns the bit-packed values, laid out like the validity bitmap.
+    /// Only legal if get_type() is COLUMN_BOOLEAN.
+    const uint8_t* get_boolean_bitmap() const {
+        assert(type == COLUMN_BOOLEAN);
+        return booleans.data();
+    }
+
+    /// Returns length values.  Only legal if get_type() is COLUMN_INT64.
+    const int64_t* get_int64_values() const {
+        assert(type == COLUMN_INT64);
+        return integers.data();
+    }
+
+    /// Returns length values.  Only legal if get_type() is COLUMN_DOUBLE.
+    const double* get_double_values() const {
+        assert(type == COLUMN_DOUBLE);
+        return doubles.data();
+    }
+
+    /// Returns length + 1 offsets: row i's bytes are
+    /// [offsets[i], offsets[i + 1]) of get_string_data().
+    /// Only legal if get_type() is COLUMN_STRING.
+    const int32_t* get_string_offsets() const {
+        assert(type == COLUMN_STRING);
+        return offsets.data();
+    }
+
+    /// Returns the concatenated bytes of every row's string.
+    /// Only legal if get_type() is COLUMN_STRING.
+    const char* get_string_data() const {
+        assert(type == COLUMN_STRING);
+        return characters.data();
+    }
+
+    /// Only legal if get_type() is COLUMN_BOOLEAN.
+    bool get_boolean(size_t row) const {
+        assert(type == COLUMN_BOOLEAN && row < length);
+        return internal::get_bit(booleans, row);
+    }
+
+    /// Only legal if get_type() is COLUMN_INT64.
+    int64_t get_int64(size_t row) const {
+        assert(type == COLUMN_INT64 && row < length);
+        return integers[row];
+    }
+
+    /// Only legal if get_type() is COLUMN_DOUBLE.
+    double get_double(size_t row) const {
+        assert(type == COLUMN_DOUBLE && row < length);
+        return doubles[row];
+    }
+
+    /// Only legal if get_type() is COLUMN_STRING.
+    string get_string(size_t row) const {
+        assert(type == COLUMN_STRING && row < length);
+        return string(
+            characters.data() + offsets[row], offsets[row + 1] - offsets[row]);
+    }
+
+private:
+    friend class column_extractor;
+
+    // Returns false if appending v would overflow the int32 string offsets.
+    bool has_room_for(const value& v) const {
+        return type != COLUMN_STRING || v.get_type() != TYPE_STRING
+            || v.get_string_length()
+            <= static_cast<size_t>(INT32_MAX - offsets.back());
+    }
+
+    // Appends v as a row, or a null row if v does not convert.
+    void append(const value& v) {
+        bool valid = false;
+        switch (type) {
+        case COLUMN_BOOLEAN: {
+            const sajson::type t = v.get_type();
+            valid = t == TYPE_TRUE || t == TYPE_FALSE;
+            internal::append_bit(booleans, length, t == TYPE_TRUE);
+            break;
+        }
+        case COLUMN_INT64: {
+            int64_t i = 0;
+            const sajson::type t = v.get_type();
+            if (t == TYPE_INTEGER || t == TYPE_DOUBLE) {
+                valid = v.get_int53_value(&i);
+            }
+            integers.push_back(i);
+            break;
+        }
+        case COLUMN_DOUBLE: {
+            const sajson::type t = v.get_type();
+            valid = t == TYPE_INTEGER || t == TYPE_DOUBLE;
+            doubles.push_back(valid ? v.get_number_value() : 0.0);
+            break;
+        }
+        case COLUMN_STRING:
+            if (v.get_type() == TYPE_STRING) {
+                const size_t n = v.get_string_length();
+                characters.insert(
+                    characters.end(), v.as_cstring(), v.as_cstring() + n);
+                valid = true;
+            }
+            offsets.push_back(static_cast<int32_t>(characters.size()));
+            break;
+        }
+        internal::append_bit(validity, length, valid);
+        null_count += !valid;
+        ++length;
+    }
+
+    // Keeps each buffer's capacity for the next batch.
+    void clear() {
+        length = 0;
+        null_count = 0;
+        validity.clear();
+        booleans.clear();
+        integers.clear();
+        doubles.clear();
+        offsets.resize(1);
+        characters.clear();
+    }
+
+    std::string key;
+    column_type type;
+    size_t length;
+    size_t null_count;
+    std::vector<uint8_t> validity;
+    std::vector<uint8_t> booleans;
+    std::vector<int64_t> integers;
+    std::vector<double> doubles;
+    std::vector<int32_t> offsets;
+    std::vector<char> characters;
+};
+
+/**
+ * Fills a set of columns from JSON records, one row per record.
+ *
+ * Records that are not objects add a row of nulls.  Call clear() between
+ * batches to reuse the columns' and the parser's buffers.
+ */
+class column_extractor {
+public:
+    explicit column_extractor(const std::vector<column_spec>& specs)
+        : row_count(0)
+        , error_record(0)
+        , error_code(ERROR_NO_ERROR) {
+        columns.reserve(specs.size());
+        for (const column_spec& spec : specs) {
+            columns.push_back(column(spec.key, spec.type));
+        }
+        // get_values_of_keys wants the keys in sajson's object key order.
+        order.resize(columns.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const std::string& x = columns[a].key;
+            const std::string& y = columns[b].key;
+            if (x.size() != y.size()) {
+                return x.size() < y.size();
+            }
+            return memcmp(x.data(), y.data(), x.size()) < 0;
+        });
+        for (size_t i : order) {
+            sorted_keys.push_back(
+                string(columns[i].key.data(), columns[i].key.size()));
+        }
+        found.resize(columns.size());
+    }
+
+    column_extractor(const column_extractor&) = delete;
+    void operator=(const column_extractor&) = delete;
+
+    size_t get_column_count() const { return columns.size(); }
+
+    /// Returns the column for the index'th spec passed to the constructor.
+    const column& get_column(size_t index) const { return columns[index]; }
+
+    /// Returns the number of rows in every column.
+    size_t get_row_count() const { return row_count; }
+
+    /// Appends a row from a record parsed by the caller.  Returns false, and
+    /// appends nothing, only if a string column's data would exceed 2 GiB,
+    /// the limit of Arrow's int32 offsets.
+    bool append_record(const value& record) {
+        if (record.get_type() == TYPE_OBJECT) {
+            record.get_values_of_keys(
+                sorted_keys.data(), sorted_keys.size(), found.data());
+        } else {
+            std::fill(found.begin(), found.end(), value());
+        }
+        for (size_t k = 0; k < order.size(); ++k) {
+            if (!columns[order[k]].has_room_for(found[k])) {
+                return false;
+            }
+        }
+        for (size_t k = 0; k < order.size(); ++k) {
+            columns[order[k]].append(found[k]);
+        }
+        ++row_count;
+        return true;
+    }
+
+    /**
+     * Appends a row for each record of newline-delimited JSON.  Lines may
+     * end in "\r\n", and blank lines are skipped.  Each line is copied into
+     * a buffer the extractor reuses, so ndjson is left untouched.
+     *
+     * Returns true if every record parsed.  Otherwise, stops at the first
+     * record that did not, keeping the rows before it; get_error_record()
+     * returns its zero-based line number in ndjson, and
+     * get_error_message_as_string() describes the failure.
+     */
+    bool append_records(const string& ndjson) {
+        return append_lines(ndjson.data(), ndjson.length(), true);
+    }
+
+    /// Like append_records(const string&), but parses each line in place,
+    /// without copying it, which overwrites ndjson.
+    bool append_records(const mutable_string_view& ndjson) {
+        return append_lines(ndjson.get_data(), ndjson.length(), false);
+    }
+
+    /// Empties every column, keeping the memory of the columns and of the
+    /// parser for the next batch.
+    void clear() {
+        for (column& c : columns) {
+            c.clear();
+        }
+        row_count = 0;
+        error_record = 0;
+        error_code = ERROR_NO_ERROR;
+        error_message.clear();
+    }
+
+    /// If append_records() failed, returns the zero-based line number of the
+    /// record that failed.
+    size_t get_error_record() const { return error_record; }
+
+    /// If append_records() failed, returns why.
+    error get_error_code() const { return error_code; }
+
+    /// If append_records() failed, returns a message describing why,
+    /// formatted like document::get_error_message_as_string().
+    const std::string& get_error_message_as_string() const {
+        return error_message;
+    }
+
+private:
+    bool append_lines(const char* data, size_t length, bool copy) {
+        const char* const end = data + length;
+        size_t line_number = 0;
+        for (const char* line = data; line < end; ++line_number) {
+            const char* newline = static_cast<const char*>(
+                memchr(line, '\n', end - line));
+            if (!newline) {
+                newline = end;
+            }
+            size_t line_length = newline - line;
+            if (line_length && line[line_length - 1] == '\r') {
+                --line_length;
+            }
+            if (line_length
+                && !append_line(line, line_length, line_number, copy)) {
+                return false;
+            }
+            line = newline + 1;
+        }
+        return true;
+    }
+
+    bool append_line(
+        const char* line, size_t length, size_t line_number, bool copy) {
+        char* text = const_cast<char*>(line);
+        if (copy) {
+            if (record.size() < length) {
+                record.resize(length);
+            }
+            memcpy(record.data(), line, length);
+            text = record.data();
+        }
+        // Grow the AST buffer to the longest record seen; single_allocation
+        // then never allocates.
+        if (ast.size() < length) {
+            ast.resize(length);
+        }
+        const document d = parse(
+            single_allocation(ast.data(), ast.size()),
+            mutable_string_view(length, text));
+        if (!d.is_valid()) {
+            if (d._internal_get_error_code() == ERROR_MISSING_ROOT_ELEMENT) {
+                // The line is all whitespace.
+                return true;
+            }
+            return fail(
+                line_number,
+                d._internal_get_error_code(),
+                d.get_error_message_as_string());
+        }
+        if (!append_record(d.get_root())) {
+            return fail(
+                line_number,
+                ERROR_OUT_OF_MEMORY,
+                internal::get_error_text(ERROR_OUT_OF_MEMORY));
+        }
+        return true;
+    }
+
+    bool fail(size_t line_number, error code, const std::string& message) {
+        error_record = line_number;
+        error_code = code;
+        error_message = message;
+        return false;
+    }
+
+    std::vector<column> columns;
+    // columns[order[k]] is the column of sorted_keys[k].
+    std::vector<size_t> order;
+    std::vector<string> sorted_keys;
+    std::vector<value> found;
+    std::vector<char> record;
+    std::vector<size_t> ast;
+    size_t row_count;
+    size_t error_record;
+    error error_code;
+    std::string error_message;
+};
+
+} // namespace sajson
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "sajson.h"
+
+#ifdef SAJSON_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SAJSON_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/**
+ * Parsing of gzip-, zlib-, and zstd-compressed JSON.
+ *
+ * These are convenience wrappers: the whole input is decompressed into a
+ * buffer that the resulting \ref document owns, and that buffer is then
+ * parsed in place.  Decompression finishes before parsing starts, so this
+ * saves writing the decompression loop and sizing its buffer, not time.
+ *
+ * Each format is only available if the corresponding library was found at
+ * build time: define SAJSON_HAVE_ZLIB and/or SAJSON_HAVE_ZSTD and link
+ * against -lz and/or -lzstd.
+ */
+namespace sajson {
+
+namespace internal {
+// Returns a buffer of new_capacity bytes holding the first used bytes of old.
+inline allocated_buffer grow_buffer(
+    const allocated_buffer& old, size_t used, size_t new_capacity) {
+    allocated_buffer rv(new_capacity);
+    memcpy(rv.get_data(), old.get_data(), used);
+    return rv;
+}
+
+inline size_t initial_decompression_capacity(size_t compressed_length) {
+    // JSON usually compresses between 4x and 10x.
+    return compressed_length < 64 ? 256 : compressed_length * 4;
+}
+
+// Decompressed lengths recorded in the input are attacker-controlled, so they
+// only choose the initial capacity, and never more than deflate's maximum
+// ratio (about 1032:1) allows.  The buffer still grows if the output turns
+// out to be larger.  The result is at least 1 and leaves room for one more.
+inline size_t clamp_size_hint(size_t hint, size_t compressed_length) {
+    const size_t max_ratio = 1024;
+    const size_t max_length = std::numeric_limits<size_t>::max() / max_ratio;
+    const size_t limit = max_ratio
+        * (compressed_length < max_length ? compressed_length + 1
+                                          : max_length);
+    return hint < 1 ? 1 : hint > limit ? limit : hint;
+}
+
+// Doubles capacity, or returns false if that would overflow.
+inline bool grow_capacity(size_t* capacity) {
+    if (*capacity > std::numeric_limits<size_t>::max() / 2) {
+        return false;
+    }
+    *capacity *= 2;
+    return true;
+}
+} // namespace internal
+
+#ifdef SAJSON_HAVE_ZLIB
+
+namespace internal {
+class inflate_stream {
+public:
+    inflate_stream() {
+        memset(&stream, 0, sizeof(stream));
+        // 15 window bits, +32 to detect gzip or zlib headers automatically.
+        initialized = inflateInit2(&stream, 15 + 32) == Z_OK;
+    }
+
+    ~inflate_stream() {
+        if (initialized) {
+            inflateEnd(&stream);
+        }
+    }
+
+    z_stream stream;
+    bool initialized;
+
+private:
+    inflate_stream(const inflate_stream&) = delete;
+    void operator=(const inflate_stream&) = delete;
+};
+
+// A single-member gzip stream ends with ISIZE, the uncompressed length modulo
+// 2^32.  zlib streams do not record their uncompressed length.
+inline size_t gzip_size_hint(const string& compressed) {
+    const unsigned char* p
+        = reinterpret_cast<const unsigned char*>(compressed.data());
+    const size_t n = compressed.length();
+    if (n >= 18 && p[0] == 0x1f && p[1] == 0x8b) {
+        return clamp_size_hint(
+            static_cast<size_t>(p[n - 4])
+                | (static_cast<size_t>(p[n - 3]) << 8)
+                | (static_cast<size_t>(p[n - 2]) << 16)
+                | (static_cast<size_t>(p[n - 1]) << 24),
+            n);
+    }
+    return initial_decompression_capacity(n);
+}
+
+inline bool inflate_into(
+    const string& compressed, allocated_buffer& buffer, size_t* length) {
+    inflate_stream z;
+    if (!z.initialized) {
+        return false;
+    }
+
+    // One spare byte lets inflate report the end of the stream without a
+    // reallocation when the size hint is exact.
+    size_t capacity = gzip_size_hint(compressed) + 1;
+    buffer = allocated_buffer(capacity);
+    size_t used = 0;
+
+    const unsigned char* input
+        = reinterpret_cast<const unsigned char*>(compressed.data());
+    size_t remaining = compressed.length();
+    const size_t max_chunk = std::numeric_limits<uInt>::max();
+
+    for (;;) {
+        if (z.stream.avail_in == 0 && remaining) {
+            uInt chunk = static_cast<uInt>(std::min(remaining, max_chunk));
+            z.stream.next_in = const_cast<Bytef*>(input);
+            z.stream.avail_in = chunk;
+            input += chunk;
+            remaining -= chunk;
+        }
+        if (used == capacity) {
+            if (!grow_capacity(&capacity)) {
+                return false;
+            }
+            buffer = grow_buffer(buffer, used, capacity);
+        }
+
+        uInt space = static_cast<uInt>(std::min(capacity - used, max_chunk));
+        z.stream.next_out = reinterpret_cast<Bytef*>(buffer.get_data() + used);
+        z.stream.avail_out = space;
+        int rv = inflate(&z.stream, Z_NO_FLUSH);
+        used += space - z.stream.avail_out;
+
+        if (rv == Z_STREAM_END) {
+            if (z.stream.avail_in == 0 && !remaining) {
+                break;
+            }
+            // Concatenated gzip members decompress to their concatenation.
+            if (inflateReset(&z.stream) != Z_OK) {
+                return false;
+            }
+        } else if (rv == Z_BUF_ERROR) {
+            // No progress was possible: either the output buffer is full,
+            // which is handled above, or the input is truncated.
+            if (z.stream.avail_out != 0) {
+                return false;
+            }
+        } else if (rv != Z_OK) {
+            return false;
+        }
+    }
+
+    *length = used;
+    return true;
+}
+} // namespace internal
+
+/**
+ * Decompresses a gzip or zlib stream and parses the result into a
+ * \ref document, given an allocation strategy instance.  The compressed
+ * input is not modified.
+ *
+ * If the stream is malformed or truncated, the returned document has the
+ * error ERROR_DECOMPRESSION_FAILED.  Throws std::bad_alloc if the
+ * decompressed text cannot be allocated.
+ */
+template <typename AllocationStrategy>
+document
+parse_gzip(const AllocationStrategy& strategy, const string& compressed) {
+    internal::allocated_buffer buffer;
+    size_t length = 0;
+    if (!internal::inflate_into(compressed, buffer, &length)) {
+        return document::_internal_make_error(
+            mutable_string_view(), ERROR_DECOMPRESSION_FAILED);
+    }
+    return parse(strategy, mutable_string_view(length, buffer));
+}
+
+#endif // SAJSON_HAVE_ZLIB
+
+#ifdef SAJSON_HAVE_ZSTD
+
+namespace internal {
+class zstd_stream {
+public:
+    zstd_stream()
+        : context(ZSTD_createDCtx()) {}
+
+    ~zstd_stream() { ZSTD_freeDCtx(context); }
+
+    ZSTD_DCtx* const context;
+
+private:
+    zstd_stream(const zstd_stream&) = delete;
+    void operator=(const zstd_stream&) = delete;
+};
+
+// The frame header usually records the exact decompressed size, in which case
+// the buffer is allocated once and never grows.  Returns false if the input
+// does not start with a zstd frame.
+inline bool zstd_size_hint(const string& compressed, size_t* hint) {
+    const unsigned long long content_size
+        = ZSTD_getFrameContentSize(compressed.data(), compressed.length());
+    if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+        return false;
+    } else if (content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+        *hint = initial_decompression_capacity(compressed.length());
+    } else {
+        const size_t max_size = std::numeric_limits<size_t>::max();
+        *hint = clamp_size_hint(
+            content_size > max_size ? max_size
+                                    : static_cast<size_t>(content_size),
+            compressed.length());
+    }
+    return true;
+}
+
+inline bool zstd_decompress_into(
+    const string& compressed, allocated_buffer& buffer, size_t* length) {
+    zstd_stream z;
+    if (!z.context) {
+        return false;
+    }
+
+    size_t capacity;
+    if (!zstd_size_hint(compressed, &capacity)) {
+        return false;
+    }
+    buffer = allocated_buffer(capacity);
+    size_t used = 0;
+
+    ZSTD_inBuffer in = { compressed.data(), compressed.length(), 0 };
+    for (;;) {
+        if (used == capacity) {
+            if (!grow_capacity(&capacity)) {
+                return false;
+            }
+            buffer = grow_buffer(buffer, used, capacity);
+        }
+
+        ZSTD_outBuffer out = { buffer.get_data() + used, capacity - used, 0 };
+        size_t rv = ZSTD_decompressStream(z.context, &out, &in);
+        used += out.pos;
+        if (ZSTD_isError(rv)) {
+            return false;
+        }
+        if (in.pos == in.size) {
+            if (rv == 0) {
+                break;
+            }
+            // The frame is incomplete but there is no input left and the
+            // decoder did not fill the output buffer: truncated input.
+            if (out.pos < out.size) {
+                return false;
+            }
+        }
+    }
+
+    *length = used;
+    return true;
+}
+} // namespace internal
+
+/**
+ * Decompresses one or more zstd frames and parses the result into a
+ * \ref document, given an allocation strategy instance.  The compressed
+ * input is not modified.
+ *
+ * If the input is malformed or truncated, the returned document has the
+ * error ERROR_DECOMPRESSION_FAILED.  Throws std::bad_alloc if the
+ * decompressed text cannot be allocated.
+ */
+template <typename AllocationStrategy>
+document
+parse_zstd(const AllocationStrategy& strategy, const string& compressed) {
+    internal::allocated_buffer buffer;
+    size_t length = 0;
+    if (!internal::zstd_decompress_into(compressed, buffer, &length)) {
+        return document::_internal_make_error(
+            mutable_string_view(), ERROR_DECOMPRESSION_FAILED);
+    }
+    return parse(strategy, mutable_string_view(length, buffer));
+}
+
+#endif // SAJSON_HAVE_ZSTD
+
+} // namespace sajson
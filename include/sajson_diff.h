@@ -0,0 +1,209 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Structural differences between two parsed documents.
+ *
+ * diff() walks both ASTs together.  Objects are merge-joined over their
+ * sorted keys, so each level costs one pass over the members of both sides,
+ * and arrays are compared index by index.  When both documents were parsed
+ * by \ref parse_with_source_ranges and their texts are supplied, a subtree
+ * whose bytes are identical on both sides is skipped with one memcmp
+ * instead of being walked.
+ */
+namespace sajson {
+
+/// How a value differs between the two documents.
+enum diff_kind {
+    /// The path exists only in the second document.
+    DIFF_ADDED,
+    /// The path exists only in the first document.
+    DIFF_REMOVED,
+    /// The path exists in both, with a different scalar or a different
+    /// type.  Arrays and objects that differ only within are not reported;
+    /// their differing descendants are.
+    DIFF_CHANGED,
+};
+
+/// One difference found by diff().
+struct difference {
+    diff_kind kind;
+    /// A JSON Pointer (RFC 6901) to the value.
+    std::string path;
+    /// The value in the first document, or null for DIFF_ADDED.
+    value before;
+    /// The value in the second document, or null for DIFF_REMOVED.
+    value after;
+};
+
+namespace internal {
+
+class differ {
+public:
+    differ(
+        const char* a_source_,
+        const char* b_source_,
+        std::vector<difference>& out_)
+        : a_source(a_source_)
+        , b_source(b_source_)
+        , out(out_) {}
+
+    void compare(const value& a, const value& b) {
+        const type ta = a.get_type();
+        const type tb = b.get_type();
+        if (ta == TYPE_ARRAY && tb == TYPE_ARRAY) {
+            if (!same_source(a, b)) {
+                compare_arrays(a, b);
+            }
+        } else if (ta == TYPE_OBJECT && tb == TYPE_OBJECT) {
+            if (!same_source(a, b)) {
+                compare_objects(a, b);
+            }
+        } else if (!a.equals(b)) {
+            report(DIFF_CHANGED, a, b);
+        }
+    }
+
+private:
+    // Returns true if both values were parsed from identical bytes.
+    bool same_source(const value& a, const value& b) const {
+        if (!a_source || !b_source) {
+            return false;
+        }
+        const size_t length = a.get_source_end() - a.get_source_start();
+        return length == b.get_source_end() - b.get_source_start()
+            && memcmp(a_source + a.get_source_start(),
+                      b_source + b.get_source_start(),
+                      length)
+            == 0;
+    }
+
+    void compare_arrays(const value& a, const value& b) {
+        const size_t a_length = a.get_length();
+        const size_t b_length = b.get_length();
+        const size_t common = a_length < b_length ? a_length : b_length;
+        for (size_t i = 0; i < common; ++i) {
+            const size_t mark = push_index(i);
+            compare(a.get_array_element(i), b.get_array_element(i));
+            path.resize(mark);
+        }
+        for (size_t i = common; i < a_length; ++i) {
+            const size_t mark = push_index(i);
+            report(DIFF_REMOVED, a.get_array_element(i), value());
+            path.resize(mark);
+        }
+        for (size_t i = common; i < b_length; ++i) {
+            const size_t mark = push_index(i);
+            report(DIFF_ADDED, value(), b.get_array_element(i));
+            path.resize(mark);
+        }
+    }
+
+    void compare_objects(const value& a, const value& b) {
+        const size_t a_length = a.get_length();
+        const size_t b_length = b.get_length();
+        // One merge pass over both key lists pairs the members up.  Unsorted
+        // objects are walked in stable key order, so duplicate keys pair up
+        // in the order they were written.
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+        const members_by_key a_order(a);
+        const members_by_key b_order(b);
+#endif
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a_length || j < b_length) {
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+            const size_t ai = i == a_length ? i : a_order[i];
+            const size_t bj = j == b_length ? j : b_order[j];
+#else
+            const size_t ai = i;
+            const size_t bj = j;
+#endif
+            int c;
+            if (i == a_length) {
+                c = 1;
+            } else if (j == b_length) {
+                c = -1;
+            } else {
+                c = compare_keys(a.get_object_key(ai), b.get_object_key(bj));
+            }
+            if (c < 0) {
+                const size_t mark = push_key(a.get_object_key(ai));
+                report(DIFF_REMOVED, a.get_object_value(ai), value());
+                path.resize(mark);
+                ++i;
+            } else if (c > 0) {
+                const size_t mark = push_key(b.get_object_key(bj));
+                report(DIFF_ADDED, value(), b.get_object_value(bj));
+                path.resize(mark);
+                ++j;
+            } else {
+                const size_t mark = push_key(a.get_object_key(ai));
+                compare(a.get_object_value(ai), b.get_object_value(bj));
+                path.resize(mark);
+                ++i;
+                ++j;
+            }
+        }
+    }
+
+    // Appends a reference token to path and returns the length to restore.
+    size_t push_key(const string& key) {
+        const size_t mark = path.size();
+        append_pointer_token(path, key);
+        return mark;
+    }
+
+    size_t push_index(size_t index) {
+        const size_t mark = path.size();
+        char buffer[32];
+        SAJSON_snprintf(buffer, sizeof(buffer), "/%zu", index);
+        path += buffer;
+        return mark;
+    }
+
+    void report(diff_kind kind, const value& before, const value& after) {
+        difference d;
+        d.kind = kind;
+        d.path = path;
+        d.before = before;
+        d.after = after;
+        out.push_back(d);
+    }
+
+    const char* a_source;
+    const char* b_source;
+    std::vector<difference>& out;
+    std::string path;
+};
+} // namespace internal
+
+/// Returns the differences between a and b, in the order a walk over both
+/// meets them.  Numbers compare by value, so 1 and 1.0 are the same.  The
+/// returned values refer into both documents, which must outlive them.
+inline std::vector<difference> diff(const value& a, const value& b) {
+    std::vector<difference> differences;
+    internal::differ(0, 0, differences).compare(a, b);
+    return differences;
+}
+
+/// Like diff(a, b), but skips subtrees whose source bytes are identical.
+/// a and b must come from \ref parse_with_source_ranges over a_source and
+/// b_source, which must be the original, unmodified texts.
+inline std::vector<difference> diff(
+    const value& a,
+    const string& a_source,
+    const value& b,
+    const string& b_source) {
+    assert(a.has_source_range() && b.has_source_range());
+    std::vector<difference> differences;
+    internal::differ(a_source.data(), b_source.data(), differences)
+        .compare(a, b);
+    return differences;
+}
+
+} // namespace sajson
@@ -0,0 +1,702 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+/**
+ * A compiled subset of JSONPath for querying parsed documents.
+ *
+ * Supported syntax, after the leading $:
+ *
+ *     .name  ['name']  ["name"]   child member
+ *     .*  [*]                     every member or element
+ *     ..name  ..*  ..[...]        recursive descent
+ *     [3]  [-1]                   array index, negative counts from the end
+ *     [start:end:step]            array slice, each part optional
+ *     [?(@.a.b == 'x')]           filter on members or elements
+ *
+ * A filter compares a relative path (@ followed by .name, ['name'], or [n]
+ * steps) against a string, number, true, false, or null literal with ==,
+ * !=, <, <=, >, or >=.  A filter with no operator, such as [?(@.id)], keeps
+ * the candidates for which the relative path exists.  The parentheses are
+ * optional.
+ */
+namespace sajson {
+
+namespace internal {
+struct jsonpath_step {
+    enum kind_t { child, wildcard, index, slice, filter };
+
+    kind_t kind;
+    // Set for steps that follow "..".
+    bool recursive;
+    // child: the decoded key, stored in jsonpath::keys.
+    size_t key_offset;
+    size_t key_length;
+    // index: the index.  slice: start and end, if has_start and has_end.
+    long long start;
+    long long end;
+    long long step;
+    bool has_start;
+    bool has_end;
+    // filter: index into jsonpath::filters.
+    size_t filter_index;
+};
+
+struct jsonpath_filter {
+    enum op_t { exists, eq, ne, lt, le, gt, ge };
+
+    // The relative path's child and index steps, as a range of
+    // jsonpath::relative_steps.
+    size_t steps_begin;
+    size_t steps_end;
+    op_t op;
+    // The literal's type; TYPE_INTEGER is used for every number.
+    type literal_type;
+    double number;
+    size_t key_offset;
+    size_t key_length;
+};
+} // namespace internal
+
+/**
+ * A compiled JSONPath query.  Compiling parses the expression once into a
+ * plan of steps; evaluating walks the AST directly, uses the sorted-key
+ * binary search of value::find_object_key() for child steps, and reports
+ * matches as \ref value handles into the document, so no JSON is copied.
+ */
+class jsonpath {
+public:
+    /// Compiles the given expression.  Check is_valid() before evaluating.
+    explicit jsonpath(const string& text)
+        : error_offset(no_error) {
+        compiler c(*this, text.data(), text.data() + text.length());
+        if (!c.compile()) {
+            error_offset = c.offset();
+        }
+    }
+
+    /// Returns true if the expression compiled successfully.
+    bool is_valid() const { return error_offset == no_error; }
+
+    /// If the expression was not valid, returns the byte offset at which
+    /// compilation failed.
+    size_t get_error_offset() const { return error_offset; }
+
+    /// Calls fn(value) for each match, in document order.  Objects are
+    /// visited in the order sajson stores their members.  Does nothing if
+    /// the expression is invalid.  Does not allocate.
+    template <typename Function>
+    void for_each_match(const value& root, Function&& fn) const {
+        if (is_valid()) {
+            apply(0, root, fn);
+        }
+    }
+
+    /// Replaces the contents of *out with every match, in document order.
+    void evaluate(const value& root, std::vector<value>* out) const {
+        out->clear();
+        for_each_match(root, [out](const value& v) { out->push_back(v); });
+    }
+
+private:
+    typedef internal::jsonpath_step step_t;
+    typedef internal::jsonpath_filter filter_t;
+
+    static const size_t no_error = static_cast<size_t>(-1);
+
+    template <typename Function>
+    void apply(size_t i, const value& v, Function& fn) const {
+        if (i == steps.size()) {
+            fn(v);
+        } else if (steps[i].recursive) {
+            descend(i, v, fn);
+        } else {
+            select(i, v, fn);
+        }
+    }
+
+    // Applies step i to v and then to each of v's descendants, in order.
+    template <typename Function>
+    void descend(size_t i, const value& v, Function& fn) const {
+        select(i, v, fn);
+        switch (v.get_type()) {
+        case TYPE_ARRAY:
+            for (const value& element : v.elements()) {
+                descend(i, element, fn);
+            }
+            break;
+        case TYPE_OBJECT:
+            for (auto it = v.members().begin(); it != v.members().end();
+                 ++it) {
+                descend(i, it.get_value(), fn);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Applies step i to v alone and continues with step i + 1 on each
+    // selected child.
+    template <typename Function>
+    void select(size_t i, const value& v, Function& fn) const {
+        const step_t& s = steps[i];
+        const type t = v.get_type();
+        if (t != TYPE_ARRAY && t != TYPE_OBJECT) {
+            return;
+        }
+        switch (s.kind) {
+        case step_t::child:
+            if (t == TYPE_OBJECT) {
+                size_t k = v.find_object_key(key(s.key_offset, s.key_length));
+                if (k != v.get_length()) {
+                    apply(i + 1, v.get_object_value(k), fn);
+                }
+            }
+            break;
+
+        case step_t::wildcard:
+        case step_t::filter:
+            if (t == TYPE_ARRAY) {
+                for (const value& element : v.elements()) {
+                    if (s.kind == step_t::wildcard || matches(s, element)) {
+                        apply(i + 1, element, fn);
+                    }
+                }
+            } else {
+                for (auto it = v.members().begin(); it != v.members().end();
+                     ++it) {
+                    if (s.kind == step_t::wildcard
+                        || matches(s, it.get_value())) {
+                        apply(i + 1, it.get_value(), fn);
+                    }
+                }
+            }
+            break;
+
+        case step_t::index:
+            if (t == TYPE_ARRAY) {
+                const long long length = v.get_length();
+                const long long index = normalize(s.start, length);
+                if (index >= 0 && index < length) {
+                    apply(i + 1, v.get_array_element(index), fn);
+                }
+            }
+            break;
+
+        case step_t::slice:
+            if (t == TYPE_ARRAY) {
+                slice(i, s, v, fn);
+            }
+            break;
+        }
+    }
+
+    // Python slice semantics, as in RFC 9535 section 2.3.4.  The step can be
+    // as large as the integer syntax allows, so each advance checks the
+    // distance to the bound instead of overflowing k.
+    template <typename Function>
+    void slice(size_t i, const step_t& s, const value& v, Function& fn)
+        const {
+        const long long length = v.get_length();
+        if (s.step > 0) {
+            long long lower = s.has_start
+                ? clamp(normalize(s.start, length), 0, length)
+                : 0;
+            long long upper = s.has_end
+                ? clamp(normalize(s.end, length), 0, length)
+                : length;
+            for (long long k = lower; k < upper; k += s.step) {
+                apply(i + 1, v.get_array_element(k), fn);
+                if (s.step >= upper - k) {
+                    break;
+                }
+            }
+        } else if (s.step < 0) {
+            long long upper = s.has_start
+                ? clamp(normalize(s.start, length), -1, length - 1)
+                : length - 1;
+            long long lower = s.has_end
+                ? clamp(normalize(s.end, length), -1, length - 1)
+                : -1;
+            for (long long k = upper; k > lower; k += s.step) {
+                apply(i + 1, v.get_array_element(k), fn);
+                if (s.step <= lower - k) {
+                    break;
+                }
+            }
+        }
+    }
+
+    static long long normalize(long long index, long long length) {
+        return index < 0 ? length + index : index;
+    }
+
+    static long long clamp(long long x, long long lo, long long hi) {
+        return x < lo ? lo : x > hi ? hi : x;
+    }
+
+    bool matches(const step_t& s, const value& candidate) const {
+        const filter_t& f = filters[s.filter_index];
+        value v = candidate;
+        for (size_t r = f.steps_begin; r != f.steps_end; ++r) {
+            const step_t& rs = relative_steps[r];
+            const type t = v.get_type();
+            if (rs.kind == step_t::child && t == TYPE_OBJECT) {
+                size_t k
+                    = v.find_object_key(key(rs.key_offset, rs.key_length));
+                if (k == v.get_length()) {
+                    return false;
+                }
+                v = v.get_object_value(k);
+            } else if (rs.kind == step_t::index && t == TYPE_ARRAY) {
+                const long long length = v.get_length();
+                const long long index = normalize(rs.start, length);
+                if (index < 0 || index >= length) {
+                    return false;
+                }
+                v = v.get_array_element(index);
+            } else {
+                return false;
+            }
+        }
+
+        switch (f.op) {
+        case filter_t::exists:
+            return true;
+        case filter_t::eq:
+            return equals_literal(f, v);
+        case filter_t::ne:
+            return !equals_literal(f, v);
+        default:
+            break;
+        }
+
+        // Ordering comparisons only hold between numbers or strings.
+        int order;
+        const type t = v.get_type();
+        if (f.literal_type == TYPE_INTEGER
+            && (t == TYPE_INTEGER || t == TYPE_DOUBLE)) {
+            const double d = v.get_number_value();
+            order = d < f.number ? -1 : d > f.number ? 1 : 0;
+        } else if (f.literal_type == TYPE_STRING && t == TYPE_STRING) {
+            order = compare_strings(v, f);
+        } else {
+            return false;
+        }
+        switch (f.op) {
+        case filter_t::lt:
+            return order < 0;
+        case filter_t::le:
+            return order <= 0;
+        case filter_t::gt:
+            return order > 0;
+        default:
+            return order >= 0;
+        }
+    }
+
+    bool equals_literal(const filter_t& f, const value& v) const {
+        const type t = v.get_type();
+        switch (f.literal_type) {
+        case TYPE_INTEGER:
+            return (t == TYPE_INTEGER || t == TYPE_DOUBLE)
+                && v.get_number_value() == f.number;
+        case TYPE_STRING:
+            return t == TYPE_STRING && compare_strings(v, f) == 0;
+        default:
+            return t == f.literal_type;
+        }
+    }
+
+    int compare_strings(const value& v, const filter_t& f) const {
+        const size_t length = v.get_string_length();
+        const size_t common = length < f.key_length ? length : f.key_length;
+        int rv = memcmp(v.as_cstring(), keys.data() + f.key_offset, common);
+        if (rv) {
+            return rv;
+        }
+        return length < f.key_length ? -1 : length > f.key_length ? 1 : 0;
+    }
+
+    string key(size_t offset, size_t length) const {
+        return string(keys.data() + offset, length);
+    }
+
+    class compiler {
+    public:
+        compiler(jsonpath& path_, const char* begin_, const char* end_)
+            : path(path_)
+            , begin(begin_)
+            , p(begin_)
+            , end(end_) {}
+
+        size_t offset() const { return p - begin; }
+
+        bool compile() {
+            skip_whitespace();
+            if (!consume('$')) {
+                return false;
+            }
+            while (p != end) {
+                step_t s = make_step();
+                if (consume('.')) {
+                    if (consume('.')) {
+                        s.recursive = true;
+                        if (p != end && *p == '[') {
+                            if (!bracket(s)) {
+                                return false;
+                            }
+                            path.steps.push_back(s);
+                            continue;
+                        }
+                    }
+                    if (consume('*')) {
+                        s.kind = step_t::wildcard;
+                    } else if (!name(s)) {
+                        return false;
+                    }
+                } else if (*p == '[') {
+                    if (!bracket(s)) {
+                        return false;
+                    }
+                } else {
+                    skip_whitespace();
+                    if (p == end) {
+                        break;
+                    }
+                    return false;
+                }
+                path.steps.push_back(s);
+            }
+            return true;
+        }
+
+    private:
+        static step_t make_step() {
+            step_t s;
+            s.kind = step_t::child;
+            s.recursive = false;
+            s.key_offset = 0;
+            s.key_length = 0;
+            s.start = 0;
+            s.end = 0;
+            s.step = 1;
+            s.has_start = false;
+            s.has_end = false;
+            s.filter_index = 0;
+            return s;
+        }
+
+        bool consume(char c) {
+            if (p != end && *p == c) {
+                ++p;
+                return true;
+            }
+            return false;
+        }
+
+        void skip_whitespace() {
+            while (p != end
+                   && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+                ++p;
+            }
+        }
+
+        static bool is_name_char(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+                || (c >= '0' && c <= '9') || c == '_' || c == '-'
+                || static_cast<unsigned char>(c) >= 0x80;
+        }
+
+        // A dot-notation member name.
+        bool name(step_t& s) {
+            const char* start = p;
+            while (p != end && is_name_char(*p)) {
+                ++p;
+            }
+            if (p == start) {
+                return false;
+            }
+            s.kind = step_t::child;
+            s.key_offset = path.keys.size();
+            s.key_length = p - start;
+            path.keys.append(start, p);
+            return true;
+        }
+
+        // A single- or double-quoted string, appended to path.keys.
+        bool quoted(size_t* key_offset, size_t* key_length) {
+            const char quote = *p++;
+            *key_offset = path.keys.size();
+            for (;;) {
+                if (p == end) {
+                    return false;
+                }
+                char c = *p++;
+                if (c == quote) {
+                    break;
+                }
+                if (c == '\\') {
+                    if (p == end) {
+                        return false;
+                    }
+                    switch (*p++) {
+                    case '\\':
+                        c = '\\';
+                        break;
+                    case '/':
+                        c = '/';
+                        break;
+                    case '\'':
+                        c = '\'';
+                        break;
+                    case '"':
+                        c = '"';
+                        break;
+                    case 'b':
+                        c = '\b';
+                        break;
+                    case 'f':
+                        c = '\f';
+                        break;
+                    case 'n':
+                        c = '\n';
+                        break;
+                    case 'r':
+                        c = '\r';
+                        break;
+                    case 't':
+                        c = '\t';
+                        break;
+                    default:
+                        --p;
+                        return false;
+                    }
+                }
+                path.keys.push_back(c);
+            }
+            *key_length = path.keys.size() - *key_offset;
+            return true;
+        }
+
+        bool integer(long long* out) {
+            bool negative = consume('-');
+            if (p == end || *p < '0' || *p > '9') {
+                return false;
+            }
+            long long value = 0;
+            while (p != end && *p >= '0' && *p <= '9') {
+                if (value > (0x7fffffffffffffffLL - 9) / 10) {
+                    return false;
+                }
+                value = value * 10 + (*p++ - '0');
+            }
+            *out = negative ? -value : value;
+            return true;
+        }
+
+        bool is_integer_start() const {
+            return p != end && ((*p >= '0' && *p <= '9') || *p == '-');
+        }
+
+        bool bracket(step_t& s) {
+            ++p;
+            skip_whitespace();
+            if (p == end) {
+                return false;
+            }
+            if (*p == '\'' || *p == '"') {
+                s.kind = step_t::child;
+                if (!quoted(&s.key_offset, &s.key_length)) {
+                    return false;
+                }
+            } else if (consume('*')) {
+                s.kind = step_t::wildcard;
+            } else if (consume('?')) {
+                s.kind = step_t::filter;
+                s.filter_index = path.filters.size();
+                if (!filter()) {
+                    return false;
+                }
+            } else {
+                if (is_integer_start()) {
+                    if (!integer(&s.start)) {
+                        return false;
+                    }
+                    s.has_start = true;
+                }
+                skip_whitespace();
+                if (consume(':')) {
+                    s.kind = step_t::slice;
+                    skip_whitespace();
+                    if (is_integer_start()) {
+                        if (!integer(&s.end)) {
+                            return false;
+                        }
+                        s.has_end = true;
+                    }
+                    skip_whitespace();
+                    if (consume(':')) {
+                        skip_whitespace();
+                        if (is_integer_start() && !integer(&s.step)) {
+                            return false;
+                        }
+                    }
+                } else if (s.has_start) {
+                    s.kind = step_t::index;
+                } else {
+                    return false;
+                }
+            }
+            skip_whitespace();
+            return consume(']');
+        }
+
+        bool filter() {
+            skip_whitespace();
+            const bool parenthesized = consume('(');
+            skip_whitespace();
+            if (!consume('@')) {
+                return false;
+            }
+
+            filter_t f;
+            f.steps_begin = path.relative_steps.size();
+            f.op = filter_t::exists;
+            f.literal_type = TYPE_NULL;
+            f.number = 0;
+            f.key_offset = 0;
+            f.key_length = 0;
+            for (;;) {
+                step_t s = make_step();
+                if (consume('.')) {
+                    if (!name(s)) {
+                        return false;
+                    }
+                } else if (p != end && *p == '[') {
+                    if (!bracket(s)) {
+                        return false;
+                    }
+                    if (s.kind != step_t::child && s.kind != step_t::index) {
+                        return false;
+                    }
+                } else {
+                    break;
+                }
+                path.relative_steps.push_back(s);
+            }
+            f.steps_end = path.relative_steps.size();
+
+            skip_whitespace();
+            if (operation(&f.op) && !literal(f)) {
+                return false;
+            }
+            skip_whitespace();
+            if (parenthesized && !consume(')')) {
+                return false;
+            }
+            path.filters.push_back(f);
+            return true;
+        }
+
+        bool operation(filter_t::op_t* op) {
+            if (end - p < 1) {
+                return false;
+            }
+            const bool equals_follows = end - p >= 2 && p[1] == '=';
+            switch (*p) {
+            case '=':
+                if (!equals_follows) {
+                    return false;
+                }
+                *op = filter_t::eq;
+                break;
+            case '!':
+                if (!equals_follows) {
+                    return false;
+                }
+                *op = filter_t::ne;
+                break;
+            case '<':
+                *op = equals_follows ? filter_t::le : filter_t::lt;
+                break;
+            case '>':
+                *op = equals_follows ? filter_t::ge : filter_t::gt;
+                break;
+            default:
+                return false;
+            }
+            p += equals_follows ? 2 : 1;
+            return true;
+        }
+
+        bool keyword(const char* word) {
+            const size_t length = strlen(word);
+            if (static_cast<size_t>(end - p) >= length
+                && memcmp(p, word, length) == 0) {
+                p += length;
+                return true;
+            }
+            return false;
+        }
+
+        bool literal(filter_t& f) {
+            skip_whitespace();
+            if (p == end) {
+                return false;
+            }
+            if (*p == '\'' || *p == '"') {
+                f.literal_type = TYPE_STRING;
+                return quoted(&f.key_offset, &f.key_length);
+            }
+            if (keyword("true")) {
+                f.literal_type = TYPE_TRUE;
+                return true;
+            }
+            if (keyword("false")) {
+                f.literal_type = TYPE_FALSE;
+                return true;
+            }
+            if (keyword("null")) {
+                f.literal_type = TYPE_NULL;
+                return true;
+            }
+
+            const char* start = p;
+            while (p != end
+                   && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+'
+                       || *p == '.' || *p == 'e' || *p == 'E')) {
+                ++p;
+            }
+            // strtod needs a NUL-terminated copy.
+            const std::string number(start, p);
+            char* number_end;
+            f.number = strtod(number.c_str(), &number_end);
+            if (number.empty() || *number_end) {
+                p = start;
+                return false;
+            }
+            f.literal_type = TYPE_INTEGER;
+            return true;
+        }
+
+        jsonpath& path;
+        const char* const begin;
+        const char* p;
+        const char* const end;
+    };
+
+    std::vector<step_t> steps;
+    std::vector<step_t> relative_steps;
+    std::vector<filter_t> filters;
+    // Decoded member names and string literals, concatenated.
+    std::string keys;
+    size_t error_offset;
+};
+
+} // namespace sajson
@@ -0,0 +1,678 @@
+#pragma once
+
+#include "sajson_parallel.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef SAJSON_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * Loading and parsing many files at once, with reads and parses overlapped.
+ *
+ * Each file is read straight into the buffer that its \ref document owns and
+ * parses in place, so no text is copied after it leaves the page cache.  On
+ * Linux, reads are issued in batches through io_uring if SAJSON_HAVE_IO_URING
+ * is defined and the kernel supports it; otherwise the parsing threads read
+ * their files with pread.
+ *
+ * POSIX only.  Requires linking with the platform's thread library
+ * (-pthread).
+ */
+namespace sajson {
+
+namespace internal {
+/// A fixed-capacity FIFO shared between producer and consumer threads.
+template <typename T>
+class bounded_queue {
+public:
+    explicit bounded_queue(size_t capacity_)
+        : capacity(capacity_ ? capacity_ : 1)
+        , closed(false) {}
+
+    /// Blocks while the queue is full.  Returns false, dropping item, if the
+    /// queue is closed.
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(
+            lock, [this] { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    /// Blocks while the queue is empty.  Returns false if the queue is
+    /// closed.
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (closed) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    /// Discards any queued items and makes every current and future push()
+    /// and pop() fail.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            items.clear();
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+    bool is_closed() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+
+private:
+    bounded_queue(const bounded_queue&) = delete;
+    void operator=(const bounded_queue&) = delete;
+
+    const size_t capacity;
+    mutable std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    std::deque<T> items;
+    bool closed;
+};
+
+// Returns true if parsing with strategy writes into a buffer the caller
+// provided, which copies of the strategy on several threads would share.
+template <typename AllocationStrategy>
+bool uses_caller_buffer(const AllocationStrategy&) {
+    return false;
+}
+
+inline bool uses_caller_buffer(const single_allocation& strategy) {
+    return strategy._internal_has_existing_buffer();
+}
+
+/// The raw bytes of one file, or why they could not be read.
+struct file_contents {
+    file_contents()
+        : index(0)
+        , error_number(0)
+        , length(0) {}
+
+    size_t index;
+    int error_number;
+    allocated_buffer buffer;
+    size_t length;
+};
+
+// Opens path and returns 0 and its descriptor and size, or an errno value.
+inline int open_for_reading(const char* path, int* fd, size_t* length) {
+    int rv;
+    do {
+        rv = open(path, O_RDONLY | O_CLOEXEC);
+    } while (rv < 0 && errno == EINTR);
+    if (rv < 0) {
+        return errno;
+    }
+    struct stat st;
+    if (fstat(rv, &st) != 0) {
+        int error_number = errno;
+        close(rv);
+        return error_number;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        close(rv);
+        return S_ISDIR(st.st_mode) ? EISDIR : EINVAL;
+    }
+    *fd = rv;
+    *length = static_cast<size_t>(st.st_size);
+    return 0;
+}
+
+// Reads a whole file with pread.  A file that shrinks after it is opened is
+// truncated to the bytes that remain.
+inline void read_file_contents(const char* path, file_contents& contents) {
+    int fd = -1;
+    size_t length = 0;
+    contents.error_number = open_for_reading(path, &fd, &length);
+    if (contents.error_number) {
+        return;
+    }
+    try {
+        contents.buffer = allocated_buffer(length);
+    } catch (const std::bad_alloc&) {
+        close(fd);
+        contents.error_number = ENOMEM;
+        return;
+    }
+    size_t offset = 0;
+    while (offset < length) {
+        ssize_t n = pread(
+            fd,
+            contents.buffer.get_data() + offset,
+            length - offset,
+            static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            contents.error_number = errno;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    close(fd);
+    contents.length = offset;
+}
+
+#ifdef SAJSON_HAVE_IO_URING
+
+// A minimal io_uring that only issues reads, driven with raw system calls so
+// liburing is not needed.  Not thread-safe: one thread submits and reaps.
+class io_uring_reader {
+public:
+    explicit io_uring_reader(unsigned entries)
+        : ring_fd(-1)
+        , sq_ring(MAP_FAILED)
+        , cq_ring(MAP_FAILED)
+        , sqes(MAP_FAILED)
+        , sq_ring_size(0)
+        , cq_ring_size(0)
+        , sqes_size(0)
+        , unsubmitted(0)
+        , in_flight(0)
+        , valid(false) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ring_fd
+            = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        // IORING_OP_READ arrived in Linux 5.6 along with this feature bit.
+        if (ring_fd < 0 || !(params.features & IORING_FEAT_RW_CUR_POS)) {
+            return;
+        }
+
+        sq_ring_size
+            = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size
+            = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+        sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+        cq_ring = single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = map(sqes_size, IORING_OFF_SQES);
+        if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED
+            || sqes == MAP_FAILED) {
+            return;
+        }
+
+        char* sq = static_cast<char*>(sq_ring);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries = params.sq_entries;
+        char* cq = static_cast<char*>(cq_ring);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        valid = true;
+    }
+
+    ~io_uring_reader() {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring != MAP_FAILED) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (ring_fd >= 0) {
+            close(ring_fd);
+        }
+    }
+
+    bool is_valid() const { return valid; }
+
+    /// Queues a read of length bytes at offset into buffer.  Returns false
+    /// if the submission ring is full.
+    bool queue_read(
+        int fd, char* buffer, unsigned length, size_t offset, size_t tag) {
+        const unsigned tail = *sq_tail;
+        if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+            return false;
+        }
+        const unsigned slot = tail & sq_mask;
+        io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes) + slot;
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+        sqe->len = length;
+        sqe->off = offset;
+        sqe->user_data = tag;
+        sq_array[slot] = slot;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted;
+        return true;
+    }
+
+    /// Submits queued reads and blocks until at least one has completed.
+    /// Returns 0 or an errno value.
+    int submit_and_wait() { return enter(unsubmitted); }
+
+    /// Blocks until every submitted read has completed, discarding the
+    /// results.  Reads that were queued but never submitted are dropped.
+    /// Returns 0, or an errno value if the ring failed first, in which case
+    /// the kernel may still write into the reads' buffers.
+    int drain() {
+        size_t tag;
+        int result;
+        for (;;) {
+            while (pop_completion(&tag, &result)) {
+            }
+            if (!in_flight) {
+                return 0;
+            }
+            if (int error_number = enter(0)) {
+                return error_number;
+            }
+        }
+    }
+
+    /// Takes one completed read, if any, returning its tag and its result:
+    /// the number of bytes read or a negated errno value.
+    bool pop_completion(size_t* tag, int* result) {
+        const unsigned head = *cq_head;
+        if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        const io_uring_cqe& cqe = cqes[head & cq_mask];
+        *tag = static_cast<size_t>(cqe.user_data);
+        *result = cqe.res;
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+        --in_flight;
+        return true;
+    }
+
+private:
+    io_uring_reader(const io_uring_reader&) = delete;
+    void operator=(const io_uring_reader&) = delete;
+
+    // Submits to_submit queued reads and waits for a completion.
+    int enter(unsigned to_submit) {
+        for (;;) {
+            long rv = syscall(
+                __NR_io_uring_enter,
+                ring_fd,
+                to_submit,
+                1,
+                IORING_ENTER_GETEVENTS,
+                0,
+                0);
+            if (rv >= 0) {
+                unsubmitted -= static_cast<unsigned>(rv);
+                in_flight += static_cast<unsigned>(rv);
+                return 0;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                return errno;
+            }
+        }
+    }
+
+    void* map(size_t size, off_t offset) {
+        return mmap(
+            0,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            ring_fd,
+            offset);
+    }
+
+    int ring_fd;
+    void* sq_ring;
+    void* cq_ring;
+    void* sqes;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* sq_array;
+    unsigned sq_entries;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    io_uring_cqe* cqes;
+    unsigned unsubmitted;
+    // Submitted reads whose completions have not been popped.
+    unsigned in_flight;
+    bool valid;
+};
+
+#endif // SAJSON_HAVE_IO_URING
+} // namespace internal
+
+/// One file produced by \ref file_loader.
+struct loaded_file {
+    /// The position of the file's path in the list given to the loader.
+    size_t index;
+    /// The errno value from opening or reading the file, or 0.  If nonzero,
+    /// doc has the error ERROR_READ_FAILED.
+    int error_number;
+    /// The parsed contents of the file, which the document owns.
+    document doc;
+};
+
+/**
+ * Reads and parses a list of files in the background and hands out the
+ * resulting documents as they complete.
+ *
+ * Reading and parsing are pipelined: while the pool's threads parse files
+ * that have arrived, later files are already being read, either by a
+ * dedicated thread submitting batches to io_uring or, without io_uring, by
+ * each parsing thread just before it parses.  Each parsing thread uses its
+ * own copy of the allocation strategy, as in \ref parse_many, so
+ * strategies must not share a caller-provided buffer: bounded_allocation is
+ * rejected at compile time, and single_allocation must use its default
+ * constructor, which is checked with an assertion.
+ *
+ * Finished documents wait in a queue of queue_capacity entries; when it is
+ * full, reading and parsing pause until next() is called, so at most a
+ * handful of files beyond queue_capacity are held in memory at once.
+ * Documents arrive in completion order, not in the order of paths.
+ *
+ * Only regular files are supported; their size is taken when they are
+ * opened.  Destroying the loader before every file has been taken stops
+ * the pipeline and discards unclaimed documents.
+ */
+template <typename AllocationStrategy>
+class file_loader {
+    static_assert(
+        !std::is_same<AllocationStrategy, bounded_allocation>::value,
+        "bounded_allocation cannot be shared between workers");
+
+public:
+    /// Starts loading paths.  thread_count is the number of parsing
+    /// threads, or std::thread::hardware_concurrency() if zero.  If
+    /// allow_io_uring is false or io_uring is unavailable, files are read
+    /// with pread.
+    file_loader(
+        const AllocationStrategy& strategy,
+        std::vector<std::string> paths_,
+        size_t thread_count = 0,
+        size_t queue_capacity = 64,
+        bool allow_io_uring = true)
+        : paths(std::move(paths_))
+        , pool(thread_count)
+        , strategies(pool.get_thread_count(), strategy)
+        , reads(read_depth)
+        , results(queue_capacity)
+        , remaining_count(paths.size())
+        , using_io_uring(false) {
+        assert(!internal::uses_caller_buffer(strategy));
+#ifdef SAJSON_HAVE_IO_URING
+        if (allow_io_uring) {
+            ring.reset(new internal::io_uring_reader(read_depth));
+            using_io_uring = ring->is_valid();
+            if (using_io_uring) {
+                reader = std::thread(&file_loader::read_with_io_uring, this);
+            } else {
+                ring.reset();
+            }
+        }
+#else
+        (void)allow_io_uring;
+#endif
+        coordinator = std::thread(&file_loader::parse_all, this);
+    }
+
+    ~file_loader() {
+        results.close();
+        reads.close();
+        if (reader.joinable()) {
+            reader.join();
+        }
+        coordinator.join();
+    }
+
+    /// Returns the number of files that next() has yet to return.
+    size_t remaining() const { return remaining_count; }
+
+    /// Blocks until another file has been read and parsed, and returns it.
+    /// Only legal if remaining() is nonzero.
+    loaded_file next() {
+        assert(remaining_count > 0);
+        std::unique_ptr<loaded_file> file;
+        results.pop(file);
+        --remaining_count;
+        return std::move(*file);
+    }
+
+    /// Returns true if files are being read with io_uring.
+    bool is_using_io_uring() const { return using_io_uring; }
+
+private:
+    file_loader(const file_loader&) = delete;
+    void operator=(const file_loader&) = delete;
+
+    // Reads in flight at once, and read results waiting for a parser.
+    static const unsigned read_depth = 32;
+
+    void parse_all() {
+        pool.for_each_index(
+            paths.size(), 1, [this](size_t worker, size_t index, size_t) {
+                if (results.is_closed()) {
+                    return;
+                }
+                internal::file_contents contents;
+                if (using_io_uring) {
+                    // Take whichever read finished next, not necessarily
+                    // this index's: every index pops exactly one.
+                    if (!reads.pop(contents)) {
+                        return;
+                    }
+                } else {
+                    contents.index = index;
+                    internal::read_file_contents(
+                        paths[index].c_str(), contents);
+                }
+                std::unique_ptr<loaded_file> file(new loaded_file{
+                    contents.index,
+                    contents.error_number,
+                    parse(worker, contents) });
+                results.push(std::move(file));
+            });
+    }
+
+    document parse(size_t worker, internal::file_contents& contents) {
+        if (contents.error_number) {
+            return document::_internal_make_error(
+                mutable_string_view(), ERROR_READ_FAILED);
+        }
+        mutable_string_view text(contents.length, contents.buffer);
+        // Buffer reference counts are not atomic, so the document must hold
+        // the only reference before it is handed to another thread.
+        contents.buffer = internal::allocated_buffer();
+        try {
+            return sajson::parse(strategies[worker], text);
+        } catch (const std::bad_alloc&) {
+            return document::_internal_make_error(
+                mutable_string_view(), ERROR_OUT_OF_MEMORY);
+        }
+    }
+
+#ifdef SAJSON_HAVE_IO_URING
+    // A file being read into its buffer, possibly over several reads.
+    struct pending_read {
+        int fd;
+        size_t offset;
+        internal::file_contents contents;
+    };
+
+    // A single read is limited to 2^31 - 1 bytes, so larger files are read
+    // in pieces.
+    static unsigned read_size(size_t remaining) {
+        return static_cast<unsigned>(std::min<size_t>(remaining, 1u << 30));
+    }
+
+    void read_with_io_uring() {
+        std::vector<pending_read> slots(read_depth);
+        std::vector<size_t> free_slots;
+        for (size_t i = read_depth; i > 0; --i) {
+            free_slots.push_back(i - 1);
+        }
+        size_t next_path = 0;
+        int failure = 0;
+
+        for (;;) {
+            while (!failure && !free_slots.empty() && next_path < paths.size()
+                   && !reads.is_closed()) {
+                internal::file_contents contents;
+                contents.index = next_path++;
+                int fd = -1;
+                size_t length = 0;
+                contents.error_number = internal::open_for_reading(
+                    paths[contents.index].c_str(), &fd, &length);
+                if (!contents.error_number && length) {
+                    try {
+                        contents.buffer = internal::allocated_buffer(length);
+                        contents.length = length;
+                        const size_t tag = free_slots.back();
+                        free_slots.pop_back();
+                        bool queued = ring->queue_read(
+                            fd,
+                            contents.buffer.get_data(),
+                            read_size(length),
+                            0,
+                            tag);
+                        assert(queued);
+                        (void)queued;
+                        slots[tag].fd = fd;
+                        slots[tag].offset = 0;
+                        slots[tag].contents = std::move(contents);
+                        continue;
+                    } catch (const std::bad_alloc&) {
+                        contents.error_number = ENOMEM;
+                    }
+                }
+                // Empty and unreadable files need no reads.
+                if (fd >= 0) {
+                    close(fd);
+                }
+                reads.push(std::move(contents));
+            }
+            if (free_slots.size() == read_depth) {
+                break;
+            }
+
+            if (!failure) {
+                failure = ring->submit_and_wait();
+            }
+            if (failure) {
+                // The ring is unusable, so every file still being read
+                // fails.
+                for (size_t tag = 0; tag < read_depth; ++tag) {
+                    if (std::find(free_slots.begin(), free_slots.end(), tag)
+                        != free_slots.end()) {
+                        continue;
+                    }
+                    internal::file_contents contents;
+                    contents.index = slots[tag].contents.index;
+                    contents.error_number = failure;
+                    close(slots[tag].fd);
+                    free_slots.push_back(tag);
+                    reads.push(std::move(contents));
+                }
+                for (; next_path < paths.size(); ++next_path) {
+                    internal::file_contents contents;
+                    contents.index = next_path;
+                    contents.error_number = failure;
+                    reads.push(std::move(contents));
+                }
+                // Submitted reads may still write into the slots' buffers,
+                // so wait for them before the slots go.  If even that
+                // fails, leak the buffers and the ring instead.
+                if (ring->drain()) {
+                    new std::vector<pending_read>(std::move(slots));
+                    ring.release();
+                }
+                break;
+            }
+
+            size_t tag;
+            int result;
+            while (ring->pop_completion(&tag, &result)) {
+                pending_read& read = slots[tag];
+                const size_t length = read.contents.length;
+                if (result > 0) {
+                    read.offset += static_cast<size_t>(result);
+                    if (read.offset < length) {
+                        bool queued = ring->queue_read(
+                            read.fd,
+                            read.contents.buffer.get_data() + read.offset,
+                            read_size(length - read.offset),
+                            read.offset,
+                            tag);
+                        assert(queued);
+                        (void)queued;
+                        continue;
+                    }
+                } else if (result < 0) {
+                    read.contents.error_number = -result;
+                }
+                // A zero-byte read means the file shrank.
+                read.contents.length = read.offset;
+                close(read.fd);
+                free_slots.push_back(tag);
+                reads.push(std::move(read.contents));
+            }
+        }
+        ring.reset();
+    }
+#endif
+
+    const std::vector<std::string> paths;
+    thread_pool pool;
+    std::vector<AllocationStrategy> strategies;
+    internal::bounded_queue<internal::file_contents> reads;
+    internal::bounded_queue<std::unique_ptr<loaded_file>> results;
+    size_t remaining_count;
+    bool using_io_uring;
+#ifdef SAJSON_HAVE_IO_URING
+    std::unique_ptr<internal::io_uring_reader> ring;
+#endif
+    std::thread reader;
+    std::thread coordinator;
+};
+
+} // namespace sajson
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "sajson.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define SAJSON_MINIFY_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+ * Stripping insignificant whitespace from JSON text in place.
+ *
+ * minify() classifies the input sixty-four bytes at a time: it builds
+ * bitmasks of quotes, backslashes, and whitespace, with SSE2 where available,
+ * derives which bytes lie inside strings from the unescaped quotes, and
+ * compacts the bytes it keeps towards the front of the buffer.
+ */
+namespace sajson {
+
+namespace internal {
+static const size_t minify_block_size = 64;
+
+struct minify_masks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t whitespace;
+};
+
+#ifdef SAJSON_MINIFY_SSE2
+inline uint64_t minify_chunk_mask(__m128i chunk, __m128i c) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, c)));
+}
+#endif
+
+// Bit i of each mask describes block[i].
+inline minify_masks classify_block(const char* block) {
+    minify_masks masks = { 0, 0, 0 };
+#ifdef SAJSON_MINIFY_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    for (size_t i = 0; i < minify_block_size; i += 16) {
+        const __m128i chunk
+            = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        masks.quote |= minify_chunk_mask(chunk, quote) << i;
+        masks.backslash |= minify_chunk_mask(chunk, backslash) << i;
+        const __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+            _mm_or_si128(
+                _mm_cmpeq_epi8(chunk, newline),
+                _mm_cmpeq_epi8(chunk, carriage_return)));
+        masks.whitespace
+            |= static_cast<uint64_t>(
+                   static_cast<uint32_t>(_mm_movemask_epi8(whitespace)))
+            << i;
+    }
+#else
+    for (size_t i = 0; i < minify_block_size; ++i) {
+        const uint64_t bit = uint64_t(1) << i;
+        const char c = block[i];
+        if (c == '"') {
+            masks.quote |= bit;
+        } else if (c == '\\') {
+            masks.backslash |= bit;
+        } else if (is_whitespace(c)) {
+            masks.whitespace |= bit;
+        }
+    }
+#endif
+    return masks;
+}
+
+// Returns the bytes escaped by a backslash.  *carry is set if the block's
+// last byte is a backslash that escapes the next block's first byte.
+inline uint64_t find_escaped(uint64_t backslash, uint64_t* carry) {
+    uint64_t escaped = *carry;
+    // A backslash that is itself escaped does not escape anything.
+    uint64_t escapes = backslash & ~escaped;
+    *carry = 0;
+    while (escapes) {
+        const uint64_t bit = escapes & (0 - escapes);
+        const uint64_t next = bit << 1;
+        escaped |= next;
+        *carry |= bit >> 63;
+        escapes &= ~(bit | next);
+    }
+    return escaped;
+}
+
+// Returns a mask where bit i is the XOR of bits 0 through i of x.
+inline uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+inline unsigned minify_lowest_set_bit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    unsigned index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Copies the bytes of block whose bits are set in keep to out, which must
+// have room for sixteen bytes past the last kept one, and returns the end.
+// block must not overlap out.
+inline char* compact_block(const char* block, uint64_t keep, char* out) {
+    // Copy each run of kept bytes sixteen at a time; the overshoot is
+    // overwritten by the next run or lies past the end.
+    size_t start = 0;
+    for (;;) {
+        const uint64_t rest = keep >> start;
+        if (!rest) {
+            return out;
+        }
+        start += minify_lowest_set_bit(rest);
+        const uint64_t gaps = ~keep >> start;
+        const size_t run = gaps ? minify_lowest_set_bit(gaps) : 64 - start;
+        for (size_t i = 0; i < run; i += 16) {
+            memcpy(out + i, block + start + i, 16);
+        }
+        out += run;
+        start += run;
+        if (start == minify_block_size) {
+            return out;
+        }
+    }
+}
+
+// Copies up to a block of input starting at offset into block, padding a
+// short final block with spaces, which minify away.
+inline void load_block(
+    const char* data, size_t length, size_t offset, char* block) {
+    const size_t remaining = length - offset;
+    if (remaining >= minify_block_size) {
+        memcpy(block, data + offset, minify_block_size);
+    } else {
+        memcpy(block, data + offset, remaining);
+        memset(block + remaining, ' ', minify_block_size - remaining);
+    }
+}
+} // namespace internal
+
+/// Removes whitespace outside strings from input, in place, and returns the
+/// new length.  Bytes past the new length are unspecified.  Running minify()
+/// before parse() makes the parse faster; minify() itself does not validate,
+/// and invalid input is compacted as if it were JSON.
+inline size_t minify(const mutable_string_view& input) {
+    using namespace internal;
+
+    char* const data = input.get_data();
+    const size_t length = input.length();
+    char* out = data;
+    uint64_t escape_carry = 0;
+    // All ones while the previous block ended inside a string.
+    uint64_t in_string_carry = 0;
+
+    // compact_block's copies can spill up to fifteen bytes into the next
+    // block, so each block is loaded before the previous one is written.
+    // The sixteen spare bytes let runs be read sixteen at a time.
+    char blocks[2][minify_block_size + 16];
+    if (length) {
+        load_block(data, length, 0, blocks[0]);
+    }
+    for (size_t offset = 0, parity = 0; offset < length;
+         offset += minify_block_size, parity ^= 1) {
+        const char* block = blocks[parity];
+        const size_t next = offset + minify_block_size;
+        if (next < length) {
+            load_block(data, length, next, blocks[parity ^ 1]);
+        }
+
+        const minify_masks masks = classify_block(block);
+        uint64_t quotes = masks.quote;
+        if (masks.backslash | escape_carry) {
+            quotes &= ~find_escaped(masks.backslash, &escape_carry);
+        }
+        // Opening quotes and string contents are set; closing quotes are not.
+        const uint64_t in_string = prefix_xor(quotes) ^ in_string_carry;
+        in_string_carry = 0 - (in_string >> 63);
+
+        uint64_t keep = ~(masks.whitespace & ~in_string);
+        if (length - offset < minify_block_size) {
+            keep &= (uint64_t(1) << (length - offset)) - 1;
+        }
+        if (next + 16 <= length) {
+            out = compact_block(block, keep, out);
+        } else {
+            // Near the end, spills would run past the input.
+            char compacted[minify_block_size + 16];
+            const size_t count = compact_block(block, keep, compacted)
+                - compacted;
+            memcpy(out, compacted, count);
+            out += count;
+        }
+    }
+    return out - data;
+}
+
+} // namespace sajson
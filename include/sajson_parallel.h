@@ -0,0 +1,409 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Multithreaded helpers built on a small work-stealing thread pool: parsing
+ * many documents at once, and processing the elements of one large array.
+ *
+ * Requires linking with the platform's thread library (-pthread).
+ */
+namespace sajson {
+
+namespace internal {
+// One worker's share of the index space.  The owner claims chunks from the
+// front and thieves split off the back half, so they rarely contend.
+struct work_range {
+    work_range()
+        : begin(0)
+        , end(0) {}
+
+    std::mutex mutex;
+    size_t begin;
+    size_t end;
+    // Keep neighbouring ranges on separate cache lines.
+    char padding[64];
+};
+
+// One worker's accumulator for parallel_map_reduce.
+template <typename T>
+struct worker_result {
+    T value;
+    // Keep neighbouring accumulators on separate cache lines.
+    char padding[64];
+};
+
+// Elements can vary wildly in cost, so aim for many chunks per worker, but
+// claim enough elements at a time to amortize touching the work ranges.
+inline size_t element_chunk_size(size_t count, size_t thread_count) {
+    const size_t chunk_size = count / (thread_count * 32);
+    return std::max<size_t>(1, std::min<size_t>(chunk_size, 1024));
+}
+} // namespace internal
+
+/**
+ * A fixed set of worker threads that cooperatively process index ranges.
+ *
+ * Each call to for_each_index() splits [0, count) evenly between the
+ * workers.  A worker that runs out of indices steals half of the largest
+ * remaining range, so uneven per-index costs still balance.  The calling
+ * thread participates as worker 0, so a pool with one thread runs everything
+ * inline.
+ *
+ * A thread_pool runs one for_each_index() at a time; it must not be called
+ * concurrently or from inside a task.
+ */
+class thread_pool {
+public:
+    /// Starts thread_count - 1 background threads.  If thread_count is zero,
+    /// uses std::thread::hardware_concurrency().
+    explicit thread_pool(size_t thread_count = 0)
+        : worker_count(thread_count ? thread_count : default_thread_count())
+        , ranges(new internal::work_range[worker_count])
+        , task(0)
+        , grain(1)
+        , generation(0)
+        , pending(0)
+        , stopping(false) {
+        try {
+            threads.reserve(worker_count - 1);
+            for (size_t i = 1; i < worker_count; ++i) {
+                threads.emplace_back(&thread_pool::worker_main, this, i);
+            }
+        } catch (...) {
+            // Destroying a joinable std::thread terminates the program, so
+            // stop the workers that did start before rethrowing.
+            stop();
+            throw;
+        }
+    }
+
+    ~thread_pool() { stop(); }
+
+    /// Returns the number of workers, including the calling thread.
+    size_t get_thread_count() const { return worker_count; }
+
+    /// Calls fn(worker, begin, end) on disjoint chunks of at most
+    /// chunk_size indices until every index in [0, count) has been visited.
+    /// worker is in [0, get_thread_count()) and identifies the calling
+    /// thread, which makes it suitable for indexing per-worker state.
+    /// Blocks until all chunks are processed.  If any call throws, the
+    /// first exception is rethrown after the remaining work completes.
+    template <typename Function>
+    void for_each_index(size_t count, size_t chunk_size, Function&& fn) {
+        std::function<void(size_t, size_t, size_t)> f(
+            std::forward<Function>(fn));
+        run(count, chunk_size, f);
+    }
+
+private:
+    thread_pool(const thread_pool&) = delete;
+    void operator=(const thread_pool&) = delete;
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    static size_t default_thread_count() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    void run(
+        size_t count,
+        size_t chunk_size,
+        const std::function<void(size_t, size_t, size_t)>& f) {
+        const size_t per_worker = count / worker_count;
+        const size_t extra = count % worker_count;
+        size_t begin = 0;
+        for (size_t i = 0; i < worker_count; ++i) {
+            size_t end = begin + per_worker + (i < extra ? 1 : 0);
+            std::lock_guard<std::mutex> lock(ranges[i].mutex);
+            ranges[i].begin = begin;
+            ranges[i].end = end;
+            begin = end;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            task = &f;
+            grain = chunk_size ? chunk_size : 1;
+            failure = std::exception_ptr();
+            pending = worker_count - 1;
+            ++generation;
+        }
+        wake.notify_all();
+
+        work(0);
+
+        std::unique_lock<std::mutex> lock(state_mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        task = 0;
+        if (failure) {
+            std::exception_ptr e = failure;
+            failure = std::exception_ptr();
+            std::rethrow_exception(e);
+        }
+    }
+
+    void worker_main(size_t worker) {
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(state_mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(worker);
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (--pending == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+    }
+
+    void work(size_t worker) {
+        size_t begin, end;
+        while (claim(worker, &begin, &end)) {
+            try {
+                (*task)(worker, begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        }
+    }
+
+    bool claim(size_t worker, size_t* begin, size_t* end) {
+        internal::work_range& own = ranges[worker];
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.begin < own.end) {
+                    *begin = own.begin;
+                    *end = own.end - own.begin > grain ? own.begin + grain
+                                                       : own.end;
+                    own.begin = *end;
+                    return true;
+                }
+            }
+
+            size_t victim = worker;
+            size_t most = 0;
+            for (size_t i = 0; i < worker_count; ++i) {
+                if (i == worker) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(ranges[i].mutex);
+                size_t remaining = ranges[i].end - ranges[i].begin;
+                if (remaining > most) {
+                    most = remaining;
+                    victim = i;
+                }
+            }
+            if (victim == worker) {
+                return false;
+            }
+
+            size_t stolen_begin, stolen_end;
+            {
+                std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                internal::work_range& r = ranges[victim];
+                size_t remaining = r.end - r.begin;
+                if (remaining == 0) {
+                    continue;
+                }
+                stolen_end = r.end;
+                stolen_begin = r.end - (remaining + 1) / 2;
+                r.end = stolen_begin;
+            }
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = stolen_begin;
+            own.end = stolen_end;
+        }
+    }
+
+    const size_t worker_count;
+    std::unique_ptr<internal::work_range[]> ranges;
+    std::vector<std::thread> threads;
+
+    std::mutex state_mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t, size_t, size_t)>* task;
+    size_t grain;
+    size_t generation;
+    size_t pending;
+    bool stopping;
+    std::exception_ptr failure;
+};
+
+/**
+ * Parses every input on the given thread pool and replaces the contents of
+ * *outputs with one \ref document per input, in input order.
+ *
+ * Each worker parses with its own copy of the allocation strategy, so
+ * strategies must not share a caller-provided buffer:
+ * \ref bounded_allocation is rejected at compile time and
+ * single_allocation should use its default constructor.  If the input text
+ * cannot be copied, that input's document fails with ERROR_OUT_OF_MEMORY.
+ */
+template <typename AllocationStrategy, typename StringType>
+void parse_many(
+    const AllocationStrategy& strategy,
+    const std::vector<StringType>& inputs,
+    std::vector<document>* outputs,
+    thread_pool& pool) {
+    static_assert(
+        !std::is_same<AllocationStrategy, bounded_allocation>::value,
+        "bounded_allocation cannot be shared between workers");
+
+    typedef typename std::aligned_storage<sizeof(document), alignof(document)>::
+        type slot;
+    const size_t count = inputs.size();
+    std::unique_ptr<slot[]> slots(new slot[count]);
+    std::vector<AllocationStrategy> strategies(
+        pool.get_thread_count(), strategy);
+
+    // Payloads are typically small, so claim several at a time to amortize
+    // the cost of touching the shared work ranges.
+    size_t chunk_size = count / (pool.get_thread_count() * 16);
+    chunk_size = std::max<size_t>(1, std::min<size_t>(chunk_size, 64));
+
+    pool.for_each_index(
+        count, chunk_size, [&](size_t worker, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                void* out = &slots[i];
+                try {
+                    new (out) document(parse(strategies[worker], inputs[i]));
+                } catch (const std::bad_alloc&) {
+                    new (out) document(document::_internal_make_error(
+                        mutable_string_view(), ERROR_OUT_OF_MEMORY));
+                }
+            }
+        });
+
+    outputs->clear();
+    outputs->reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        document* d = reinterpret_cast<document*>(&slots[i]);
+        outputs->emplace_back(std::move(*d));
+        d->~document();
+    }
+}
+
+/// Convenience wrapper for parse_many(strategy, inputs, outputs, pool) that
+/// runs on a temporary pool of thread_count threads.  If thread_count is
+/// zero, uses std::thread::hardware_concurrency().
+template <typename AllocationStrategy, typename StringType>
+void parse_many(
+    const AllocationStrategy& strategy,
+    const std::vector<StringType>& inputs,
+    std::vector<document>* outputs,
+    size_t thread_count = 0) {
+    thread_pool pool(thread_count);
+    parse_many(strategy, inputs, outputs, pool);
+}
+
+/**
+ * Calls fn(element) for each element of array, concurrently on the pool's
+ * threads, and blocks until every call returns.  Elements are handed out in
+ * chunks of chunk_size, or a size chosen from the array's length if zero,
+ * and idle workers steal chunks from busy ones.
+ *
+ * Values only read the document's immutable AST, so sharing them between
+ * threads is safe as long as the document outlives the call.  fn must be
+ * safe to call concurrently and may see elements in any order.  If any call
+ * throws, the first exception is rethrown after the remaining elements are
+ * processed.  Only legal if array.get_type() is TYPE_ARRAY.
+ */
+template <typename Function>
+void parallel_for_each(
+    const value& array,
+    Function&& fn,
+    thread_pool& pool,
+    size_t chunk_size = 0) {
+    assert(array.get_type() == TYPE_ARRAY);
+    const size_t count = array.get_length();
+    if (!chunk_size) {
+        chunk_size
+            = internal::element_chunk_size(count, pool.get_thread_count());
+    }
+    pool.for_each_index(
+        count, chunk_size, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                fn(array.get_array_element(i));
+            }
+        });
+}
+
+/**
+ * Returns the reduction of map(element) over the elements of array,
+ * computed concurrently on the pool's threads.
+ *
+ * map takes a value and returns a T; reduce takes two Ts and returns their
+ * combination.  Each worker folds the elements it processes into its own
+ * accumulator, starting from identity, and the accumulators are then folded
+ * together on the calling thread.  Because which worker processes an element
+ * depends on scheduling, reduce must be associative and commutative, and
+ * identity must be its identity.  Chunking, concurrency, and exceptions are
+ * as for parallel_for_each().  Only legal if array.get_type() is
+ * TYPE_ARRAY.
+ */
+template <typename T, typename Map, typename Reduce>
+T parallel_map_reduce(
+    const value& array,
+    const T& identity,
+    Map&& map,
+    Reduce&& reduce,
+    thread_pool& pool,
+    size_t chunk_size = 0) {
+    assert(array.get_type() == TYPE_ARRAY);
+    const size_t count = array.get_length();
+    const size_t thread_count = pool.get_thread_count();
+    if (!chunk_size) {
+        chunk_size = internal::element_chunk_size(count, thread_count);
+    }
+    std::vector<internal::worker_result<T>> partials(
+        thread_count, internal::worker_result<T>{ identity, {} });
+    pool.for_each_index(
+        count, chunk_size, [&](size_t worker, size_t begin, size_t end) {
+            T& accumulator = partials[worker].value;
+            for (size_t i = begin; i < end; ++i) {
+                accumulator = reduce(
+                    std::move(accumulator), map(array.get_array_element(i)));
+            }
+        });
+
+    T result = identity;
+    for (auto& partial : partials) {
+        result = reduce(std::move(result), std::move(partial.value));
+    }
+    return result;
+}
+
+} // namespace sajson
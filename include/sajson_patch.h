@@ -0,0 +1,613 @@
+#pragma once
+
+#include "sajson.h"
+#include "sajson_pointer.h"
+#include "sajson_writer.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * Applying JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7386) documents.
+ *
+ * Patching never modifies the parsed document.  The patch is applied to a
+ * lightweight overlay instead: only the containers along edited paths are
+ * expanded into editable nodes, and every untouched subtree remains a
+ * reference into the original document.  The result is then streamed to a
+ * \ref writer, so it is never built in memory.
+ *
+ * If the document was parsed by \ref parse_with_source_ranges and its
+ * original text is passed along, untouched subtrees are copied from that
+ * text verbatim rather than re-serialized, so only edited paths are
+ * regenerated.
+ */
+namespace sajson {
+
+/// Describes why a JSON Patch could not be applied.
+struct patch_error {
+    /// The index of the failing operation within the patch.
+    size_t operation;
+    /// What went wrong, such as "path not found" or "test failed".
+    std::string reason;
+};
+
+namespace internal {
+// The patched document: nodes that are either references to parsed values
+// or containers expanded for editing.
+class patch_tree {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    // If source is not null, document_root was parsed from it with source
+    // ranges, and leaves from the document are written by copying it.
+    explicit patch_tree(const value& document_root, const char* source_ = 0)
+        : source(source_)
+        , root(add_leaf(document_root, source_ != 0))
+        , reason(0) {
+        assert(!source || document_root.has_source_range());
+    }
+
+    const char* get_reason() const { return reason; }
+
+    bool apply_operation(const value& operation) {
+        if (operation.get_type() != TYPE_OBJECT) {
+            return fail("operation is not an object");
+        }
+        value op;
+        if (!get_member(operation, literal("op"), TYPE_STRING, &op)) {
+            return fail("missing op");
+        }
+        value path_text;
+        if (!get_member(
+                operation, literal("path"), TYPE_STRING, &path_text)) {
+            return fail("missing path");
+        }
+        const pointer path(string(
+            path_text.as_cstring(), path_text.get_string_length()));
+        if (!path.is_valid()) {
+            return fail("invalid path");
+        }
+
+        const string name(op.as_cstring(), op.get_string_length());
+        if (is_key(name, "add") || is_key(name, "replace")
+            || is_key(name, "test")) {
+            value v;
+            if (!get_member(operation, literal("value"), 0, &v)) {
+                return fail("missing value");
+            }
+            if (is_key(name, "add")) {
+                return add(path, add_leaf(v));
+            } else if (is_key(name, "replace")) {
+                return replace(path, add_leaf(v));
+            }
+            const size_t n = find(path, path.get_step_count());
+            if (n == npos) {
+                return fail("path not found");
+            }
+            return equals(n, v) || fail("test failed");
+        }
+        if (is_key(name, "remove")) {
+            return remove(path) != npos;
+        }
+        if (is_key(name, "move") || is_key(name, "copy")) {
+            value from_text;
+            if (!get_member(
+                    operation, literal("from"), TYPE_STRING, &from_text)) {
+                return fail("missing from");
+            }
+            const pointer from(string(
+                from_text.as_cstring(), from_text.get_string_length()));
+            if (!from.is_valid()) {
+                return fail("invalid from");
+            }
+            if (is_key(name, "copy")) {
+                const size_t n = find(from, from.get_step_count());
+                if (n == npos) {
+                    return fail("from not found");
+                }
+                return add(path, clone(n));
+            }
+            if (is_prefix(from, path)) {
+                if (from.get_step_count() == path.get_step_count()) {
+                    // Moving a value onto itself only requires it to exist.
+                    return find(from, from.get_step_count()) != npos
+                        || fail("from not found");
+                }
+                return fail("cannot move a value into itself");
+            }
+            const size_t n = remove(from);
+            return n != npos && add(path, n);
+        }
+        return fail("unknown op");
+    }
+
+    void merge(const value& patch) { root = merge(root, patch); }
+
+    void write(writer& out) const { write(root, out); }
+
+private:
+    enum node_kind {
+        // A parsed value from the document or the patch, used as is.
+        leaf_node,
+        object_node,
+        array_node,
+    };
+
+    struct member {
+        const char* key;
+        size_t key_length;
+        size_t node;
+    };
+
+    struct node {
+        node_kind kind;
+        value leaf;
+        // Whether leaf lies within source rather than the patch.
+        bool from_source;
+        std::vector<member> members;
+        std::vector<size_t> elements;
+    };
+
+    static bool is_key(const string& key, const char* name) {
+        const size_t length = strlen(name);
+        return key.length() == length && memcmp(key.data(), name, length) == 0;
+    }
+
+    static bool same_key(const string& a, const string& b) {
+        return internal::compare_keys(a, b) == 0;
+    }
+
+    bool fail(const char* why) {
+        reason = why;
+        return false;
+    }
+
+    // Reads a member of an operation, of the given type unless 0.
+    static bool get_member(
+        const value& operation, const string& key, int type, value* out) {
+        const size_t i = operation.find_object_key(key);
+        if (i == operation.get_length()) {
+            return false;
+        }
+        *out = operation.get_object_value(i);
+        return !type || out->get_type() == type;
+    }
+
+    static bool is_prefix(const pointer& a, const pointer& b) {
+        if (a.get_step_count() > b.get_step_count()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.get_step_count(); ++i) {
+            if (!same_key(a.get_step_key(i), b.get_step_key(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Takes v by value: it may refer into nodes, which push_back moves.
+    size_t add_leaf(const value v, bool from_source = false) {
+        nodes.push_back(node());
+        nodes.back().kind = leaf_node;
+        nodes.back().leaf = v;
+        nodes.back().from_source = from_source;
+        return nodes.size() - 1;
+    }
+
+    size_t add_container(node_kind kind) {
+        nodes.push_back(node());
+        nodes.back().kind = kind;
+        return nodes.size() - 1;
+    }
+
+    static member make_member(const string& key, size_t n) {
+        member m;
+        m.key = key.data();
+        m.key_length = key.length();
+        m.node = n;
+        return m;
+    }
+
+    // Copies key into storage owned by the tree.
+    string own(const string& key) {
+        owned_keys.push_back(std::string(key.data(), key.length()));
+        return string(owned_keys.back().data(), owned_keys.back().size());
+    }
+
+    // Turns a leaf array or object into an editable container whose
+    // children are leaves.
+    void expand(size_t n) {
+        if (nodes[n].kind != leaf_node) {
+            return;
+        }
+        const value v = nodes[n].leaf;
+        const bool from_source = nodes[n].from_source;
+        const size_t length
+            = v.get_type() == TYPE_ARRAY || v.get_type() == TYPE_OBJECT
+            ? v.get_length()
+            : 0;
+        if (v.get_type() == TYPE_ARRAY) {
+            std::vector<size_t> elements(length);
+            for (size_t i = 0; i < length; ++i) {
+                elements[i] = add_leaf(v.get_array_element(i), from_source);
+            }
+            nodes[n].kind = array_node;
+            nodes[n].elements.swap(elements);
+        } else if (v.get_type() == TYPE_OBJECT) {
+            // The parser stores members sorted by key.  A value from the
+            // source has ranges, so restore the order it was written in.
+            std::vector<size_t> order(length);
+            for (size_t i = 0; i < length; ++i) {
+                order[i] = i;
+            }
+            if (from_source) {
+                std::sort(order.begin(), order.end(), [&v](size_t a, size_t b) {
+                    return v.get_object_value(a).get_source_start()
+                        < v.get_object_value(b).get_source_start();
+                });
+            }
+            std::vector<member> members;
+            members.reserve(length);
+            for (size_t k = 0; k < length; ++k) {
+                const size_t i = order[k];
+                const size_t child
+                    = add_leaf(v.get_object_value(i), from_source);
+                members.push_back(make_member(v.get_object_key(i), child));
+            }
+            nodes[n].kind = object_node;
+            nodes[n].members.swap(members);
+        }
+    }
+
+    size_t find_member(size_t n, const string& key) const {
+        const std::vector<member>& members = nodes[n].members;
+        for (size_t i = 0; i < members.size(); ++i) {
+            const member& m = members[i];
+            if (same_key(string(m.key, m.key_length), key)) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    // Returns the node reached by the first count steps of path, expanding
+    // the containers it passes through, or npos.
+    size_t find(const pointer& path, size_t count) {
+        size_t n = root;
+        for (size_t i = 0; i < count; ++i) {
+            expand(n);
+            if (nodes[n].kind == object_node) {
+                const size_t m = find_member(n, path.get_step_key(i));
+                if (m == npos) {
+                    return npos;
+                }
+                n = nodes[n].members[m].node;
+            } else if (nodes[n].kind == array_node) {
+                const size_t index = path.get_step_index(i);
+                if (index >= nodes[n].elements.size()) {
+                    return npos;
+                }
+                n = nodes[n].elements[index];
+            } else {
+                return npos;
+            }
+        }
+        return n;
+    }
+
+    // Returns the expanded container holding path's last step, or npos.
+    size_t find_parent(const pointer& path) {
+        const size_t parent = find(path, path.get_step_count() - 1);
+        if (parent == npos) {
+            fail("path not found");
+            return npos;
+        }
+        expand(parent);
+        if (nodes[parent].kind == leaf_node) {
+            fail("parent is not a container");
+            return npos;
+        }
+        return parent;
+    }
+
+    bool add(const pointer& path, size_t child) {
+        const size_t count = path.get_step_count();
+        if (count == 0) {
+            root = child;
+            return true;
+        }
+        const size_t parent = find_parent(path);
+        if (parent == npos) {
+            return false;
+        }
+        const string key = path.get_step_key(count - 1);
+        node& p = nodes[parent];
+        if (p.kind == object_node) {
+            const size_t m = find_member(parent, key);
+            if (m != npos) {
+                p.members[m].node = child;
+            } else {
+                p.members.push_back(make_member(own(key), child));
+            }
+            return true;
+        }
+        if (is_key(key, "-")) {
+            p.elements.push_back(child);
+            return true;
+        }
+        const size_t index = path.get_step_index(count - 1);
+        if (index > p.elements.size()) {
+            return fail("index out of range");
+        }
+        p.elements.insert(p.elements.begin() + index, child);
+        return true;
+    }
+
+    // Removes the value at path and returns its node, or npos.
+    size_t remove(const pointer& path) {
+        const size_t count = path.get_step_count();
+        if (count == 0) {
+            fail("cannot remove the root");
+            return npos;
+        }
+        const size_t parent = find_parent(path);
+        if (parent == npos) {
+            return npos;
+        }
+        node& p = nodes[parent];
+        if (p.kind == object_node) {
+            const size_t m = find_member(parent, path.get_step_key(count - 1));
+            if (m == npos) {
+                fail("path not found");
+                return npos;
+            }
+            const size_t removed = p.members[m].node;
+            p.members.erase(p.members.begin() + m);
+            return removed;
+        }
+        const size_t index = path.get_step_index(count - 1);
+        if (index >= p.elements.size()) {
+            fail("path not found");
+            return npos;
+        }
+        const size_t removed = p.elements[index];
+        p.elements.erase(p.elements.begin() + index);
+        return removed;
+    }
+
+    bool replace(const pointer& path, size_t child) {
+        const size_t count = path.get_step_count();
+        if (count == 0) {
+            root = child;
+            return true;
+        }
+        const size_t parent = find_parent(path);
+        if (parent == npos) {
+            return false;
+        }
+        node& p = nodes[parent];
+        if (p.kind == object_node) {
+            const size_t m = find_member(parent, path.get_step_key(count - 1));
+            if (m == npos) {
+                return fail("path not found");
+            }
+            p.members[m].node = child;
+            return true;
+        }
+        const size_t index = path.get_step_index(count - 1);
+        if (index >= p.elements.size()) {
+            return fail("path not found");
+        }
+        p.elements[index] = child;
+        return true;
+    }
+
+    // Returns a node that later edits to n will not affect.
+    size_t clone(size_t n) {
+        if (nodes[n].kind == leaf_node) {
+            return add_leaf(nodes[n].leaf, nodes[n].from_source);
+        }
+        const size_t copy = add_container(nodes[n].kind);
+        if (nodes[n].kind == object_node) {
+            for (size_t i = 0; i < nodes[n].members.size(); ++i) {
+                member m = nodes[n].members[i];
+                m.node = clone(m.node);
+                nodes[copy].members.push_back(m);
+            }
+        } else {
+            for (size_t i = 0; i < nodes[n].elements.size(); ++i) {
+                const size_t element = clone(nodes[n].elements[i]);
+                nodes[copy].elements.push_back(element);
+            }
+        }
+        return copy;
+    }
+
+    bool equals(size_t n, const value& v) const {
+        const node& a = nodes[n];
+        switch (a.kind) {
+        case leaf_node:
+            return a.leaf.equals(v);
+        case array_node:
+            if (v.get_type() != TYPE_ARRAY
+                || v.get_length() != a.elements.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a.elements.size(); ++i) {
+                if (!equals(a.elements[i], v.get_array_element(i))) {
+                    return false;
+                }
+            }
+            return true;
+        case object_node:
+            if (v.get_type() != TYPE_OBJECT
+                || v.get_length() != a.members.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a.members.size(); ++i) {
+                const size_t k = v.find_object_key(
+                    string(a.members[i].key, a.members[i].key_length));
+                if (k == v.get_length()
+                    || !equals(a.members[i].node, v.get_object_value(k))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        SAJSON_UNREACHABLE();
+    }
+
+    // RFC 7386 MergePatch(target, patch), where target may be npos for a
+    // missing member.  Returns the merged node.
+    size_t merge(size_t target, const value& patch) {
+        if (patch.get_type() != TYPE_OBJECT) {
+            return add_leaf(patch);
+        }
+        if (target != npos) {
+            expand(target);
+        }
+        if (target == npos || nodes[target].kind != object_node) {
+            target = add_container(object_node);
+        }
+        for (size_t i = 0; i < patch.get_length(); ++i) {
+            const string key = patch.get_object_key(i);
+            const value v = patch.get_object_value(i);
+            const size_t m = find_member(target, key);
+            if (v.get_type() == TYPE_NULL) {
+                if (m != npos) {
+                    nodes[target].members.erase(
+                        nodes[target].members.begin() + m);
+                }
+            } else if (m != npos) {
+                const size_t merged = merge(nodes[target].members[m].node, v);
+                nodes[target].members[m].node = merged;
+            } else {
+                const size_t merged = merge(npos, v);
+                nodes[target].members.push_back(make_member(key, merged));
+            }
+        }
+        return target;
+    }
+
+    void write(size_t n, writer& out) const {
+        const node& a = nodes[n];
+        switch (a.kind) {
+        case leaf_node:
+            if (a.from_source) {
+                const size_t start = a.leaf.get_source_start();
+                const size_t length = a.leaf.get_source_end() - start;
+                out.raw(string(source + start, length));
+            } else {
+                out.value(a.leaf);
+            }
+            return;
+        case array_node:
+            out.begin_array();
+            for (size_t i = 0; i < a.elements.size(); ++i) {
+                write(a.elements[i], out);
+            }
+            out.end_array();
+            return;
+        case object_node:
+            out.begin_object();
+            for (size_t i = 0; i < a.members.size(); ++i) {
+                const member& m = a.members[i];
+                out.key(string(m.key, m.key_length));
+                write(m.node, out);
+            }
+            out.end_object();
+            return;
+        }
+    }
+
+    std::vector<node> nodes;
+    // Keys from patch paths, which do not outlive their operation.  A deque
+    // never moves its elements, so the strings stay put.
+    std::deque<std::string> owned_keys;
+    const char* source;
+    size_t root;
+    const char* reason;
+};
+
+inline bool apply_patch_to_tree(
+    patch_tree& tree, const value& patch, writer& out, patch_error* error) {
+    if (patch.get_type() != TYPE_ARRAY) {
+        if (error) {
+            error->operation = 0;
+            error->reason = "patch is not an array";
+        }
+        return false;
+    }
+    for (size_t i = 0; i < patch.get_length(); ++i) {
+        if (!tree.apply_operation(patch.get_array_element(i))) {
+            if (error) {
+                error->operation = i;
+                error->reason = tree.get_reason();
+            }
+            return false;
+        }
+    }
+    tree.write(out);
+    return true;
+}
+} // namespace internal
+
+/// Applies a JSON Patch (RFC 6902), an array of add, remove, replace, move,
+/// copy, and test operations, to root and writes the result to out.  The
+/// patch is atomic: if any operation fails, nothing is written, and if error
+/// is not null it describes the failure.  Call out.finish() afterwards if
+/// it flushes.
+///
+/// Objects along edited paths are written with their members in the order
+/// sajson stores them, sorted by key unless SAJSON_UNSORTED_OBJECT_KEYS is
+/// defined, followed by any added members.
+inline bool apply_patch(
+    const value& root,
+    const value& patch,
+    writer& out,
+    patch_error* error = 0) {
+    internal::patch_tree tree(root);
+    return internal::apply_patch_to_tree(tree, patch, out, error);
+}
+
+/// Like apply_patch(root, patch, out, error), but copies the subtrees the
+/// patch leaves alone from source verbatim.  root must come from
+/// \ref parse_with_source_ranges over source, which must be the original,
+/// unmodified text.  Edited objects keep the order their members were
+/// written in, with added members at the end.
+inline bool apply_patch(
+    const value& root,
+    const string& source,
+    const value& patch,
+    writer& out,
+    patch_error* error = 0) {
+    internal::patch_tree tree(root, source.data());
+    return internal::apply_patch_to_tree(tree, patch, out, error);
+}
+
+/// Applies a JSON Merge Patch (RFC 7386) to root and writes the result to
+/// out.  Objects in the patch are merged member by member, null members are
+/// removed, and anything else replaces the target.  Every value is a valid
+/// merge patch.  Members are ordered as by apply_patch().
+inline void
+apply_merge_patch(const value& root, const value& patch, writer& out) {
+    internal::patch_tree tree(root);
+    tree.merge(patch);
+    tree.write(out);
+}
+
+/// Like apply_merge_patch(root, patch, out), but copies the subtrees the
+/// patch leaves alone from source verbatim.  root must come from
+/// \ref parse_with_source_ranges over source, which must be the original,
+/// unmodified text.  Edited objects keep the order their members were
+/// written in, with added members at the end.
+inline void apply_merge_patch(
+    const value& root, const string& source, const value& patch, writer& out) {
+    internal::patch_tree tree(root, source.data());
+    tree.merge(patch);
+    tree.write(out);
+}
+
+} // namespace sajson
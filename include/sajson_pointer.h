@@ -0,0 +1,152 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * JSON Pointer (RFC 6901) evaluation.
+ *
+ * A \ref pointer is compiled once and can then be evaluated against any
+ * number of values without allocating or re-parsing its text.
+ */
+namespace sajson {
+
+/**
+ * A compiled JSON Pointer such as "/data/items/3/id".
+ *
+ * Compiling splits the pointer into reference tokens, decodes the ~0 and ~1
+ * escapes, and precomputes each token's length and, if it is a valid array
+ * index, its numeric value.  Evaluating a step is then a single
+ * find_object_key() or bounds-checked array access.
+ */
+class pointer {
+public:
+    /// Returned by get_step_index() for tokens such as "-", "01", or "key"
+    /// that cannot index an array.
+    static const size_t not_an_index = static_cast<size_t>(-1);
+
+    /// Compiles the given pointer text.  The empty string refers to the
+    /// whole document; any other pointer must start with '/'.  Check
+    /// is_valid() before evaluating.
+    explicit pointer(const string& text)
+        : valid(compile(text.data(), text.data() + text.length())) {}
+
+    /// Returns true if the pointer text was well-formed.
+    bool is_valid() const { return valid; }
+
+    /// Returns the number of reference tokens in the pointer.
+    size_t get_step_count() const { return steps.size(); }
+
+    /// Returns the nth reference token with ~0 and ~1 decoded.  The string
+    /// lives as long as the pointer.
+    string get_step_key(size_t index) const {
+        return string(
+            keys.data() + steps[index].key_offset, steps[index].key_length);
+    }
+
+    /// Returns the array index the nth reference token names, or
+    /// not_an_index.
+    size_t get_step_index(size_t index) const { return steps[index].index; }
+
+    /// Resolves the pointer against root.  Returns true and writes the
+    /// referenced value to *out if every step exists.  Returns false if the
+    /// pointer is invalid, a key or index is missing, or a step would
+    /// descend into a scalar.  Does not allocate.
+    bool evaluate(const value& root, value* out) const {
+        if (!valid) {
+            return false;
+        }
+        value current = root;
+        for (const step& s : steps) {
+            switch (current.get_type()) {
+            case TYPE_OBJECT: {
+                size_t i = current.find_object_key(
+                    string(keys.data() + s.key_offset, s.key_length));
+                if (i == current.get_length()) {
+                    return false;
+                }
+                current = current.get_object_value(i);
+                break;
+            }
+            case TYPE_ARRAY:
+                if (s.index >= current.get_length()) {
+                    return false;
+                }
+                current = current.get_array_element(s.index);
+                break;
+            default:
+                return false;
+            }
+        }
+        *out = current;
+        return true;
+    }
+
+private:
+    struct step {
+        size_t key_offset;
+        size_t key_length;
+        size_t index;
+    };
+
+    bool compile(const char* p, const char* end) {
+        if (p == end) {
+            return true;
+        }
+        if (*p != '/') {
+            return false;
+        }
+        while (p != end) {
+            // Skip the '/' that starts this token.
+            ++p;
+            step s;
+            s.key_offset = keys.size();
+            while (p != end && *p != '/') {
+                if (*p == '~') {
+                    if (++p == end) {
+                        return false;
+                    }
+                    if (*p == '0') {
+                        keys.push_back('~');
+                    } else if (*p == '1') {
+                        keys.push_back('/');
+                    } else {
+                        return false;
+                    }
+                } else {
+                    keys.push_back(*p);
+                }
+                ++p;
+            }
+            s.key_length = keys.size() - s.key_offset;
+            s.index = parse_index(keys.data() + s.key_offset, s.key_length);
+            steps.push_back(s);
+        }
+        return true;
+    }
+
+    // RFC 6901 array indices are "0" or digits without a leading zero.
+    static size_t parse_index(const char* token, size_t length) {
+        if (length == 0 || (length > 1 && token[0] == '0')) {
+            return not_an_index;
+        }
+        size_t index = 0;
+        for (size_t i = 0; i < length; ++i) {
+            unsigned digit = static_cast<unsigned char>(token[i]) - '0';
+            if (digit > 9 || index > (not_an_index - 1 - digit) / 10) {
+                return not_an_index;
+            }
+            index = index * 10 + digit;
+        }
+        return index;
+    }
+
+    std::vector<step> steps;
+    // The decoded tokens, concatenated.
+    std::string keys;
+    bool valid;
+};
+
+} // namespace sajson
@@ -0,0 +1,957 @@
+#pragma once
+
+#include "sajson.h"
+#include "sajson_pointer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string>
+#include <vector>
+
+/**
+ * JSON Schema validation over parsed documents.
+ *
+ * A \ref schema is compiled once from a schema document that sajson has
+ * parsed and then validates any number of values in place.  It implements
+ * this subset of draft 2020-12:
+ *
+ *  - true and false schemas, type, enum, const
+ *  - minimum, maximum, exclusiveMinimum, exclusiveMaximum, multipleOf
+ *  - minLength, maxLength
+ *  - items, prefixItems, contains, minItems, maxItems, uniqueItems
+ *  - properties, required, additionalProperties, minProperties,
+ *    maxProperties
+ *  - allOf, anyOf, oneOf, not, if, then, else
+ *  - $ref to "#" or a JSON Pointer fragment such as "#/$defs/name"
+ *
+ * Compiling fails on keywords that would change the result but are not
+ * implemented, such as pattern, so a schema is never silently weakened.
+ * Annotations such as title and description are ignored.
+ */
+namespace sajson {
+
+/// Describes why a value failed validation.
+struct validation_error {
+    /// A JSON Pointer to the failing value within the validated document.
+    std::string instance_path;
+    /// The schema keyword that failed, such as "minimum" or "required".
+    std::string keyword;
+    /// Extra detail, such as the name of a missing property.
+    std::string detail;
+};
+
+/**
+ * A compiled JSON Schema.
+ *
+ * Compiling turns the schema document into a flat program of nodes.
+ * Validation walks the instance once.  Object keywords merge the object's
+ * sorted keys against the sorted property table, so properties, required,
+ * and additionalProperties cost one pass over the members.
+ *
+ * The compiled schema refers to strings and enum values in the schema
+ * document, which must outlive it.
+ */
+class schema {
+public:
+    /// Compiles the schema rooted at root.  Check is_valid() before
+    /// validating.
+    explicit schema(const value& root_)
+        : root(root_) {
+        if (compile(root_, std::string()) != none) {
+            std::vector<char> state(nodes.size(), unvisited);
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (!check_cycles(i, &state)) {
+                    break;
+                }
+            }
+        }
+        std::vector<std::string>().swap(node_paths);
+    }
+
+    /// Returns true if the schema compiled.
+    bool is_valid() const { return error_message.empty(); }
+
+    /// If the schema did not compile, describes why, starting with a JSON
+    /// Pointer into the schema document.
+    const std::string& get_error_message() const { return error_message; }
+
+    /// Returns true if instance satisfies the schema.  On failure, if error
+    /// is not null, describes the first failure found.  Returns false if
+    /// the schema itself is invalid.
+    bool validate(const value& instance, validation_error* error = 0) const {
+        if (!is_valid()) {
+            if (error) {
+                error->instance_path.clear();
+                error->keyword = "schema";
+                error->detail = error_message;
+            }
+            return false;
+        }
+        return check(0, instance, error);
+    }
+
+private:
+    static const size_t none = static_cast<size_t>(-1);
+
+    enum type_bit {
+        null_bit = 1,
+        boolean_bit = 2,
+        object_bit = 4,
+        array_bit = 8,
+        number_bit = 16,
+        integer_bit = 32,
+        string_bit = 64,
+    };
+
+    struct range {
+        range()
+            : begin(0)
+            , end(0) {}
+
+        size_t begin;
+        size_t end;
+    };
+
+    struct property {
+        string get_key() const { return string(key_data, key_length); }
+
+        const char* key_data;
+        size_t key_length;
+        // The schema from "properties", or none.
+        size_t node;
+        bool required;
+    };
+
+    struct node {
+        node()
+            : always_false(false)
+            , types(0)
+            , has_const(false)
+            , has_minimum(false)
+            , has_maximum(false)
+            , has_exclusive_minimum(false)
+            , has_exclusive_maximum(false)
+            , has_multiple_of(false)
+            , minimum(0)
+            , maximum(0)
+            , exclusive_minimum(0)
+            , exclusive_maximum(0)
+            , multiple_of(0)
+            , min_length(0)
+            , max_length(none)
+            , min_items(0)
+            , max_items(none)
+            , unique_items(false)
+            , items(none)
+            , contains(none)
+            , min_properties(0)
+            , max_properties(none)
+            , required_count(0)
+            , additional_properties(none)
+            , not_(none)
+            , if_(none)
+            , then_(none)
+            , else_(none)
+            , ref(none) {}
+
+        bool always_false;
+        unsigned types;
+        bool has_const;
+        value const_value;
+        range enum_values;
+
+        bool has_minimum;
+        bool has_maximum;
+        bool has_exclusive_minimum;
+        bool has_exclusive_maximum;
+        bool has_multiple_of;
+        double minimum;
+        double maximum;
+        double exclusive_minimum;
+        double exclusive_maximum;
+        double multiple_of;
+
+        size_t min_length;
+        size_t max_length;
+
+        size_t min_items;
+        size_t max_items;
+        bool unique_items;
+        range prefix_items;
+        size_t items;
+        size_t contains;
+
+        size_t min_properties;
+        size_t max_properties;
+        range properties;
+        size_t required_count;
+        size_t additional_properties;
+
+        range all_of;
+        range any_of;
+        range one_of;
+        size_t not_;
+        size_t if_;
+        size_t then_;
+        size_t else_;
+        size_t ref;
+    };
+
+    // Compiling.
+
+    bool fail(const std::string& path, const char* message) {
+        if (error_message.empty()) {
+            error_message = (path.empty() ? "/" : path) + ": " + message;
+        }
+        return false;
+    }
+
+    static std::string child_path(const std::string& path, const string& key) {
+        std::string rv = path;
+        internal::append_pointer_token(rv, key);
+        return rv;
+    }
+
+    static std::string child_path(const std::string& path, size_t index) {
+        char buffer[32];
+        SAJSON_snprintf(buffer, sizeof(buffer), "/%zu", index);
+        return path + buffer;
+    }
+
+    static bool is_key(const string& key, const char* name) {
+        const size_t length = strlen(name);
+        return key.length() == length && memcmp(key.data(), name, length) == 0;
+    }
+
+    // Compiles v into a new node and returns its index, or none on error.
+    size_t compile(const value& v, const std::string& path) {
+        const size_t index = nodes.size();
+        nodes.push_back(node());
+        node_paths.push_back(path);
+        compiled.push_back(std::make_pair(v._internal_get_payload(), index));
+
+        switch (v.get_type()) {
+        case TYPE_TRUE:
+            return index;
+        case TYPE_FALSE:
+            nodes[index].always_false = true;
+            return index;
+        case TYPE_OBJECT:
+            break;
+        default:
+            fail(path, "a schema must be an object or a boolean");
+            return none;
+        }
+
+        std::vector<property> table;
+        for (auto it = v.members().begin(); it != v.members().end(); ++it) {
+            if (!compile_keyword(
+                    index, &table, it.get_key(), it.get_value(), path)) {
+                return none;
+            }
+        }
+        std::sort(table.begin(), table.end(), property_less);
+        nodes[index].properties.begin = properties.size();
+        properties.insert(properties.end(), table.begin(), table.end());
+        nodes[index].properties.end = properties.size();
+        return index;
+    }
+
+    static bool property_less(const property& a, const property& b) {
+        return internal::compare_keys(a.get_key(), b.get_key()) < 0;
+    }
+
+    // Returns the node compiled from v, compiling it if necessary.  Shared
+    // nodes let $ref cycles terminate while compiling; check_cycles rejects
+    // the ones that would not terminate while validating.
+    size_t compile_shared(const value& v, const std::string& path) {
+        for (const auto& entry : compiled) {
+            if (entry.first == v._internal_get_payload()
+                && v.get_type() == TYPE_OBJECT) {
+                return entry.second;
+            }
+        }
+        return compile(v, path);
+    }
+
+    bool compile_number(
+        const value& v, const std::string& path, bool* has, double* out) {
+        const type t = v.get_type();
+        if (t != TYPE_INTEGER && t != TYPE_DOUBLE) {
+            return fail(path, "expected a number");
+        }
+        *has = true;
+        *out = v.get_number_value();
+        return true;
+    }
+
+    bool
+    compile_count(const value& v, const std::string& path, size_t* out) {
+        int64_t n;
+        const type t = v.get_type();
+        if ((t != TYPE_INTEGER && t != TYPE_DOUBLE) || !v.get_int53_value(&n)
+            || n < 0) {
+            return fail(path, "expected a non-negative integer");
+        }
+        *out = static_cast<size_t>(n);
+        return true;
+    }
+
+    bool compile_subschema(
+        const value& v, const std::string& path, size_t* out) {
+        *out = compile(v, path);
+        return *out != none;
+    }
+
+    bool compile_list(const value& v, const std::string& path, range* out) {
+        if (v.get_type() != TYPE_ARRAY || v.get_length() == 0) {
+            return fail(path, "expected a non-empty array of schemas");
+        }
+        std::vector<size_t> children;
+        for (size_t i = 0; i < v.get_length(); ++i) {
+            size_t child = compile(v.get_array_element(i), child_path(path, i));
+            if (child == none) {
+                return false;
+            }
+            children.push_back(child);
+        }
+        out->begin = subschemas.size();
+        subschemas.insert(subschemas.end(), children.begin(), children.end());
+        out->end = subschemas.size();
+        return true;
+    }
+
+    bool compile_type(const value& v, const std::string& path, unsigned* out) {
+        static const struct {
+            const char* name;
+            unsigned bit;
+        } names[] = {
+            { "null", null_bit },     { "boolean", boolean_bit },
+            { "object", object_bit }, { "array", array_bit },
+            { "number", number_bit }, { "integer", integer_bit },
+            { "string", string_bit },
+        };
+        if (v.get_type() == TYPE_ARRAY) {
+            for (size_t i = 0; i < v.get_length(); ++i) {
+                if (!compile_type(
+                        v.get_array_element(i), child_path(path, i), out)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if (v.get_type() == TYPE_STRING) {
+            const string name(v.as_cstring(), v.get_string_length());
+            for (const auto& n : names) {
+                if (is_key(name, n.name)) {
+                    *out |= n.bit;
+                    return true;
+                }
+            }
+        }
+        return fail(path, "unknown type");
+    }
+
+    bool compile_properties(
+        std::vector<property>* table,
+        const value& v,
+        const std::string& path) {
+        if (v.get_type() != TYPE_OBJECT) {
+            return fail(path, "expected an object");
+        }
+        for (auto it = v.members().begin(); it != v.members().end(); ++it) {
+            size_t child
+                = compile(it.get_value(), child_path(path, it.get_key()));
+            if (child == none) {
+                return false;
+            }
+            find_property(table, it.get_key()).node = child;
+        }
+        return true;
+    }
+
+    bool compile_required(
+        size_t index,
+        std::vector<property>* table,
+        const value& v,
+        const std::string& path) {
+        if (v.get_type() != TYPE_ARRAY) {
+            return fail(path, "expected an array of strings");
+        }
+        for (size_t i = 0; i < v.get_length(); ++i) {
+            const value& name = v.get_array_element(i);
+            if (name.get_type() != TYPE_STRING) {
+                return fail(child_path(path, i), "expected a string");
+            }
+            property& p = find_property(
+                table, string(name.as_cstring(), name.get_string_length()));
+            if (!p.required) {
+                p.required = true;
+                ++nodes[index].required_count;
+            }
+        }
+        return true;
+    }
+
+    // Returns the entry for key in the table being built, adding it if
+    // necessary.
+    static property& find_property(
+        std::vector<property>* table, const string& key) {
+        for (property& p : *table) {
+            if (internal::compare_keys(p.get_key(), key) == 0) {
+                return p;
+            }
+        }
+        property p = { key.data(), key.length(), none, false };
+        table->push_back(p);
+        return table->back();
+    }
+
+    bool compile_ref(size_t index, const value& v, const std::string& path) {
+        if (v.get_type() != TYPE_STRING || v.get_string_length() == 0
+            || v.as_cstring()[0] != '#') {
+            return fail(path, "only local references such as #/$defs/x "
+                              "are supported");
+        }
+        pointer fragment(
+            string(v.as_cstring() + 1, v.get_string_length() - 1));
+        value target;
+        if (!fragment.evaluate(root, &target)) {
+            return fail(path, "reference not found");
+        }
+        size_t child = compile_shared(target, path);
+        if (child == none) {
+            return false;
+        }
+        nodes[index].ref = child;
+        return true;
+    }
+
+    enum visit_state { unvisited, visiting, visited };
+
+    // Fails if a chain of subschemas that all apply to the same instance,
+    // such as {"$ref": "#"}, leads back to where it started: validating
+    // would recurse forever without moving into the instance.
+    bool check_cycles(size_t index, std::vector<char>* state) {
+        if ((*state)[index] == visited) {
+            return true;
+        }
+        if ((*state)[index] == visiting) {
+            return fail(
+                node_paths[index],
+                "reference cycle does not descend into the instance");
+        }
+        (*state)[index] = visiting;
+        const node& n = nodes[index];
+        const size_t children[] = { n.ref, n.not_, n.if_, n.then_, n.else_ };
+        for (size_t child : children) {
+            if (child != none && !check_cycles(child, state)) {
+                return false;
+            }
+        }
+        const range lists[] = { n.all_of, n.any_of, n.one_of };
+        for (const range& r : lists) {
+            for (size_t i = r.begin; i < r.end; ++i) {
+                if (!check_cycles(subschemas[i], state)) {
+                    return false;
+                }
+            }
+        }
+        (*state)[index] = visited;
+        return true;
+    }
+
+    bool compile_keyword(
+        size_t index,
+        std::vector<property>* table,
+        const string& key,
+        const value& v,
+        const std::string& schema_path) {
+        const std::string path = child_path(schema_path, key);
+        // Compiling a subschema grows nodes, so never hold a node reference
+        // across one.
+        if (is_key(key, "type")) {
+            return compile_type(v, path, &nodes[index].types);
+        } else if (is_key(key, "const")) {
+            nodes[index].has_const = true;
+            nodes[index].const_value = v;
+        } else if (is_key(key, "enum")) {
+            if (v.get_type() != TYPE_ARRAY) {
+                return fail(path, "expected an array");
+            }
+            range& r = nodes[index].enum_values;
+            r.begin = enum_values.size();
+            for (const value& element : v.elements()) {
+                enum_values.push_back(element);
+            }
+            r.end = enum_values.size();
+        } else if (is_key(key, "minimum")) {
+            node& n = nodes[index];
+            return compile_number(v, path, &n.has_minimum, &n.minimum);
+        } else if (is_key(key, "maximum")) {
+            node& n = nodes[index];
+            return compile_number(v, path, &n.has_maximum, &n.maximum);
+        } else if (is_key(key, "exclusiveMinimum")) {
+            node& n = nodes[index];
+            return compile_number(
+                v, path, &n.has_exclusive_minimum, &n.exclusive_minimum);
+        } else if (is_key(key, "exclusiveMaximum")) {
+            node& n = nodes[index];
+            return compile_number(
+                v, path, &n.has_exclusive_maximum, &n.exclusive_maximum);
+        } else if (is_key(key, "multipleOf")) {
+            node& n = nodes[index];
+            if (!compile_number(v, path, &n.has_multiple_of, &n.multiple_of)) {
+                return false;
+            }
+            if (n.multiple_of <= 0) {
+                return fail(path, "expected a positive number");
+            }
+        } else if (is_key(key, "minLength")) {
+            return compile_count(v, path, &nodes[index].min_length);
+        } else if (is_key(key, "maxLength")) {
+            return compile_count(v, path, &nodes[index].max_length);
+        } else if (is_key(key, "minItems")) {
+            return compile_count(v, path, &nodes[index].min_items);
+        } else if (is_key(key, "maxItems")) {
+            return compile_count(v, path, &nodes[index].max_items);
+        } else if (is_key(key, "uniqueItems")) {
+            if (!v.is_boolean()) {
+                return fail(path, "expected a boolean");
+            }
+            nodes[index].unique_items = v.get_boolean_value();
+        } else if (is_key(key, "prefixItems")) {
+            range r;
+            if (!compile_list(v, path, &r)) {
+                return false;
+            }
+            nodes[index].prefix_items = r;
+        } else if (is_key(key, "items")) {
+            size_t child;
+            if (!compile_subschema(v, path, &child)) {
+                return false;
+            }
+            nodes[index].items = child;
+        } else if (is_key(key, "contains")) {
+            size_t child;
+            if (!compile_subschema(v, path, &child)) {
+                return false;
+            }
+            nodes[index].contains = child;
+        } else if (is_key(key, "minProperties")) {
+            return compile_count(v, path, &nodes[index].min_properties);
+        } else if (is_key(key, "maxProperties")) {
+            return compile_count(v, path, &nodes[index].max_properties);
+        } else if (is_key(key, "properties")) {
+            return compile_properties(table, v, path);
+        } else if (is_key(key, "required")) {
+            return compile_required(index, table, v, path);
+        } else if (is_key(key, "additionalProperties")) {
+            size_t child;
+            if (!compile_subschema(v, path, &child)) {
+                return false;
+            }
+            nodes[index].additional_properties = child;
+        } else if (is_key(key, "allOf")) {
+            range r;
+            if (!compile_list(v, path, &r)) {
+                return false;
+            }
+            nodes[index].all_of = r;
+        } else if (is_key(key, "anyOf")) {
+            range r;
+            if (!compile_list(v, path, &r)) {
+                return false;
+            }
+            nodes[index].any_of = r;
+        } else if (is_key(key, "oneOf")) {
+            range r;
+            if (!compile_list(v, path, &r)) {
+                return false;
+            }
+            nodes[index].one_of = r;
+        } else if (is_key(key, "not")) {
+            size_t child;
+            if (!compile_subschema(v, path, &child)) {
+                return false;
+            }
+            nodes[index].not_ = child;
+        } else if (is_key(key, "if")) {
+            size_t child;
+            if (!compile_subschema(v, path, &child)) {
+                return false;
+            }
+            nodes[index].if_ = child;
+        } else if (is_key(key, "then")) {
+            size_t child;
+            if (!compile_subschema(v, path, &child)) {
+                return false;
+            }
+            nodes[index].then_ = child;
+        } else if (is_key(key, "else")) {
+            size_t child;
+            if (!compile_subschema(v, path, &child)) {
+                return false;
+            }
+            nodes[index].else_ = child;
+        } else if (is_key(key, "$ref")) {
+            return compile_ref(index, v, path);
+        } else if (
+            is_key(key, "pattern") || is_key(key, "patternProperties")
+            || is_key(key, "propertyNames") || is_key(key, "dependentSchemas")
+            || is_key(key, "dependentRequired")
+            || is_key(key, "unevaluatedItems")
+            || is_key(key, "unevaluatedProperties")
+            || is_key(key, "minContains") || is_key(key, "maxContains")
+            || is_key(key, "$dynamicRef")) {
+            return fail(path, "unsupported keyword");
+        }
+        return true;
+    }
+
+    // Validation.
+
+    static bool fail_at(validation_error* error, const char* keyword) {
+        if (error) {
+            error->instance_path.clear();
+            error->keyword = keyword;
+            error->detail.clear();
+        }
+        return false;
+    }
+
+    // Called as a failure unwinds out of a member or element, so paths are
+    // only built for the failure that is reported.
+    static bool prefix_key(validation_error* error, const string& key) {
+        if (error) {
+            error->instance_path
+                = child_path(std::string(), key) + error->instance_path;
+        }
+        return false;
+    }
+
+    static bool prefix_index(validation_error* error, size_t index) {
+        if (error) {
+            error->instance_path
+                = child_path(std::string(), index) + error->instance_path;
+        }
+        return false;
+    }
+
+    static unsigned type_bits(const value& v) {
+        switch (v.get_type()) {
+        case TYPE_NULL:
+            return null_bit;
+        case TYPE_FALSE:
+        case TYPE_TRUE:
+            return boolean_bit;
+        case TYPE_OBJECT:
+            return object_bit;
+        case TYPE_ARRAY:
+            return array_bit;
+        case TYPE_STRING:
+            return string_bit;
+        case TYPE_INTEGER:
+            return number_bit | integer_bit;
+        case TYPE_DOUBLE: {
+            const double d = v.get_double_value();
+            return number_bit | (floor(d) == d ? integer_bit : 0);
+        }
+        }
+        SAJSON_UNREACHABLE();
+    }
+
+    // Counts code points, as JSON Schema defines string length.
+    static size_t string_length(const value& v) {
+        const char* s = v.as_cstring();
+        const size_t length = v.get_string_length();
+        size_t count = 0;
+        for (size_t i = 0; i < length; ++i) {
+            count += (static_cast<unsigned char>(s[i]) & 0xC0) != 0x80;
+        }
+        return count;
+    }
+
+    bool check(size_t index, const value& v, validation_error* error) const {
+        const node& n = nodes[index];
+        if (n.always_false) {
+            return fail_at(error, "false");
+        }
+        if (n.types && !(type_bits(v) & n.types)) {
+            return fail_at(error, "type");
+        }
+        if (n.has_const && !n.const_value.equals(v)) {
+            return fail_at(error, "const");
+        }
+        if (n.enum_values.begin != n.enum_values.end) {
+            bool found = false;
+            for (size_t i = n.enum_values.begin; i < n.enum_values.end; ++i) {
+                if (enum_values[i].equals(v)) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                return fail_at(error, "enum");
+            }
+        }
+
+        switch (v.get_type()) {
+        case TYPE_INTEGER:
+        case TYPE_DOUBLE:
+            if (!check_number(n, v.get_number_value(), error)) {
+                return false;
+            }
+            break;
+        case TYPE_STRING:
+            if (n.min_length || n.max_length != none) {
+                const size_t length = string_length(v);
+                if (length < n.min_length) {
+                    return fail_at(error, "minLength");
+                }
+                if (length > n.max_length) {
+                    return fail_at(error, "maxLength");
+                }
+            }
+            break;
+        case TYPE_ARRAY:
+            if (!check_array(n, v, error)) {
+                return false;
+            }
+            break;
+        case TYPE_OBJECT:
+            if (!check_object(n, v, error)) {
+                return false;
+            }
+            break;
+        default:
+            break;
+        }
+
+        return check_combinators(n, v, error);
+    }
+
+    static bool
+    check_number(const node& n, double d, validation_error* error) {
+        if (n.has_minimum && d < n.minimum) {
+            return fail_at(error, "minimum");
+        }
+        if (n.has_maximum && d > n.maximum) {
+            return fail_at(error, "maximum");
+        }
+        if (n.has_exclusive_minimum && d <= n.exclusive_minimum) {
+            return fail_at(error, "exclusiveMinimum");
+        }
+        if (n.has_exclusive_maximum && d >= n.exclusive_maximum) {
+            return fail_at(error, "exclusiveMaximum");
+        }
+        if (n.has_multiple_of && !is_multiple_of(d, n.multiple_of)) {
+            return fail_at(error, "multipleOf");
+        }
+        return true;
+    }
+
+    static bool is_multiple_of(double d, double m) {
+        // fmod is exact, so integers need no tolerance.
+        if (floor(d) == d && floor(m) == m) {
+            return fmod(d, m) == 0;
+        }
+        // Decimal fractions are rarely exact in binary: 0.3 / 0.1 is
+        // 2.9999999999999996.  Allow a few ulps of rounding error.
+        const double quotient = d / m;
+        const double nearest = floor(quotient + 0.5);
+        return fabs(quotient - nearest) <= fabs(nearest) * 4 * DBL_EPSILON;
+    }
+
+    bool check_array(
+        const node& n, const value& v, validation_error* error) const {
+        const size_t length = v.get_length();
+        if (length < n.min_items) {
+            return fail_at(error, "minItems");
+        }
+        if (length > n.max_items) {
+            return fail_at(error, "maxItems");
+        }
+
+        const size_t prefix_count = n.prefix_items.end - n.prefix_items.begin;
+        size_t i = 0;
+        bool contains_found = n.contains == none;
+        for (const value& element : v.elements()) {
+            size_t child = i < prefix_count
+                ? subschemas[n.prefix_items.begin + i]
+                : n.items;
+            if (child != none && !check(child, element, error)) {
+                return prefix_index(error, i);
+            }
+            if (!contains_found && check(n.contains, element, 0)) {
+                contains_found = true;
+            }
+            ++i;
+        }
+        if (!contains_found) {
+            return fail_at(error, "contains");
+        }
+
+        if (n.unique_items) {
+            // Only elements with equal hashes need a deep comparison.
+            std::vector<std::pair<uint64_t, size_t>> hashes(length);
+            for (size_t a = 0; a < length; ++a) {
+                hashes[a] = std::make_pair(v.get_array_element(a).hash(), a);
+            }
+            std::sort(hashes.begin(), hashes.end());
+            for (size_t a = 0; a < length; ++a) {
+                for (size_t b = a + 1;
+                     b < length && hashes[b].first == hashes[a].first;
+                     ++b) {
+                    if (v.get_array_element(hashes[a].second)
+                            .equals(v.get_array_element(hashes[b].second))) {
+                        return fail_at(error, "uniqueItems");
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    bool check_object(
+        const node& n, const value& v, validation_error* error) const {
+        const size_t length = v.get_length();
+        if (length < n.min_properties) {
+            return fail_at(error, "minProperties");
+        }
+        if (length > n.max_properties) {
+            return fail_at(error, "maxProperties");
+        }
+        const bool has_table = n.properties.begin != n.properties.end;
+        if (!has_table && n.additional_properties == none) {
+            return true;
+        }
+
+        size_t required_seen = 0;
+        size_t last_required = none;
+#ifndef SAJSON_UNSORTED_OBJECT_KEYS
+        size_t p = n.properties.begin;
+#endif
+        for (auto it = v.members().begin(); it != v.members().end(); ++it) {
+            const string key = it.get_key();
+            size_t match = none;
+#ifdef SAJSON_UNSORTED_OBJECT_KEYS
+            // Members arrive in document order; binary search the table.
+            size_t low = n.properties.begin;
+            size_t high = n.properties.end;
+            while (low < high) {
+                const size_t middle = low + (high - low) / 2;
+                const int c = internal::compare_keys(
+                    properties[middle].get_key(), key);
+                if (c < 0) {
+                    low = middle + 1;
+                } else if (c > 0) {
+                    high = middle;
+                } else {
+                    match = middle;
+                    break;
+                }
+            }
+#else
+            // Members arrive sorted like the table; merge.
+            int c = 1;
+            while (p < n.properties.end
+                   && (c = internal::compare_keys(
+                           properties[p].get_key(), key))
+                       < 0) {
+                ++p;
+            }
+            if (p < n.properties.end && c == 0) {
+                match = p;
+            }
+#endif
+            size_t child = n.additional_properties;
+            if (match != none) {
+                const property& prop = properties[match];
+                if (prop.node != none) {
+                    child = prop.node;
+                }
+                if (prop.required && match != last_required) {
+                    ++required_seen;
+                    last_required = match;
+                }
+            }
+            if (child != none && !check(child, it.get_value(), error)) {
+                if (error && error->keyword == "false"
+                    && child == n.additional_properties) {
+                    error->keyword = "additionalProperties";
+                }
+                return prefix_key(error, key);
+            }
+        }
+
+        if (required_seen < n.required_count) {
+            for (size_t i = n.properties.begin; i < n.properties.end; ++i) {
+                if (properties[i].required
+                    && v.find_object_key(properties[i].get_key()) == length) {
+                    fail_at(error, "required");
+                    if (error) {
+                        error->detail = std::string(
+                            properties[i].key_data, properties[i].key_length);
+                    }
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool check_combinators(
+        const node& n, const value& v, validation_error* error) const {
+        if (n.ref != none && !check(n.ref, v, error)) {
+            return false;
+        }
+        for (size_t i = n.all_of.begin; i < n.all_of.end; ++i) {
+            if (!check(subschemas[i], v, error)) {
+                return false;
+            }
+        }
+        if (n.any_of.begin != n.any_of.end) {
+            bool any = false;
+            for (size_t i = n.any_of.begin; i < n.any_of.end && !any; ++i) {
+                any = check(subschemas[i], v, 0);
+            }
+            if (!any) {
+                return fail_at(error, "anyOf");
+            }
+        }
+        if (n.one_of.begin != n.one_of.end) {
+            size_t matches = 0;
+            for (size_t i = n.one_of.begin; i < n.one_of.end; ++i) {
+                matches += check(subschemas[i], v, 0);
+            }
+            if (matches != 1) {
+                return fail_at(error, "oneOf");
+            }
+        }
+        if (n.not_ != none && check(n.not_, v, 0)) {
+            return fail_at(error, "not");
+        }
+        if (n.if_ != none) {
+            const size_t branch = check(n.if_, v, 0) ? n.then_ : n.else_;
+            if (branch != none && !check(branch, v, error)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    value root;
+    std::vector<node> nodes;
+    std::vector<size_t> subschemas;
+    std::vector<property> properties;
+    std::vector<value> enum_values;
+    // Schema objects already compiled, by payload address.
+    std::vector<std::pair<const size_t*, size_t>> compiled;
+    // The schema path of each node, for compile errors found after the
+    // node was compiled.  Released once compiling finishes.
+    std::vector<std::string> node_paths;
+    std::string error_message;
+};
+
+} // namespace sajson
@@ -0,0 +1,812 @@
+#pragma once
+
+#include "sajson.h"
+
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define SAJSON_WRITER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+/**
+ * Serializing parsed documents back to JSON.
+ *
+ * write() produces minified JSON from a value.  It measures the output
+ * exactly before writing, so a std::string is sized once, and strings are
+ * copied in unescaped spans found sixteen bytes at a time where SSE2 is
+ * available.  writer builds JSON a value at a time with the same escaping
+ * and number formatting.
+ */
+namespace sajson {
+
+namespace internal {
+// The longest output of write_integer or write_double.
+static const size_t max_number_length = 32;
+
+#ifdef SAJSON_WRITER_SSE2
+inline unsigned lowest_set_bit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Returns the offset of the first character in [s, s + length) that must be
+// escaped, or length if there is none.
+inline size_t find_escape(const char* s, size_t length) {
+    size_t i = 0;
+#ifdef SAJSON_WRITER_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i last_control = _mm_set1_epi8(0x1F);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        const __m128i chunk
+            = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        // Saturating subtraction leaves zero exactly for bytes <= 0x1F.
+        const __m128i control
+            = _mm_cmpeq_epi8(_mm_subs_epu8(chunk, last_control), zero);
+        const __m128i special = _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+        const unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_or_si128(control, special)));
+        if (mask) {
+            return i + lowest_set_bit(mask);
+        }
+    }
+#endif
+    for (; i < length; ++i) {
+        if (must_escape(s[i])) {
+            return i;
+        }
+    }
+    return length;
+}
+
+// Returns the length of the escape sequence for c, which must be escaped.
+inline size_t escape_length(char c) {
+    switch (c) {
+    case '"':
+    case '\\':
+    case '\b':
+    case '\f':
+    case '\n':
+    case '\r':
+    case '\t':
+        return 2;
+    default:
+        return 6;
+    }
+}
+
+inline char* write_escape(char c, char* out) {
+    static const char hex[] = "0123456789abcdef";
+    out[0] = '\\';
+    switch (c) {
+    case '"':
+    case '\\':
+        out[1] = c;
+        return out + 2;
+    case '\b':
+        out[1] = 'b';
+        return out + 2;
+    case '\f':
+        out[1] = 'f';
+        return out + 2;
+    case '\n':
+        out[1] = 'n';
+        return out + 2;
+    case '\r':
+        out[1] = 'r';
+        return out + 2;
+    case '\t':
+        out[1] = 't';
+        return out + 2;
+    default:
+        out[1] = 'u';
+        out[2] = '0';
+        out[3] = '0';
+        out[4] = hex[(c >> 4) & 0xF];
+        out[5] = hex[c & 0xF];
+        return out + 6;
+    }
+}
+
+// Returns the length of s written as a quoted JSON string.
+inline size_t quoted_length(const char* s, size_t length) {
+    size_t total = length + 2;
+    size_t i = find_escape(s, length);
+    while (i < length) {
+        total += escape_length(s[i]) - 1;
+        ++i;
+        i += find_escape(s + i, length - i);
+    }
+    return total;
+}
+
+inline char* write_quoted(const char* s, size_t length, char* out) {
+    *out++ = '"';
+    for (;;) {
+        const size_t span = find_escape(s, length);
+        memcpy(out, s, span);
+        out += span;
+        if (span == length) {
+            break;
+        }
+        out = write_escape(s[span], out);
+        s += span + 1;
+        length -= span + 1;
+    }
+    *out++ = '"';
+    return out;
+}
+
+inline size_t integer_length(int64_t i) {
+    uint64_t magnitude = i < 0 ? 0 - static_cast<uint64_t>(i) : i;
+    size_t length = i < 0 ? 2 : 1;
+    while (magnitude >= 10) {
+        magnitude /= 10;
+        ++length;
+    }
+    return length;
+}
+
+// Writes i in decimal, two digits at a time, and returns the end.
+inline char* write_integer(int64_t i, char* out) {
+    static const char pairs[]
+        = "00010203040506070809101112131415161718192021222324"
+          "25262728293031323334353637383940414243444546474849"
+          "50515253545556575859606162636465666768697071727374"
+          "75767778798081828384858687888990919293949596979899";
+    uint64_t magnitude = i < 0 ? 0 - static_cast<uint64_t>(i) : i;
+    if (i < 0) {
+        *out++ = '-';
+    }
+    char buffer[20];
+    char* p = buffer + sizeof(buffer);
+    while (magnitude >= 100) {
+        const unsigned pair = static_cast<unsigned>(magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = pairs[pair + 1];
+        *--p = pairs[pair];
+    }
+    if (magnitude >= 10) {
+        const unsigned pair = static_cast<unsigned>(magnitude) * 2;
+        *--p = pairs[pair + 1];
+        *--p = pairs[pair];
+    } else {
+        *--p = static_cast<char>('0' + magnitude);
+    }
+    const size_t length = buffer + sizeof(buffer) - p;
+    memcpy(out, p, length);
+    return out + length;
+}
+
+// Finds the shortest decimal digits * 10^exponent that parses back to the
+// positive finite double with the given bits, choosing the closest such
+// decimal when several have the fewest digits.  This is Ryu's d2d, using the
+// tables decimal_to_double parses with.
+inline void shortest_decimal(uint64_t bits, uint64_t& digits, int& exponent) {
+    const uint64_t ieee_mantissa
+        = bits & ((uint64_t(1) << DOUBLE_MANTISSA_BITS) - 1);
+    const int ieee_exponent = static_cast<int>(bits >> DOUBLE_MANTISSA_BITS);
+
+    // Work in units of a quarter ulp, so the halfway points to the
+    // neighbouring doubles are integers.
+    int e2;
+    uint64_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = ieee_exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = (uint64_t(1) << DOUBLE_MANTISSA_BITS) | ieee_mantissa;
+    }
+    // Ties round to even, so an even mantissa owns its halfway points.
+    const bool accept_bounds = (m2 & 1) == 0;
+    const uint64_t mv = 4 * m2;
+    // The gap below is half as wide at a power of two.
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    // Scale the value and its bounds to decimal: vr, vp, and vm are
+    // mv, mv + 2, and mv - 1 - mm_shift times 2^e2 / 10^e10.
+    uint64_t vr, vp, vm;
+    int e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    if (e2 >= 0) {
+        const int q = log10_pow2(e2) - (e2 > 3);
+        e10 = q;
+        const int k = POW5_INV_BITCOUNT + pow5_bits(q) - 1;
+        const int i = -e2 + q + k;
+        const uint64_t* factor = globals::pow5_inv_split[q];
+        vr = mul_shift(mv, factor, i);
+        vp = mul_shift(mv + 2, factor, i);
+        vm = mul_shift(mv - 1 - mm_shift, factor, i);
+        if (q <= 21) {
+            // Only one of mp, mv, and mm can be a multiple of 5, if any.
+            if (mv % 5 == 0) {
+                vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_is_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= multiple_of_pow5(mv + 2, q);
+            }
+        }
+    } else {
+        const int q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = q + e2;
+        const int i = -e2 - q;
+        const int k = pow5_bits(i) - POW5_BITCOUNT;
+        const int j = q - k;
+        const uint64_t* factor = globals::pow5_split[i];
+        vr = mul_shift(mv, factor, j);
+        vp = mul_shift(mv + 2, factor, j);
+        vm = mul_shift(mv - 1 - mm_shift, factor, j);
+        if (q <= 1) {
+            // mv has at least two trailing zero bits, so vr is exact.
+            vr_is_trailing_zeros = true;
+            if (accept_bounds) {
+                vm_is_trailing_zeros = mm_shift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 63) {
+            vr_is_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    // Drop digits while the interval still holds a shorter decimal.
+    int removed = 0;
+    uint64_t output;
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+        // Exact bounds and ties need the general loop.
+        int last_removed_digit = 0;
+        while (vp / 10 > vm / 10) {
+            vm_is_trailing_zeros = vm_is_trailing_zeros && vm % 10 == 0;
+            vr_is_trailing_zeros
+                = vr_is_trailing_zeros && last_removed_digit == 0;
+            last_removed_digit = static_cast<int>(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        if (vm_is_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_is_trailing_zeros
+                    = vr_is_trailing_zeros && last_removed_digit == 0;
+                last_removed_digit = static_cast<int>(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            // Exactly halfway: round to even.
+            last_removed_digit = 4;
+        }
+        output = vr
+            + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros))
+               || last_removed_digit >= 5);
+    } else {
+        bool round_up = false;
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    digits = output;
+    exponent = e10 + removed;
+}
+
+// Writes d as the shortest decimal that parses back to the same double and
+// returns the end.  Integral values get a fractional part so they parse as
+// doubles.  Like JavaScript, exponents are used only for values of at least
+// 1e21 or less than 1e-6.  Infinities, which sajson produces for
+// out-of-range exponents, are written as out-of-range literals; NaN, which it
+// never produces, as null.
+inline char* write_double(double d, char* out) {
+    if (d != d) {
+        memcpy(out, "null", 4);
+        return out + 4;
+    }
+    if (d == std::numeric_limits<double>::infinity()) {
+        memcpy(out, "1e999", 5);
+        return out + 5;
+    }
+    if (d == -std::numeric_limits<double>::infinity()) {
+        memcpy(out, "-1e999", 6);
+        return out + 6;
+    }
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    if (bits >> 63) {
+        *out++ = '-';
+        bits &= ~(uint64_t(1) << 63);
+    }
+    if (bits == 0) {
+        memcpy(out, "0.0", 3);
+        return out + 3;
+    }
+
+    uint64_t digits;
+    int exponent;
+    shortest_decimal(bits, digits, exponent);
+    // Write the digits, then move them around the decimal point.
+    const int length = static_cast<int>(
+        write_integer(static_cast<int64_t>(digits), out) - out);
+    const int point = length + exponent;
+    if (exponent >= 0 && point <= 21) {
+        memset(out + length, '0', exponent);
+        memcpy(out + point, ".0", 2);
+        return out + point + 2;
+    }
+    if (point > 0 && point <= 21) {
+        memmove(out + point + 1, out + point, length - point);
+        out[point] = '.';
+        return out + length + 1;
+    }
+    if (point > -6 && point <= 0) {
+        memmove(out + 2 - point, out, length);
+        memcpy(out, "0.", 2);
+        memset(out + 2, '0', -point);
+        return out + 2 - point + length;
+    }
+    if (length > 1) {
+        memmove(out + 2, out + 1, length - 1);
+        out[1] = '.';
+        out += length + 1;
+    } else {
+        out += 1;
+    }
+    *out++ = 'e';
+    return write_integer(point - 1, out);
+}
+
+inline size_t double_length(double d) {
+    char buffer[max_number_length];
+    return write_double(d, buffer) - buffer;
+}
+
+inline size_t write_length(const value& v) {
+    switch (v.get_type()) {
+    case TYPE_NULL:
+    case TYPE_TRUE:
+        return 4;
+    case TYPE_FALSE:
+        return 5;
+    case TYPE_INTEGER:
+        return integer_length(v.get_integer_value());
+    case TYPE_DOUBLE:
+        return double_length(v.get_double_value());
+    case TYPE_STRING:
+        return quoted_length(v.as_cstring(), v.get_string_length());
+    case TYPE_ARRAY: {
+        const size_t length = v.get_length();
+        // Brackets and commas.
+        size_t total = length ? length + 1 : 2;
+        for (size_t i = 0; i < length; ++i) {
+            total += write_length(v.get_array_element(i));
+        }
+        return total;
+    }
+    case TYPE_OBJECT: {
+        const size_t length = v.get_length();
+        // Braces, commas, and colons.
+        size_t total = length ? 2 * length + 1 : 2;
+        for (size_t i = 0; i < length; ++i) {
+            const string key = v.get_object_key(i);
+            total += quoted_length(key.data(), key.length());
+            total += write_length(v.get_object_value(i));
+        }
+        return total;
+    }
+    }
+    SAJSON_UNREACHABLE();
+}
+
+inline char* write_value(const value& v, char* out) {
+    switch (v.get_type()) {
+    case TYPE_NULL:
+        memcpy(out, "null", 4);
+        return out + 4;
+    case TYPE_FALSE:
+        memcpy(out, "false", 5);
+        return out + 5;
+    case TYPE_TRUE:
+        memcpy(out, "true", 4);
+        return out + 4;
+    case TYPE_INTEGER:
+        return write_integer(v.get_integer_value(), out);
+    case TYPE_DOUBLE:
+        return write_double(v.get_double_value(), out);
+    case TYPE_STRING:
+        return write_quoted(v.as_cstring(), v.get_string_length(), out);
+    case TYPE_ARRAY: {
+        const size_t length = v.get_length();
+        *out++ = '[';
+        for (size_t i = 0; i < length; ++i) {
+            if (i) {
+                *out++ = ',';
+            }
+            out = write_value(v.get_array_element(i), out);
+        }
+        *out++ = ']';
+        return out;
+    }
+    case TYPE_OBJECT: {
+        const size_t length = v.get_length();
+        *out++ = '{';
+        for (size_t i = 0; i < length; ++i) {
+            if (i) {
+                *out++ = ',';
+            }
+            const string key = v.get_object_key(i);
+            out = write_quoted(key.data(), key.length(), out);
+            *out++ = ':';
+            out = write_value(v.get_object_value(i), out);
+        }
+        *out++ = '}';
+        return out;
+    }
+    }
+    SAJSON_UNREACHABLE();
+}
+} // namespace internal
+
+/// Returns the exact number of bytes write() produces for v.
+inline size_t get_write_length(const value& v) {
+    return internal::write_length(v);
+}
+
+/// Writes v as minified JSON into out, which must have room for
+/// get_write_length(v) bytes.  Returns the number of bytes written.  Object
+/// members are written in the order sajson stores them.
+inline size_t write(const value& v, char* out) {
+    return internal::write_value(v, out) - out;
+}
+
+/// Appends v as minified JSON to out.
+inline void write(const value& v, std::string& out) {
+    const size_t offset = out.size();
+    const size_t length = get_write_length(v);
+    out.resize(offset + length);
+    const size_t written = write(v, &out[offset]);
+    assert(written == length);
+    (void)written;
+}
+
+/**
+ * Builds JSON by pushing values one at a time.
+ *
+ * A writer either grows its own buffer, read with get_output(), or fills a
+ * buffer the caller provides and hands each full chunk to a flush
+ * function.  Neither allocates per value: the owned buffer grows
+ * geometrically and the nesting stack only when a document is deeper than
+ * any before it.
+ *
+ * Calls must describe a single well-formed value, with key() before each
+ * value in an object.  Misuse is caught by assertions, not reported.
+ *
+ *     sajson::writer w;
+ *     w.begin_object();
+ *     w.key("id");
+ *     w.int64(7);
+ *     w.key("tags");
+ *     w.begin_array();
+ *     w.string("a");
+ *     w.end_array();
+ *     w.end_object();
+ *     // w.get_output() is {"id":7,"tags":["a"]}
+ */
+class writer {
+public:
+    /// Called with each full chunk, and the rest from finish().
+    typedef void (*flush_function)(
+        void* context, const char* data, size_t length);
+
+    /// The smallest buffer a caller may provide.
+    static const size_t min_capacity = internal::max_number_length;
+
+    /// Writes into a buffer owned by the writer.  If indent is nonzero,
+    /// pretty-prints with that many spaces per level.
+    explicit writer(unsigned indent_ = 0)
+        : begin(0)
+        , cursor(0)
+        , end(0)
+        , flush(0)
+        , context(0)
+        , indent(indent_)
+        , after_key(false) {}
+
+    /// Writes into [buffer, buffer + capacity), passing the contents to
+    /// flush whenever it fills.  Call finish() to flush the remainder.
+    writer(
+        char* buffer,
+        size_t capacity,
+        flush_function flush_,
+        void* context_,
+        unsigned indent_ = 0)
+        : begin(buffer)
+        , cursor(buffer)
+        , end(buffer + capacity)
+        , flush(flush_)
+        , context(context_)
+        , indent(indent_)
+        , after_key(false) {
+        assert(flush && capacity >= min_capacity);
+    }
+
+    writer(const writer&) = delete;
+    void operator=(const writer&) = delete;
+
+    void begin_object() { open('{', object_level); }
+
+    void end_object() { close('}', object_level); }
+
+    void begin_array() { open('[', array_level); }
+
+    void end_array() { close(']', array_level); }
+
+    /// Writes the key for the next value in the current object.
+    void key(const sajson::string& k) {
+        assert(!levels.empty() && (levels.back() & object_level));
+        assert(!after_key);
+        next_element();
+        quoted(k.data(), k.length());
+        put(':');
+        if (indent) {
+            put(' ');
+        }
+        after_key = true;
+    }
+
+    void key(const char* k) { key(sajson::string(k, strlen(k))); }
+
+    void string(const sajson::string& s) {
+        separate();
+        quoted(s.data(), s.length());
+    }
+
+    void string(const char* s) { string(sajson::string(s, strlen(s))); }
+
+    void int64(int64_t i) {
+        separate();
+        reserve(internal::max_number_length);
+        cursor = internal::write_integer(i, cursor);
+    }
+
+    void double_(double d) {
+        separate();
+        reserve(internal::max_number_length);
+        cursor = internal::write_double(d, cursor);
+    }
+
+    void boolean(bool b) {
+        separate();
+        if (b) {
+            append("true", 4);
+        } else {
+            append("false", 5);
+        }
+    }
+
+    void null() {
+        separate();
+        append("null", 4);
+    }
+
+    /// Writes a parsed value, which may be an array or object.
+    void value(const sajson::value& v) {
+        switch (v.get_type()) {
+        case TYPE_NULL:
+            return null();
+        case TYPE_FALSE:
+            return boolean(false);
+        case TYPE_TRUE:
+            return boolean(true);
+        case TYPE_INTEGER:
+            return int64(v.get_integer_value());
+        case TYPE_DOUBLE:
+            return double_(v.get_double_value());
+        case TYPE_STRING:
+            return string(
+                sajson::string(v.as_cstring(), v.get_string_length()));
+        case TYPE_ARRAY:
+            begin_array();
+            for (size_t i = 0; i < v.get_length(); ++i) {
+                value(v.get_array_element(i));
+            }
+            return end_array();
+        case TYPE_OBJECT:
+            begin_object();
+            for (size_t i = 0; i < v.get_length(); ++i) {
+                key(v.get_object_key(i));
+                value(v.get_object_value(i));
+            }
+            return end_object();
+        }
+        SAJSON_UNREACHABLE();
+    }
+
+    /// Writes text, which must be a single JSON value, as the next value
+    /// without reformatting it, such as a subtree sliced from its source
+    /// with value::get_source_start().
+    void raw(const sajson::string& json) {
+        separate();
+        append(json.data(), json.length());
+    }
+
+    /// Passes any buffered output to the flush function.
+    void finish() {
+        assert(levels.empty() && !after_key);
+        if (flush && cursor != begin) {
+            flush(context, begin, cursor - begin);
+            cursor = begin;
+        }
+    }
+
+    /// Returns everything written so far.  Only for writers that own their
+    /// buffer.
+    sajson::string get_output() const {
+        assert(!flush);
+        return sajson::string(begin, cursor - begin);
+    }
+
+    /// Discards the output and starts a new document, keeping the buffer.
+    void reset() {
+        cursor = begin;
+        levels.clear();
+        after_key = false;
+    }
+
+private:
+    enum level_bits {
+        object_level = 1,
+        array_level = 2,
+        has_elements = 4,
+    };
+
+    // Writes whatever precedes a value.
+    void separate() {
+        if (after_key) {
+            after_key = false;
+            return;
+        }
+        assert(levels.empty() || (levels.back() & array_level));
+        next_element();
+    }
+
+    // Writes the comma and indentation before an array element or key.
+    void next_element() {
+        if (levels.empty()) {
+            return;
+        }
+        unsigned char& level = levels.back();
+        if (level & has_elements) {
+            put(',');
+        }
+        level |= has_elements;
+        if (indent) {
+            newline(levels.size());
+        }
+    }
+
+    void open(char bracket, level_bits kind) {
+        separate();
+        put(bracket);
+        levels.push_back(static_cast<unsigned char>(kind));
+    }
+
+    void close(char bracket, level_bits kind) {
+        assert(!levels.empty() && (levels.back() & kind) && !after_key);
+        (void)kind;
+        const bool had_elements = (levels.back() & has_elements) != 0;
+        levels.pop_back();
+        if (indent && had_elements) {
+            newline(levels.size());
+        }
+        put(bracket);
+    }
+
+    void newline(size_t depth) {
+        static const char spaces[] = "                                ";
+        put('\n');
+        size_t count = depth * indent;
+        while (count) {
+            const size_t n = std::min(count, sizeof(spaces) - 1);
+            append(spaces, n);
+            count -= n;
+        }
+    }
+
+    void quoted(const char* s, size_t length) {
+        put('"');
+        for (;;) {
+            const size_t span = internal::find_escape(s, length);
+            append(s, span);
+            if (span == length) {
+                break;
+            }
+            reserve(6);
+            cursor = internal::write_escape(s[span], cursor);
+            s += span + 1;
+            length -= span + 1;
+        }
+        put('"');
+    }
+
+    void put(char c) {
+        reserve(1);
+        *cursor++ = c;
+    }
+
+    // Copies data, flushing as many times as needed.
+    void append(const char* data, size_t length) {
+        while (SAJSON_UNLIKELY(static_cast<size_t>(end - cursor) < length)) {
+            if (!flush) {
+                grow(length);
+                break;
+            }
+            const size_t part = end - cursor;
+            memcpy(cursor, data, part);
+            cursor += part;
+            data += part;
+            length -= part;
+            flush_buffer();
+        }
+        memcpy(cursor, data, length);
+        cursor += length;
+    }
+
+    // Makes room for length contiguous bytes, at most min_capacity.
+    void reserve(size_t length) {
+        if (SAJSON_UNLIKELY(static_cast<size_t>(end - cursor) < length)) {
+            if (flush) {
+                flush_buffer();
+            } else {
+                grow(length);
+            }
+        }
+    }
+
+    void flush_buffer() {
+        flush(context, begin, cursor - begin);
+        cursor = begin;
+    }
+
+    void grow(size_t length) {
+        const size_t used = cursor - begin;
+        owned.resize(std::max(2 * owned.size(), used + length + 256));
+        begin = &owned[0];
+        cursor = begin + used;
+        end = begin + owned.size();
+    }
+
+    char* begin;
+    char* cursor;
+    char* end;
+    flush_function flush;
+    void* context;
+    unsigned indent;
+    bool after_key;
+    std::vector<unsigned char> levels;
+    std::vector<char> owned;
+};
+
+} // namespace sajson
@@ -2,6 +2,8 @@
 #include <sajson.h>
 #include <sajson_ostream.h>
 
+#include <vector>
+
 #include <UnitTest++.h>
 
 using sajson::document;
@@ -347,6 +349,33 @@ SUITE(doubles) {
         CHECK_EQUAL(10e22, e2.get_double_value());
     }
 
+    ABSTRACT_TEST(correctly_rounded) {
+        const sajson::document& document = parse(
+            literal("[0.3,2.2250738585072011e-308,4.9406564584124654e-324,"
+                    "1.7976931348623157e308,0.30000000000000004,"
+                    "9007199254740993.0,123456789012345678901234567890]"));
+        assert(success(document));
+        const value& root = document.get_root();
+        CHECK_EQUAL(7u, root.get_length());
+        CHECK_EQUAL(0.3, root.get_array_element(0).get_double_value());
+        CHECK_EQUAL(
+            2.2250738585072011e-308,
+            root.get_array_element(1).get_double_value());
+        CHECK_EQUAL(
+            4.9406564584124654e-324,
+            root.get_array_element(2).get_double_value());
+        CHECK_EQUAL(
+            1.7976931348623157e308,
+            root.get_array_element(3).get_double_value());
+        CHECK_EQUAL(
+            0.30000000000000004, root.get_array_element(4).get_double_value());
+        CHECK_EQUAL(
+            9007199254740992.0, root.get_array_element(5).get_double_value());
+        CHECK_EQUAL(
+            1.2345678901234568e29,
+            root.get_array_element(6).get_double_value());
+    }
+
     ABSTRACT_TEST(long_no_exponent) {
         const sajson::document& document
             = parse(literal("[9999999999,99999999999]"));
@@ -825,6 +854,403 @@ SUITE(objects) {
         const size_t index_prefix = root.find_object_key(literal("prefix"));
         CHECK_EQUAL(1U, index_prefix);
     }
+
+    ABSTRACT_TEST(get_values_of_keys) {
+        const sajson::document& document = parse(
+            literal("{\"id\":1,\"b\":2,\"name\":3,\"x\":4,\"aa\":5,"
+                    "\"zzz\":6,\"type\":7,\"k\":8,\"repo\":9}"));
+        assert(success(document));
+        const value& root = document.get_root();
+
+        const sajson::string keys[] = {
+            literal("a"),
+            literal("b"),
+            literal("k"),
+            literal("aa"),
+            literal("id"),
+            literal("zzz"),
+            literal("name"),
+            literal("repo"),
+            literal("zzzzz"),
+        };
+        const size_t n = sizeof(keys) / sizeof(*keys);
+        value out[n];
+        root.get_values_of_keys(keys, n, out);
+
+        const int expected[n] = { -1, 2, 8, 5, 1, 6, 3, 9, -1 };
+        for (size_t i = 0; i < n; ++i) {
+            if (expected[i] < 0) {
+                CHECK_EQUAL(TYPE_NULL, out[i].get_type());
+            } else {
+                CHECK_EQUAL(TYPE_INTEGER, out[i].get_type());
+                CHECK_EQUAL(expected[i], out[i].get_integer_value());
+            }
+        }
+    }
+
+    ABSTRACT_TEST(get_values_of_keys_matches_single_lookups) {
+        // Enough keys that galloping takes several doubling steps.
+        const sajson::document& document = parse(
+            literal("{\"a\":0,\"b\":1,\"c\":2,\"d\":3,\"e\":4,\"f\":5,"
+                    "\"g\":6,\"h\":7,\"i\":8,\"j\":9,\"ab\":10,"
+                    "\"abc\":11}"));
+        assert(success(document));
+        const value& root = document.get_root();
+
+        // Keys are stored sorted, so a subset of the stored keys in order
+        // is sorted too.
+        sajson::string keys[] = {
+            root.get_object_key(0),
+            root.get_object_key(3),
+            root.get_object_key(6),
+            root.get_object_key(9),
+            root.get_object_key(11),
+        };
+        const size_t n = sizeof(keys) / sizeof(*keys);
+        value out[n];
+        root.get_values_of_keys(keys, n, out);
+        for (size_t i = 0; i < n; ++i) {
+            const value& expected = root.get_value_of_key(keys[i]);
+            CHECK_EQUAL(TYPE_INTEGER, out[i].get_type());
+            CHECK_EQUAL(
+                expected.get_integer_value(), out[i].get_integer_value());
+        }
+    }
+}
+
+SUITE(ranges) {
+    ABSTRACT_TEST(array_elements) {
+        const sajson::document& document
+            = parse(literal("[0, \"one\", [2], {}, null]"));
+        assert(success(document));
+        const value& root = document.get_root();
+
+        size_t count = 0;
+        for (const value& element : root.elements()) {
+            const value& expected = root.get_array_element(count);
+            CHECK_EQUAL(expected.get_type(), element.get_type());
+            CHECK_EQUAL(
+                expected._internal_get_payload(),
+                element._internal_get_payload());
+            ++count;
+        }
+        CHECK_EQUAL(5u, count);
+        CHECK_EQUAL(5u, root.elements().size());
+
+        auto it = root.elements().begin();
+        CHECK_EQUAL(0, (*it++).get_integer_value());
+        CHECK_EQUAL("one", (*it).as_string());
+        ++it;
+        CHECK_EQUAL(1u, (*it).get_length());
+    }
+
+    ABSTRACT_TEST(empty_array_elements) {
+        const sajson::document& document = parse(literal("[]"));
+        assert(success(document));
+        const auto& elements = document.get_root().elements();
+        CHECK(elements.begin() == elements.end());
+        CHECK_EQUAL(0u, elements.size());
+    }
+
+    ABSTRACT_TEST(object_members) {
+        const sajson::document& document
+            = parse(literal("{\"b\": 1, \"aa\": [2], \"c\": \"three\"}"));
+        assert(success(document));
+        const value& root = document.get_root();
+
+        size_t count = 0;
+        for (const auto& member : root.members()) {
+            const string& key = root.get_object_key(count);
+            CHECK_EQUAL(key.as_string(), member.first.as_string());
+            CHECK_EQUAL(
+                root.get_object_value(count)._internal_get_payload(),
+                member.second._internal_get_payload());
+            ++count;
+        }
+        CHECK_EQUAL(3u, count);
+        CHECK_EQUAL(3u, root.members().size());
+
+        auto it = root.members().begin();
+        for (; it != root.members().end(); ++it) {
+            if (it.get_key().as_string() == "aa") {
+                break;
+            }
+        }
+        CHECK(it != root.members().end());
+        CHECK_EQUAL(TYPE_ARRAY, it.get_value().get_type());
+        CHECK_EQUAL(2, it.get_value().get_array_element(0).get_integer_value());
+    }
+
+    ABSTRACT_TEST(empty_object_members) {
+        const sajson::document& document = parse(literal("{}"));
+        assert(success(document));
+        const auto& members = document.get_root().members();
+        CHECK(members.begin() == members.end());
+        CHECK_EQUAL(0u, members.size());
+    }
+
+    ABSTRACT_TEST(nested_ranges) {
+        const sajson::document& document
+            = parse(literal("[{\"a\": [1, 2]}, {\"a\": [3]}]"));
+        assert(success(document));
+
+        int sum = 0;
+        for (const value& object : document.get_root().elements()) {
+            for (const auto& member : object.members()) {
+                for (const value& n : member.second.elements()) {
+                    sum += n.get_integer_value();
+                }
+            }
+        }
+        CHECK_EQUAL(6, sum);
+    }
+}
+
+namespace {
+std::string source_of(const std::string& text, const value& v) {
+    return text.substr(
+        v.get_source_start(), v.get_source_end() - v.get_source_start());
+}
+
+void check_source_ranges(const document& document, const std::string& text) {
+    assert(success(document));
+    CHECK(document.has_source_ranges());
+    const value& root = document.get_root();
+    CHECK(root.has_source_range());
+    CHECK_EQUAL(text.substr(2, text.size() - 4), source_of(text, root));
+
+    const value& a = root.get_value_of_key(literal("a"));
+    CHECK_EQUAL("[1, -2.5e3, \"x\\ny\\u00e9\", [ ]]", source_of(text, a));
+    CHECK_EQUAL("1", source_of(text, a.get_array_element(0)));
+    CHECK_EQUAL("-2.5e3", source_of(text, a.get_array_element(1)));
+    CHECK_EQUAL("\"x\\ny\\u00e9\"", source_of(text, a.get_array_element(2)));
+    CHECK_EQUAL("[ ]", source_of(text, a.get_array_element(3)));
+
+    const value& b = root.get_value_of_key(literal("b"));
+    CHECK_EQUAL("{\"c\" : null}", source_of(text, b));
+    CHECK_EQUAL("null", source_of(text, b.get_object_value(0)));
+    CHECK_EQUAL("true", source_of(text, root.get_value_of_key(literal("d"))));
+
+    // Ranges survive iteration and the unescaped payload is unaffected.
+    auto it = a.elements().begin();
+    ++it;
+    ++it;
+    CHECK_EQUAL("\"x\\ny\\u00e9\"", source_of(text, *it));
+    CHECK_EQUAL("x\ny\xc3\xa9", (*it).as_string());
+    for (const auto& member : root.members()) {
+        CHECK(member.second.has_source_range());
+    }
+}
+
+const char* const source_range_text
+    = "  {\"b\": {\"c\" : null}, \"a\": [1, -2.5e3, \"x\\ny\\u00e9\", [ ]],"
+      "\n\"d\":true}  ";
+} // namespace
+
+SUITE(source_ranges) {
+    TEST(single_allocation_records_source_ranges) {
+        const std::string text = source_range_text;
+        check_source_ranges(
+            sajson::parse_with_source_ranges(
+                sajson::single_allocation(), string(text.data(), text.size())),
+            text);
+    }
+
+    TEST(dynamic_allocation_records_source_ranges) {
+        const std::string text = source_range_text;
+        check_source_ranges(
+            sajson::parse_with_source_ranges(
+                sajson::dynamic_allocation(),
+                string(text.data(), text.size())),
+            text);
+    }
+
+    TEST(bounded_allocation_records_source_ranges) {
+        const std::string text = source_range_text;
+        check_source_ranges(
+            sajson::parse_with_source_ranges(
+                sajson::bounded_allocation(ast_buffer, ast_buffer_size),
+                string(text.data(), text.size())),
+            text);
+    }
+
+    TEST(plain_parse_has_no_source_ranges) {
+        const document& document
+            = sajson::parse(sajson::single_allocation(), literal("[0]"));
+        assert(success(document));
+        CHECK(!document.has_source_ranges());
+        CHECK(!document.get_root().has_source_range());
+        CHECK(!document.get_root().get_array_element(0).has_source_range());
+    }
+
+    TEST(single_allocation_worst_case_fits) {
+        // Each of these packs the most values into the fewest bytes.
+        const char* const texts[] = { "[0]", "[[]]", "[0,0,0,0,0,0,0]",
+                                      "[[[[[[[[]]]]]]]]", "[{},[],\"\",0]",
+                                      "{\"\":0,\"\":[0]}" };
+        for (const char* text : texts) {
+            const size_t length = strlen(text);
+            std::vector<size_t> buffer(2 * length + 1);
+            const document& document = sajson::parse_with_source_ranges(
+                sajson::single_allocation(buffer.data(), buffer.size()),
+                string(text, length));
+            assert(success(document));
+            CHECK_EQUAL(0u, document.get_root().get_source_start());
+            CHECK_EQUAL(length, document.get_root().get_source_end());
+        }
+    }
+
+    TEST(single_allocation_too_small_for_source_ranges) {
+        size_t buffer[4];
+        const document& document = sajson::parse_with_source_ranges(
+            sajson::single_allocation(buffer), literal("[0]"));
+        CHECK(!document.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_OUT_OF_MEMORY, document._internal_get_error_code());
+    }
+}
+
+SUITE(equality) {
+    TEST(equal_content_is_equal_and_hashes_alike) {
+        // Two documents, so not an ABSTRACT_TEST: bounded_allocation would
+        // parse both into the same buffer.
+        const document a = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"b\": [1, 2.5, -0], \"a\": \"caf\\u00e9\","
+                    " \"c\": {\"x\": null}}"));
+        const document b = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{ \"c\":{\"x\":null}, \"a\":\"caf\xc3\xa9\","
+                    " \"b\":[1.0,25e-1,0] }"));
+        assert(success(a));
+        assert(success(b));
+        CHECK(a.get_root().equals(b.get_root()));
+        CHECK(b.get_root().equals(a.get_root()));
+        CHECK_EQUAL(a.get_root().hash(), b.get_root().hash());
+    }
+
+    TEST(different_content_is_unequal) {
+        const char* const texts[] = {
+            "[[1, 2]]",      "[[2, 1]]",      "[[]]",
+            "[{}]",          "[\"\"]",          "[null]",
+            "[false]",       "[true]",        "[0]",
+            "[1]",           "[\"ab\"]",        "[\"ba\"]",
+            "[{\"a\": 1}]",   "[{\"a\": 2}]",   "[{\"b\": 1}]",
+            "[{\"a\": 1, \"b\": 2}]",
+        };
+        const size_t count = sizeof(texts) / sizeof(texts[0]);
+        std::vector<document> documents;
+        for (size_t i = 0; i < count; ++i) {
+            documents.push_back(sajson::parse(
+                sajson::dynamic_allocation(),
+                string(texts[i], strlen(texts[i]))));
+            assert(success(documents.back()));
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const value& a = documents[i].get_root().get_array_element(0);
+            for (size_t j = 0; j < count; ++j) {
+                const value& b = documents[j].get_root().get_array_element(0);
+                CHECK_EQUAL(i == j, a.equals(b));
+                CHECK_EQUAL(i == j, a.hash() == b.hash());
+            }
+        }
+    }
+
+    TEST(duplicate_keys_are_compared_pairwise) {
+        const document a = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"a\": 1, \"b\": 0, \"a\": 1}"));
+        const document b = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"a\": 1, \"a\": 2, \"b\": 0}"));
+        assert(success(a));
+        assert(success(b));
+        CHECK(!a.get_root().equals(b.get_root()));
+        CHECK(!b.get_root().equals(a.get_root()));
+        CHECK(a.get_root().hash() != b.get_root().hash());
+
+        const document c = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"a\": 1, \"b\": 0, \"a\": 2}"));
+        assert(success(c));
+        CHECK(b.get_root().equals(c.get_root()));
+        CHECK(c.get_root().equals(b.get_root()));
+        CHECK_EQUAL(b.get_root().hash(), c.get_root().hash());
+    }
+
+    ABSTRACT_TEST(hashes_are_stable) {
+        // Changing these values breaks stored hashes.
+        const sajson::document& short_values
+            = parse(literal("[null, true, \"abc\", {\"k\": 1}]"));
+        assert(success(short_values));
+        CHECK_EQUAL(0xc6894da37c5a4b6fULL, short_values.get_root().hash());
+
+        const sajson::document& long_string = parse(literal(
+            "[\"a string long enough to take the three-lane path of the "
+            "byte hash\"]"));
+        assert(success(long_string));
+        CHECK_EQUAL(0x4a754bc8161663ffULL, long_string.get_root().hash());
+    }
+}
+
+namespace {
+struct describing_visitor {
+    std::string visit_null() { return "null"; }
+
+    std::string visit_boolean(bool b) { return b ? "true" : "false"; }
+
+    std::string visit_integer(int i) { return "i" + std::to_string(i); }
+
+    std::string visit_double(double d) {
+        return "d" + std::to_string(static_cast<int>(d * 10));
+    }
+
+    std::string visit_string(const string& s) {
+        return "'" + s.as_string() + "'";
+    }
+
+    std::string visit_array(const sajson::array_range& elements) {
+        std::string rv = "[";
+        for (const value& element : elements) {
+            rv += sajson::visit(element, *this) + ",";
+        }
+        return rv + "]";
+    }
+
+    std::string visit_object(const sajson::object_range& members) {
+        std::string rv = "{";
+        for (const auto& member : members) {
+            rv += member.first.as_string() + ":"
+                + sajson::visit(member.second, *this) + ",";
+        }
+        return rv + "}";
+    }
+};
+} // namespace
+
+SUITE(visit) {
+    ABSTRACT_TEST(visit_passes_decoded_payloads) {
+        const sajson::document& document = parse(literal(
+            "[null, false, true, 7, 2.5, \"s\", [], {\"k\": [1]}]"));
+        assert(success(document));
+        CHECK_EQUAL(
+            "[null,false,true,i7,d25,'s',[],{k:[i1,],},]",
+            sajson::visit(document.get_root(), describing_visitor()));
+    }
+
+    ABSTRACT_TEST(visit_scalar_value) {
+        const sajson::document& document = parse(literal("{\"a\": -3}"));
+        assert(success(document));
+        describing_visitor visitor;
+        CHECK_EQUAL(
+            "i-3",
+            sajson::visit(
+                document.get_root().get_value_of_key(literal("a")), visitor));
+    }
+
+    TEST(visit_default_value) {
+        CHECK_EQUAL("null", sajson::visit(value(), describing_visitor()));
+    }
 }
 
 SUITE(errors) {
@@ -0,0 +1,300 @@
+#include <sajson_binary.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+#include <vector>
+
+using sajson::document;
+using sajson::literal;
+
+namespace {
+std::string to_hex(const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    for (unsigned char c : bytes) {
+        out += digits[c >> 4];
+        out += digits[c & 15];
+    }
+    return out;
+}
+
+std::string from_hex(const std::string& hex) {
+    std::string out;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out += static_cast<char>(std::stoi(hex.substr(i, 2), 0, 16));
+    }
+    return out;
+}
+
+document parse_json(const std::string& json) {
+    return sajson::parse(
+        sajson::dynamic_allocation(),
+        sajson::string(json.data(), json.size()));
+}
+
+std::string msgpack_of(const std::string& json) {
+    const document d = parse_json(json);
+    std::string out;
+    if (d.is_valid()) {
+        sajson::write_msgpack(d.get_root(), out);
+    }
+    return to_hex(out);
+}
+
+std::string cbor_of(const std::string& json) {
+    const document d = parse_json(json);
+    std::string out;
+    if (d.is_valid()) {
+        sajson::write_cbor(d.get_root(), out);
+    }
+    return to_hex(out);
+}
+
+document parse_msgpack_hex(const std::string& hex) {
+    const std::string bytes = from_hex(hex);
+    return sajson::parse_msgpack(
+        sajson::dynamic_allocation(),
+        sajson::string(bytes.data(), bytes.size()));
+}
+
+document parse_cbor_hex(const std::string& hex) {
+    const std::string bytes = from_hex(hex);
+    return sajson::parse_cbor(
+        sajson::dynamic_allocation(),
+        sajson::string(bytes.data(), bytes.size()));
+}
+
+// Whether d holds the same value as the JSON text.
+bool holds(const document& d, const std::string& json) {
+    const document expected = parse_json(json);
+    return d.is_valid() && expected.is_valid()
+        && d.get_root().equals(expected.get_root());
+}
+
+const char* const round_trip_documents[] = {
+    "[]",
+    "{}",
+    "[null,true,false,0,-1,23,24,-24,-25,255,256,-129,65535,65536,-32769]",
+    "[2147483647,-2147483648,0.5,-0.0,1e300,12345678901234567890]",
+    "{\"a\":[1,{\"b\":\"c\"}],\"\":\"\",\"k\\u0000ey\":\"x\\u0000y\"}",
+    "[[[[[]]]],{\"x\":{\"y\":{}}}]",
+    "[\"caf\\u00e9 \\ud83d\\ude00\"]",
+};
+
+template <typename Strategy>
+void check_round_trips(const Strategy& strategy) {
+    for (const char* json : round_trip_documents) {
+        const document original = parse_json(json);
+        CHECK(original.is_valid());
+
+        std::string msgpack;
+        sajson::write_msgpack(original.get_root(), msgpack);
+        const document from_msgpack = sajson::parse_msgpack(
+            strategy, sajson::string(msgpack.data(), msgpack.size()));
+        CHECK(from_msgpack.is_valid());
+        CHECK(from_msgpack.get_root().equals(original.get_root()));
+
+        std::string cbor;
+        sajson::write_cbor(original.get_root(), cbor);
+        const document from_cbor = sajson::parse_cbor(
+            strategy, sajson::string(cbor.data(), cbor.size()));
+        CHECK(from_cbor.is_valid());
+        CHECK(from_cbor.get_root().equals(original.get_root()));
+    }
+}
+} // namespace
+
+SUITE(binary) {
+    TEST(encodes_cbor) {
+        // RFC 8949 appendix A.
+        CHECK_EQUAL("83010203", cbor_of("[1,2,3]"));
+        CHECK_EQUAL("a26161016162820203", cbor_of("{\"a\":1,\"b\":[2,3]}"));
+        CHECK_EQUAL(
+            "8b00171818186418ff19010019e8001a000f42402038183903e7",
+            cbor_of("[0,23,24,100,255,256,59392,1000000,-1,-25,-1000]"));
+        CHECK_EQUAL("8362c3bcf5f6", cbor_of("[\"\\u00fc\",true,null]"));
+        CHECK_EQUAL("82f4fb3ff8000000000000", cbor_of("[false,1.5]"));
+    }
+
+    TEST(encodes_msgpack) {
+        CHECK_EQUAL(
+            "9a01ffd0dfccc8d1ff38ce00011170a3616263c0c3c2",
+            msgpack_of("[1,-1,-33,200,-200,70000,\"abc\",null,true,false]"));
+        CHECK_EQUAL("81a16190", msgpack_of("{\"a\":[]}"));
+        CHECK_EQUAL("91cb3ff8000000000000", msgpack_of("[1.5]"));
+        CHECK_EQUAL(
+            "91d920" + std::string(64, '6'),
+            msgpack_of("[\"" + std::string(32, 'f') + "\"]"));
+        CHECK_EQUAL(
+            "dc0010" + std::string(32, '0'),
+            msgpack_of("[0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0]"));
+    }
+
+    TEST(decodes_cbor) {
+        CHECK(holds(
+            parse_cbor_hex("a26161016162820203"), "{\"a\":1,\"b\":[2,3]}"));
+        // Half, single, and double floats.
+        CHECK(holds(
+            parse_cbor_hex("86f93c00f97bfff90001f9c400fa47c35000"
+                           "fb3ff8000000000000"),
+            "[1.0,65504.0,5.960464477539063e-8,-4.0,100000.0,1.5]"));
+        // Tags are skipped.
+        CHECK(holds(parse_cbor_hex("81c11a514b67b0"), "[1363896240]"));
+        // Integers beyond 32 bits become doubles.
+        const document big
+            = parse_cbor_hex("821b000000e8d4a510003bffffffffffffffff");
+        CHECK(big.is_valid());
+        CHECK_EQUAL(
+            sajson::TYPE_DOUBLE,
+            big.get_root().get_array_element(0).get_type());
+        CHECK_EQUAL(
+            1e12, big.get_root().get_array_element(0).get_double_value());
+        CHECK_EQUAL(
+            -18446744073709551616.0,
+            big.get_root().get_array_element(1).get_double_value());
+    }
+
+    TEST(decodes_msgpack) {
+        CHECK(holds(
+            parse_msgpack_hex("9a01ffd0dfccc8d1ff38ce00011170a3616263c0c3c2"),
+            "[1,-1,-33,200,-200,70000,\"abc\",null,true,false]"));
+        // float32, str8, array16, and map16.
+        CHECK(holds(
+            parse_msgpack_hex("93ca3fc00000d90178dc0001de0001a0c0"),
+            "[1.5,\"x\",[{\"\":null}]]"));
+        const document big
+            = parse_msgpack_hex("92cfffffffffffffffffd3ffffffff00000000");
+        CHECK(big.is_valid());
+        CHECK_EQUAL(
+            18446744073709551615.0,
+            big.get_root().get_array_element(0).get_double_value());
+        CHECK_EQUAL(
+            -4294967296.0,
+            big.get_root().get_array_element(1).get_double_value());
+    }
+
+    TEST(decoded_objects_are_searchable) {
+        const document d = parse_msgpack_hex("83a16202a16101a3616263c0");
+        CHECK(d.is_valid());
+        const sajson::value root = d.get_root();
+        CHECK_EQUAL(3u, root.get_length());
+        CHECK_EQUAL(
+            2, root.get_value_of_key(literal("b")).get_integer_value());
+        CHECK_EQUAL(1, root.get_value_of_key(literal("a")).get_integer_value());
+        CHECK_EQUAL(
+            sajson::TYPE_NULL,
+            root.get_value_of_key(literal("abc")).get_type());
+    }
+
+    TEST(strings_are_nul_terminated) {
+        const document d = parse_cbor_hex("826178626263");
+        CHECK(d.is_valid());
+        const sajson::value root = d.get_root();
+        CHECK_EQUAL("x", std::string(root.get_array_element(0).as_cstring()));
+        CHECK_EQUAL("bc", std::string(root.get_array_element(1).as_cstring()));
+    }
+
+    TEST(decodes_in_place) {
+        std::string bytes = from_hex("92a3616263a178");
+        const document d = sajson::parse_msgpack(
+            sajson::dynamic_allocation(),
+            sajson::mutable_string_view(bytes.size(), &bytes[0]));
+        CHECK(d.is_valid());
+        CHECK(bytes.data() == d.get_root().get_array_element(0).as_cstring());
+        CHECK_EQUAL("x", d.get_root().get_array_element(1).as_string());
+    }
+
+    TEST(round_trips_with_dynamic_allocation) {
+        check_round_trips(sajson::dynamic_allocation());
+    }
+
+    TEST(round_trips_with_single_allocation) {
+        check_round_trips(sajson::single_allocation());
+    }
+
+    TEST(round_trips_with_bounded_allocation) {
+        size_t buffer[1024];
+        check_round_trips(sajson::bounded_allocation(buffer));
+    }
+
+    TEST(single_allocation_bound) {
+        // Strings cost the most words per byte.
+        std::string bytes = "\x9f" + std::string(15, '\xa0');
+        std::vector<size_t> buffer(3 * bytes.size() + 1);
+        const document d = sajson::parse_msgpack(
+            sajson::single_allocation(buffer.data(), buffer.size()),
+            sajson::string(bytes.data(), bytes.size()));
+        CHECK(d.is_valid());
+        CHECK_EQUAL(15u, d.get_root().get_length());
+
+        bytes = "\x8f";
+        for (int i = 0; i < 15; ++i) {
+            bytes += "\xa0\xa0";
+        }
+        buffer.assign(3 * bytes.size() + 1, 0);
+        const document o = sajson::parse_msgpack(
+            sajson::single_allocation(buffer.data(), buffer.size()),
+            sajson::string(bytes.data(), bytes.size()));
+        CHECK(o.is_valid());
+    }
+
+    TEST(reports_errors) {
+        struct {
+            const char* hex;
+            sajson::error code;
+            size_t column;
+        } const cases[] = {
+            { "", sajson::ERROR_MISSING_ROOT_ELEMENT, 1 },
+            { "01", sajson::ERROR_BAD_ROOT, 1 },
+            { "9201", sajson::ERROR_UNEXPECTED_END, 3 },
+            { "91a561", sajson::ERROR_UNEXPECTED_END, 2 },
+            { "9000", sajson::ERROR_EXPECTED_END_OF_INPUT, 2 },
+            { "810101", sajson::ERROR_MISSING_OBJECT_KEY, 2 },
+            { "91c400", sajson::ERROR_INVALID_BINARY, 2 },
+            { "91d40000", sajson::ERROR_INVALID_BINARY, 2 },
+            { "91c1", sajson::ERROR_INVALID_BINARY, 2 },
+        };
+        for (const auto& c : cases) {
+            const document d = parse_msgpack_hex(c.hex);
+            CHECK(!d.is_valid());
+            CHECK_EQUAL(c.code, d._internal_get_error_code());
+            CHECK_EQUAL(c.column, d.get_error_column());
+        }
+
+        const char* const invalid_cbor[] = {
+            "9fff", "814401020304", "81f7", "81f820", "81fc", "bf6161ff",
+        };
+        for (const char* hex : invalid_cbor) {
+            const document d = parse_cbor_hex(hex);
+            CHECK(!d.is_valid());
+            CHECK_EQUAL(
+                sajson::ERROR_INVALID_BINARY, d._internal_get_error_code());
+        }
+        CHECK_EQUAL(
+            sajson::ERROR_MISSING_OBJECT_KEY,
+            parse_cbor_hex("a10101")._internal_get_error_code());
+        CHECK_EQUAL(
+            "invalid or unsupported binary item",
+            parse_cbor_hex("81f7").get_error_message_as_string());
+    }
+
+    TEST(truncations_fail) {
+        const document original = parse_json(round_trip_documents[4]);
+        std::string encoded[2];
+        sajson::write_msgpack(original.get_root(), encoded[0]);
+        sajson::write_cbor(original.get_root(), encoded[1]);
+        for (size_t length = 0; length < encoded[0].size(); ++length) {
+            CHECK(!sajson::parse_msgpack(
+                       sajson::dynamic_allocation(),
+                       sajson::string(encoded[0].data(), length))
+                       .is_valid());
+        }
+        for (size_t length = 0; length < encoded[1].size(); ++length) {
+            CHECK(!sajson::parse_cbor(
+                       sajson::dynamic_allocation(),
+                       sajson::string(encoded[1].data(), length))
+                       .is_valid());
+        }
+    }
+}
@@ -0,0 +1,248 @@
+#include <sajson_bind.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+#include <vector>
+
+using sajson::document;
+using sajson::literal;
+
+namespace bind_test {
+struct repo {
+    int64_t id;
+    std::string name;
+};
+SAJSON_BIND(repo, id, name)
+
+struct event {
+    event()
+        : id(0)
+        , is_public(false)
+        , score(0.0) {}
+
+    int id;
+    std::string type;
+    bool is_public;
+    double score;
+    repo where;
+    std::vector<std::string> tags;
+    sajson::value payload;
+};
+SAJSON_BIND(event, id, type, is_public, score, where, tags, payload)
+
+struct trade {
+    trade()
+        : price(0.0)
+        , quantity(0)
+        , sequence(0)
+        , is_buy(false) {}
+
+    std::string symbol;
+    double price;
+    int quantity;
+    int64_t sequence;
+    bool is_buy;
+    std::vector<int> fills;
+};
+SAJSON_SCHEMA(
+    trade,
+    SAJSON_REQUIRED(symbol),
+    SAJSON_REQUIRED(price),
+    SAJSON_OPTIONAL(quantity),
+    SAJSON_OPTIONAL(sequence),
+    SAJSON_OPTIONAL(is_buy),
+    SAJSON_OPTIONAL(fills))
+
+struct number {
+    number()
+        : d(0.0) {}
+
+    double d;
+};
+SAJSON_SCHEMA(number, SAJSON_REQUIRED(d))
+
+// parse_into rejects types whose fields would point into its temporary
+// document.
+static_assert(
+    sajson_bound_holds_value(static_cast<const event*>(0)),
+    "event holds a sajson::value");
+static_assert(
+    !sajson_bound_holds_value(static_cast<const trade*>(0)),
+    "trade holds no sajson::value");
+} // namespace bind_test
+
+namespace {
+// Too small for any document, so parse_into can only succeed by reading the
+// text directly.
+size_t no_ast[1];
+
+sajson::bounded_allocation no_fallback() {
+    return sajson::bounded_allocation(no_ast, 1);
+}
+} // namespace
+
+using bind_test::event;
+using bind_test::trade;
+
+SUITE(bind) {
+    TEST(decodes_every_field) {
+        const document& d = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"type\":\"PushEvent\",\"id\":7,\"is_public\":true,"
+                    "\"score\":2.5,\"where\":{\"name\":\"sajson\","
+                    "\"id\":9007199254740992},\"tags\":[\"a\",\"b\"],"
+                    "\"payload\":[1,2],\"ignored\":null}"));
+        CHECK(d.is_valid());
+        event e;
+        CHECK(sajson::decode(d.get_root(), e));
+        CHECK_EQUAL(7, e.id);
+        CHECK_EQUAL("PushEvent", e.type);
+        CHECK_EQUAL(true, e.is_public);
+        CHECK_EQUAL(2.5, e.score);
+        CHECK_EQUAL("sajson", e.where.name);
+        CHECK(9007199254740992LL == e.where.id);
+        CHECK_EQUAL(2u, e.tags.size());
+        CHECK_EQUAL("b", e.tags[1]);
+        CHECK_EQUAL(sajson::TYPE_ARRAY, e.payload.get_type());
+        CHECK_EQUAL(2u, e.payload.get_length());
+    }
+
+    TEST(missing_fields_are_unchanged) {
+        const document& d = sajson::parse(
+            sajson::dynamic_allocation(), literal("{\"score\":1}"));
+        event e;
+        e.type = "unset";
+        CHECK(sajson::decode(d.get_root(), e));
+        CHECK_EQUAL(1.0, e.score);
+        CHECK_EQUAL("unset", e.type);
+        CHECK_EQUAL(0, e.id);
+    }
+
+    TEST(type_mismatches_fail) {
+        event e;
+        const document& wrong_field = sajson::parse(
+            sajson::dynamic_allocation(), literal("{\"id\":\"7\"}"));
+        CHECK(!sajson::decode(wrong_field.get_root(), e));
+
+        const document& wrong_element = sajson::parse(
+            sajson::dynamic_allocation(), literal("{\"tags\":[\"a\",1]}"));
+        CHECK(!sajson::decode(wrong_element.get_root(), e));
+
+        const document& not_object = sajson::parse(
+            sajson::dynamic_allocation(), literal("[]"));
+        CHECK(!sajson::decode(not_object.get_root(), e));
+    }
+
+    TEST(top_level_arrays_of_structs) {
+        const document& d = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("[{\"id\":1,\"name\":\"x\"},{\"name\":\"y\",\"id\":2}]"));
+        std::vector<bind_test::repo> repos;
+        CHECK(sajson::decode(d.get_root(), repos));
+        CHECK_EQUAL(2u, repos.size());
+        CHECK(2 == repos[1].id);
+        CHECK_EQUAL("y", repos[1].name);
+    }
+
+    TEST(vectors_of_bool) {
+        const document& d = sajson::parse(
+            sajson::dynamic_allocation(), literal("[true,false,true]"));
+        std::vector<bool> flags(5, false);
+        CHECK(sajson::decode(d.get_root(), flags));
+        CHECK_EQUAL(3u, flags.size());
+        CHECK(flags[0] && !flags[1] && flags[2]);
+
+        const document& mixed = sajson::parse(
+            sajson::dynamic_allocation(), literal("[true,1]"));
+        CHECK(!sajson::decode(mixed.get_root(), flags));
+    }
+}
+
+SUITE(schema) {
+    TEST(flat_messages_skip_the_ast) {
+        trade t;
+        CHECK(sajson::parse_into(
+            no_fallback(),
+            literal(" { \"symbol\" : \"ABC\", \"price\":12.5,"
+                    "\"quantity\":-300,\"sequence\":4294967296,"
+                    "\"is_buy\":true } "),
+            t));
+        CHECK_EQUAL("ABC", t.symbol);
+        CHECK_EQUAL(12.5, t.price);
+        CHECK_EQUAL(-300, t.quantity);
+        CHECK(4294967296LL == t.sequence);
+        CHECK_EQUAL(true, t.is_buy);
+    }
+
+    TEST(other_input_falls_back) {
+        trade t;
+        const sajson::string inputs[] = {
+            literal("{\"symbol\":\"A\\nB\",\"price\":1}"),
+            literal("{\"symbol\":\"AB\",\"price\":1,\"fills\":[1,2]}"),
+            literal("{\"symbol\":\"AB\",\"price\":1,\"extra\":{}}"),
+            literal("{\"symbol\":\"AB\",\"price\":1.00000000000000001}"),
+        };
+        for (const sajson::string& input : inputs) {
+            CHECK(!sajson::parse_into(no_fallback(), input, t));
+            CHECK(sajson::parse_into(sajson::dynamic_allocation(), input, t));
+        }
+        CHECK_EQUAL(2u, t.fills.size());
+    }
+
+    TEST(required_fields) {
+        trade t;
+        CHECK(!sajson::parse_into(
+            sajson::dynamic_allocation(), literal("{\"symbol\":\"A\"}"), t));
+        const document& d = sajson::parse(
+            sajson::dynamic_allocation(), literal("{\"price\":1}"));
+        CHECK(!sajson::decode(d.get_root(), t));
+    }
+
+    TEST(invalid_json_fails) {
+        trade t;
+        const sajson::string inputs[] = {
+            literal("{\"symbol\":\"A\",\"price\":1"),
+            literal("{\"symbol\":\"A\",\"price\":01}"),
+            literal("{\"symbol\":\"A\",\"price\":1} x"),
+            literal("{\"symbol\":\"A\",\"price\":1,}"),
+            literal("{\"symbol\":\"A\",\"price\":truex}"),
+        };
+        for (const sajson::string& input : inputs) {
+            CHECK(!sajson::parse_into(sajson::dynamic_allocation(), input, t));
+        }
+    }
+
+    TEST(numbers_match_the_generic_parser) {
+        const char* numbers[] = {
+            "0",
+            "-0",
+            "-0.0",
+            "0.1",
+            "12.34",
+            "-12.34e5",
+            "1e-300",
+            "1.5E+3",
+            "2147483647",
+            "-2147483648",
+            "214748364",
+            "123456789012345",
+            "0.000001234",
+            "9e307",
+            "3.14159265358979",
+        };
+        for (const char* n : numbers) {
+            std::string text = std::string("{\"d\":") + n + "}";
+            const sajson::string input(text.data(), text.size());
+
+            bind_test::number direct;
+            CHECK(sajson::parse_into(no_fallback(), input, direct));
+
+            bind_test::number generic;
+            const document& d
+                = sajson::parse(sajson::dynamic_allocation(), input);
+            CHECK(sajson::decode(d.get_root(), generic));
+            CHECK(memcmp(&direct.d, &generic.d, sizeof(double)) == 0);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#include <sajson_columnar.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+#include <vector>
+
+using sajson::column;
+using sajson::column_extractor;
+using sajson::literal;
+
+namespace {
+std::vector<sajson::column_spec> specs() {
+    return {
+        { "id", sajson::COLUMN_INT64 },
+        { "price", sajson::COLUMN_DOUBLE },
+        { "symbol", sajson::COLUMN_STRING },
+        { "live", sajson::COLUMN_BOOLEAN },
+    };
+}
+
+std::string str(const sajson::string& s) {
+    return std::string(s.data(), s.length());
+}
+} // namespace
+
+SUITE(columnar) {
+    TEST(extracts_typed_columns) {
+        column_extractor extractor(specs());
+        CHECK(extractor.append_records(literal(
+            "{\"symbol\":\"AB\",\"id\":1,\"price\":2.5,\"live\":true}\n"
+            "{\"id\":9007199254740992.0,\"price\":3,\"extra\":[1,2]}\r\n"
+            "\n"
+            "{\"live\":false,\"symbol\":\"\",\"id\":1.5,\"price\":null}\n"
+            "  \n"
+            "[1,2,3]")));
+        CHECK_EQUAL(4u, extractor.get_row_count());
+
+        const column& id = extractor.get_column(0);
+        CHECK_EQUAL("id", id.get_key());
+        CHECK_EQUAL(4u, id.get_length());
+        CHECK_EQUAL(2u, id.get_null_count());
+        CHECK_EQUAL(1, id.get_int64(0));
+        CHECK_EQUAL(9007199254740992LL, id.get_int64(1));
+        CHECK(!id.is_valid(2));
+        CHECK(!id.is_valid(3));
+        CHECK_EQUAL(0x03, id.get_validity_bitmap()[0]);
+        CHECK_EQUAL(0, id.get_int64_values()[2]);
+
+        const column& price = extractor.get_column(1);
+        CHECK_EQUAL(2.5, price.get_double(0));
+        CHECK_EQUAL(3.0, price.get_double_values()[1]);
+        CHECK_EQUAL(0x03, price.get_validity_bitmap()[0]);
+
+        const column& symbol = extractor.get_column(2);
+        CHECK_EQUAL(0x05, symbol.get_validity_bitmap()[0]);
+        CHECK_EQUAL("AB", str(symbol.get_string(0)));
+        CHECK_EQUAL("", str(symbol.get_string(1)));
+        const int32_t* offsets = symbol.get_string_offsets();
+        CHECK_EQUAL(0, offsets[0]);
+        CHECK_EQUAL(2, offsets[1]);
+        CHECK_EQUAL(2, offsets[2]);
+        CHECK_EQUAL(2, offsets[3]);
+        CHECK_EQUAL(2, offsets[4]);
+
+        const column& live = extractor.get_column(3);
+        CHECK_EQUAL(0x05, live.get_validity_bitmap()[0]);
+        CHECK_EQUAL(0x01, live.get_boolean_bitmap()[0]);
+        CHECK(live.get_boolean(0));
+        CHECK(!live.get_boolean(2));
+    }
+
+    TEST(bitmaps_span_bytes) {
+        column_extractor extractor({ { "v", sajson::COLUMN_BOOLEAN } });
+        std::string text;
+        for (int i = 0; i < 20; ++i) {
+            text += i % 3 ? "{\"v\":true}\n" : "{\"v\":0}\n";
+        }
+        CHECK(extractor.append_records(
+            sajson::string(text.data(), text.size())));
+        const column& v = extractor.get_column(0);
+        CHECK_EQUAL(20u, v.get_length());
+        CHECK_EQUAL(7u, v.get_null_count());
+        // Rows 0, 3, 6, ... are null.
+        CHECK_EQUAL(0xb6, v.get_validity_bitmap()[0]);
+        CHECK_EQUAL(0x6d, v.get_validity_bitmap()[1]);
+        CHECK_EQUAL(0x0b, v.get_validity_bitmap()[2]);
+        CHECK_EQUAL(0xb6, v.get_boolean_bitmap()[0]);
+    }
+
+    TEST(duplicate_and_missing_keys) {
+        column_extractor extractor({
+            { "a", sajson::COLUMN_INT64 },
+            { "missing", sajson::COLUMN_STRING },
+            { "a", sajson::COLUMN_DOUBLE },
+        });
+        CHECK(extractor.append_records(literal("{\"b\":0,\"a\":7}")));
+        CHECK_EQUAL(7, extractor.get_column(0).get_int64(0));
+        CHECK(!extractor.get_column(1).is_valid(0));
+        CHECK_EQUAL(7.0, extractor.get_column(2).get_double(0));
+    }
+
+    TEST(reports_the_failing_record) {
+        column_extractor extractor(specs());
+        const literal text("{\"id\":1}\n{\"id\":2}\n\n{\"id\":}\n{\"id\":4}\n");
+        CHECK(!extractor.append_records(text));
+        CHECK_EQUAL(3u, extractor.get_error_record());
+        CHECK_EQUAL(
+            sajson::ERROR_EXPECTED_VALUE, extractor.get_error_code());
+        CHECK_EQUAL(
+            "expected value", extractor.get_error_message_as_string());
+        CHECK_EQUAL(2u, extractor.get_row_count());
+    }
+
+    TEST(clear_reuses_columns) {
+        column_extractor extractor(specs());
+        CHECK(extractor.append_records(literal("{\"id\":1,\"symbol\":\"x\"}")));
+        extractor.clear();
+        CHECK_EQUAL(0u, extractor.get_row_count());
+        CHECK(extractor.append_records(literal("{\"symbol\":\"yz\"}")));
+        const column& symbol = extractor.get_column(2);
+        CHECK_EQUAL(1u, symbol.get_length());
+        CHECK_EQUAL("yz", str(symbol.get_string(0)));
+        CHECK_EQUAL(0u, symbol.get_null_count());
+        CHECK_EQUAL(1u, extractor.get_column(0).get_null_count());
+    }
+
+    TEST(parses_in_place) {
+        std::string text = "{\"symbol\":\"a\\nb\"}\n{\"symbol\":\"c\"}";
+        column_extractor extractor(specs());
+        CHECK(extractor.append_records(
+            sajson::mutable_string_view(text.size(), &text[0])));
+        const column& symbol = extractor.get_column(2);
+        CHECK_EQUAL("a\nb", str(symbol.get_string(0)));
+        CHECK_EQUAL("c", str(symbol.get_string(1)));
+    }
+
+    TEST(appends_parsed_records) {
+        const sajson::document d = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("[{\"id\":5,\"live\":true},{\"id\":\"6\"},7]"));
+        column_extractor extractor(specs());
+        for (const sajson::value& record : d.get_root().elements()) {
+            CHECK(extractor.append_record(record));
+        }
+        const column& id = extractor.get_column(0);
+        CHECK_EQUAL(3u, id.get_length());
+        CHECK_EQUAL(5, id.get_int64(0));
+        CHECK_EQUAL(2u, id.get_null_count());
+        CHECK_EQUAL(2u, extractor.get_column(3).get_null_count());
+    }
+}
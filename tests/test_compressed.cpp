@@ -0,0 +1,223 @@
+#include <sajson_compressed.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+#include <vector>
+
+using sajson::document;
+using sajson::literal;
+using sajson::TYPE_ARRAY;
+using sajson::TYPE_INTEGER;
+using sajson::TYPE_OBJECT;
+
+#ifdef SAJSON_HAVE_ZLIB
+
+namespace {
+
+// windowBits 15 + 16 produces a gzip wrapper; plain 15 produces zlib.
+std::string deflate_text(const std::string& text, int window_bits = 15 + 16) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    int rv = deflateInit2(
+        &zs,
+        Z_DEFAULT_COMPRESSION,
+        Z_DEFLATED,
+        window_bits,
+        8,
+        Z_DEFAULT_STRATEGY);
+    assert(rv == Z_OK);
+    (void)rv;
+
+    std::vector<char> out(deflateBound(&zs, text.size()) + 32);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    zs.avail_in = static_cast<uInt>(text.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    rv = deflate(&zs, Z_FINISH);
+    assert(rv == Z_STREAM_END);
+    size_t length = out.size() - zs.avail_out;
+    deflateEnd(&zs);
+    return std::string(out.data(), length);
+}
+
+document parse_gzip_text(const std::string& compressed) {
+    return sajson::parse_gzip(
+        sajson::single_allocation(),
+        sajson::string(compressed.data(), compressed.size()));
+}
+
+} // namespace
+
+SUITE(compressed) {
+    TEST(gzip_round_trip) {
+        const std::string compressed
+            = deflate_text("{\"a\":[1,2,3],\"b\":\"hello\"}");
+        const document& doc = parse_gzip_text(compressed);
+        CHECK(doc.is_valid());
+        const auto& root = doc.get_root();
+        CHECK_EQUAL(TYPE_OBJECT, root.get_type());
+        const auto& a = root.get_value_of_key(literal("a"));
+        CHECK_EQUAL(TYPE_ARRAY, a.get_type());
+        CHECK_EQUAL(3u, a.get_length());
+        CHECK_EQUAL(TYPE_INTEGER, a.get_array_element(2).get_type());
+        CHECK_EQUAL(3, a.get_array_element(2).get_integer_value());
+        CHECK_EQUAL(
+            "hello", root.get_value_of_key(literal("b")).as_string());
+    }
+
+    TEST(zlib_stream_without_size_hint) {
+        std::string text = "[";
+        for (int i = 0; i < 10000; ++i) {
+            text += i ? ",1234" : "1234";
+        }
+        text += "]";
+        const document& doc = parse_gzip_text(deflate_text(text, 15));
+        CHECK(doc.is_valid());
+        CHECK_EQUAL(10000u, doc.get_root().get_length());
+    }
+
+    TEST(concatenated_gzip_members) {
+        // The size hint in the trailer only covers the last member, so the
+        // output buffer has to grow.
+        const std::string compressed
+            = deflate_text("[\"a long first member to outgrow the hint\",")
+            + deflate_text("2]");
+        const document& doc = parse_gzip_text(compressed);
+        CHECK(doc.is_valid());
+        CHECK_EQUAL(2u, doc.get_root().get_length());
+    }
+
+    TEST(dynamic_allocation) {
+        const std::string compressed = deflate_text("[[[]]]");
+        const document& doc = sajson::parse_gzip(
+            sajson::dynamic_allocation(),
+            sajson::string(compressed.data(), compressed.size()));
+        CHECK(doc.is_valid());
+        CHECK_EQUAL(1u, doc.get_root().get_length());
+    }
+
+    TEST(compressed_input_is_not_modified) {
+        const std::string compressed = deflate_text("[\"x\"]");
+        const std::string copy = compressed;
+        const document& doc = parse_gzip_text(compressed);
+        CHECK(doc.is_valid());
+        CHECK(copy == compressed);
+    }
+
+    TEST(truncated_stream) {
+        const std::string compressed = deflate_text("[1,2,3,4,5,6,7,8,9]");
+        const document& doc
+            = parse_gzip_text(compressed.substr(0, compressed.size() / 2));
+        CHECK(!doc.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_DECOMPRESSION_FAILED,
+            doc._internal_get_error_code());
+        CHECK_EQUAL(
+            "failed to decompress input", doc.get_error_message_as_string());
+    }
+
+    TEST(not_compressed) {
+        const document& doc = parse_gzip_text("[1,2,3]");
+        CHECK(!doc.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_DECOMPRESSION_FAILED,
+            doc._internal_get_error_code());
+    }
+
+    TEST(empty_input) {
+        const document& doc = parse_gzip_text("");
+        CHECK(!doc.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_DECOMPRESSION_FAILED,
+            doc._internal_get_error_code());
+    }
+
+    TEST(forged_size_trailer) {
+        // ISIZE claims 4 GiB - 1.  The hint must not allocate that much up
+        // front, nor wrap the capacity to zero on 32-bit targets.
+        std::string compressed = deflate_text("[1,2,3]");
+        compressed.replace(compressed.size() - 4, 4, 4, '\xff');
+        CHECK(
+            sajson::internal::gzip_size_hint(sajson::string(
+                compressed.data(), compressed.size()))
+            <= compressed.size() * 1024 + 1024);
+
+        const document& doc = parse_gzip_text(compressed);
+        CHECK(!doc.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_DECOMPRESSION_FAILED,
+            doc._internal_get_error_code());
+    }
+
+    TEST(json_errors_are_reported) {
+        const document& doc = parse_gzip_text(deflate_text("[1,]"));
+        CHECK(!doc.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_EXPECTED_VALUE, doc._internal_get_error_code());
+        CHECK_EQUAL(1u, doc.get_error_line());
+        CHECK_EQUAL(4u, doc.get_error_column());
+    }
+}
+
+#endif // SAJSON_HAVE_ZLIB
+
+#ifdef SAJSON_HAVE_ZSTD
+
+SUITE(compressed_zstd) {
+    TEST(zstd_round_trip) {
+        const std::string text = "{\"a\":[1,2,3],\"b\":\"hello\"}";
+        std::vector<char> out(ZSTD_compressBound(text.size()));
+        size_t length = ZSTD_compress(
+            out.data(), out.size(), text.data(), text.size(), 3);
+        CHECK(!ZSTD_isError(length));
+
+        const document& doc = sajson::parse_zstd(
+            sajson::single_allocation(), sajson::string(out.data(), length));
+        CHECK(doc.is_valid());
+        CHECK_EQUAL(
+            3u, doc.get_root().get_value_of_key(literal("a")).get_length());
+    }
+
+    TEST(zstd_truncated) {
+        const std::string text = "[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15]";
+        std::vector<char> out(ZSTD_compressBound(text.size()));
+        size_t length = ZSTD_compress(
+            out.data(), out.size(), text.data(), text.size(), 3);
+        CHECK(!ZSTD_isError(length));
+
+        const document& doc = sajson::parse_zstd(
+            sajson::single_allocation(),
+            sajson::string(out.data(), length - 4));
+        CHECK(!doc.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_DECOMPRESSION_FAILED,
+            doc._internal_get_error_code());
+    }
+
+    TEST(zstd_forged_frame_size) {
+        // A frame whose header claims 2^48 - 1 bytes, followed by a single
+        // raw block holding "[1]".
+        const char frame[] = {
+            '\x28', '\xb5', '\x2f', '\xfd', // magic
+            '\xc0', // 8-byte content size, not single-segment
+            '\x00', // 1 KiB window
+            '\xff', '\xff', '\xff', '\xff', '\xff', '\xff', '\x00', '\x00',
+            '\x19', '\x00', '\x00', // last raw block of 3 bytes
+            '[',      '1',      ']',
+        };
+        const sajson::string compressed(frame, sizeof(frame));
+        size_t hint = 0;
+        CHECK(sajson::internal::zstd_size_hint(compressed, &hint));
+        CHECK(hint <= sizeof(frame) * 1024 + 1024);
+
+        const document& doc
+            = sajson::parse_zstd(sajson::single_allocation(), compressed);
+        CHECK(!doc.is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_DECOMPRESSION_FAILED,
+            doc._internal_get_error_code());
+    }
+}
+
+#endif // SAJSON_HAVE_ZSTD
@@ -0,0 +1,108 @@
+#include <sajson_diff.h>
+#include <sajson_writer.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+#include <vector>
+
+using sajson::document;
+
+namespace {
+document parse(const std::string& text) {
+    return sajson::parse_with_source_ranges(
+        sajson::dynamic_allocation(),
+        sajson::string(text.data(), text.size()));
+}
+
+// Formats each difference as "+path=after", "-path=before", or
+// "~path=before>after".
+std::string describe(const std::vector<sajson::difference>& differences) {
+    std::string rv;
+    for (const auto& d : differences) {
+        if (!rv.empty()) {
+            rv += " ";
+        }
+        if (d.kind == sajson::DIFF_ADDED) {
+            rv += "+" + d.path + "=";
+            sajson::write(d.after, rv);
+        } else if (d.kind == sajson::DIFF_REMOVED) {
+            rv += "-" + d.path + "=";
+            sajson::write(d.before, rv);
+        } else {
+            rv += "~" + d.path + "=";
+            sajson::write(d.before, rv);
+            rv += ">";
+            sajson::write(d.after, rv);
+        }
+    }
+    return rv;
+}
+
+// Diffs with and without source ranges and checks that both agree.
+std::string diff(const std::string& a_text, const std::string& b_text) {
+    const document a = parse(a_text);
+    const document b = parse(b_text);
+    const std::string plain
+        = describe(sajson::diff(a.get_root(), b.get_root()));
+    const std::string ranged = describe(sajson::diff(
+        a.get_root(),
+        sajson::string(a_text.data(), a_text.size()),
+        b.get_root(),
+        sajson::string(b_text.data(), b_text.size())));
+    CHECK_EQUAL(plain, ranged);
+    return plain;
+}
+} // namespace
+
+// Keys are visited in sajson's sorted order: shorter keys first.
+SUITE(diff) {
+    TEST(identical_documents_have_no_differences) {
+        CHECK_EQUAL(
+            "", diff("{\"a\":[1,{\"b\":null}]}", "{\"a\":[1,{\"b\":null}]}"));
+        CHECK_EQUAL("", diff("{\"b\": 1, \"a\": 2}", "{\"a\":2,\"b\":1.0}"));
+    }
+
+    TEST(reports_object_members) {
+        CHECK_EQUAL(
+            "+/new=true -/gone=1 ~/same=\"x\">\"y\"",
+            diff(
+                "{\"same\":\"x\",\"gone\":1,\"kept\":[]}",
+                "{\"kept\":[],\"new\":true,\"same\":\"y\"}"));
+    }
+
+    TEST(reports_array_elements_by_index) {
+        CHECK_EQUAL("~/1=2>3 -/2=4 -/3=5", diff("[1,2,4,5]", "[1,3]"));
+        CHECK_EQUAL("+/2={\"a\":1}", diff("[1,2]", "[1,2,{\"a\":1}]"));
+    }
+
+    TEST(descends_into_nested_containers) {
+        CHECK_EQUAL(
+            "+/config/name=\"b\" ~/config/limits/1=20>21",
+            diff(
+                "{\"config\":{\"limits\":[10,20],\"mode\":\"fast\"}}",
+                "{\"config\":{\"name\":\"b\",\"mode\":\"fast\","
+                "\"limits\":[10,21]}}"));
+    }
+
+    TEST(reports_type_changes_whole) {
+        CHECK_EQUAL(
+            "~/a=[1]>{\"0\":1} ~/b=null>false",
+            diff("{\"a\":[1],\"b\":null}", "{\"a\":{\"0\":1},\"b\":false}"));
+        CHECK_EQUAL("~=[]>{}", diff("[]", "{}"));
+    }
+
+    TEST(pairs_duplicate_keys_in_written_order) {
+        CHECK_EQUAL(
+            "~/a=1>2", diff("{\"a\":1,\"a\":1}", "{\"a\":1,\"a\":2}"));
+        CHECK_EQUAL(
+            "~/a=1>2", diff("{\"a\":1,\"a\":2}", "{\"a\":2,\"a\":2}"));
+        CHECK_EQUAL(
+            "-/a=1",
+            diff("{\"a\":1,\"b\":0,\"a\":1}", "{\"b\":0,\"a\":1}"));
+    }
+
+    TEST(escapes_paths) {
+        CHECK_EQUAL("+/a~1b~0c=1", diff("{}", "{\"a/b~c\":1}"));
+    }
+}
@@ -0,0 +1,178 @@
+#include <sajson_jsonpath.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+#include <vector>
+
+using sajson::document;
+using sajson::jsonpath;
+using sajson::literal;
+using sajson::value;
+
+namespace {
+const document& store() {
+    static document d = sajson::parse(
+        sajson::dynamic_allocation(),
+        literal("{\"store\":{\"book\":["
+                "{\"category\":\"reference\",\"author\":\"Rees\","
+                "\"price\":8.95},"
+                "{\"category\":\"fiction\",\"author\":\"Waugh\","
+                "\"price\":12.99},"
+                "{\"category\":\"fiction\",\"author\":\"Melville\","
+                "\"isbn\":\"0-553\",\"price\":8.99},"
+                "{\"category\":\"fiction\",\"author\":\"Tolkien\","
+                "\"isbn\":\"0-395\",\"price\":22.99}],"
+                "\"bicycle\":{\"color\":\"red\",\"price\":19.95}}}"));
+    return d;
+}
+
+// Renders each match compactly: strings as-is, numbers with %g, and
+// containers by their type.
+std::string query(const char* text, const document& d = store()) {
+    jsonpath path(sajson::string(text, strlen(text)));
+    if (!path.is_valid()) {
+        return "invalid";
+    }
+    std::vector<value> matches;
+    path.evaluate(d.get_root(), &matches);
+    std::string rv;
+    for (const value& v : matches) {
+        if (!rv.empty()) {
+            rv += ",";
+        }
+        switch (v.get_type()) {
+        case sajson::TYPE_STRING:
+            rv += v.as_string();
+            break;
+        case sajson::TYPE_INTEGER:
+        case sajson::TYPE_DOUBLE: {
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%g", v.get_number_value());
+            rv += buffer;
+            break;
+        }
+        case sajson::TYPE_ARRAY:
+            rv += "[]";
+            break;
+        case sajson::TYPE_OBJECT:
+            rv += "{}";
+            break;
+        default:
+            rv += "?";
+            break;
+        }
+    }
+    return rv;
+}
+} // namespace
+
+SUITE(jsonpath) {
+    TEST(root) { CHECK_EQUAL("{}", query("$")); }
+
+    TEST(child_steps) {
+        CHECK_EQUAL("red", query("$.store.bicycle.color"));
+        CHECK_EQUAL("red", query("$['store'][\"bicycle\"]['color']"));
+        CHECK_EQUAL("", query("$.store.missing"));
+        CHECK_EQUAL("", query("$.store.bicycle.color.x"));
+    }
+
+    TEST(wildcards) {
+        CHECK_EQUAL(
+            "Rees,Waugh,Melville,Tolkien", query("$.store.book[*].author"));
+        CHECK_EQUAL("[],{}", query("$.store.*"));
+    }
+
+    TEST(indices_and_slices) {
+        CHECK_EQUAL("Waugh", query("$.store.book[1].author"));
+        CHECK_EQUAL("Tolkien", query("$.store.book[-1].author"));
+        CHECK_EQUAL("", query("$.store.book[4]"));
+        CHECK_EQUAL("Rees,Waugh", query("$.store.book[:2].author"));
+        CHECK_EQUAL("Waugh,Tolkien", query("$.store.book[1::2].author"));
+        CHECK_EQUAL(
+            "Tolkien,Melville,Waugh,Rees",
+            query("$.store.book[::-1].author"));
+        CHECK_EQUAL("Melville,Tolkien", query("$.store.book[-2:].author"));
+        CHECK_EQUAL("", query("$.store.book[0:4:0]"));
+    }
+
+    TEST(slices_with_huge_steps) {
+        const document d = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("[0,1,2,3,4,5,6,7,8,9,10,11]"));
+        CHECK_EQUAL("9", query("$[9::9223372036854775799]", d));
+        CHECK_EQUAL("0", query("$[:10:9223372036854775799]", d));
+        CHECK_EQUAL("11", query("$[::-9223372036854775799]", d));
+        CHECK_EQUAL("2", query("$[2:0:-9223372036854775799]", d));
+    }
+
+    TEST(recursive_descent) {
+        CHECK_EQUAL("Rees,Waugh,Melville,Tolkien", query("$..author"));
+        CHECK_EQUAL("Tolkien", query("$..book[3].author"));
+        CHECK_EQUAL("Tolkien", query("$..[3].author"));
+    }
+
+    TEST(filters) {
+        CHECK_EQUAL("Melville,Tolkien", query("$..book[?(@.isbn)].author"));
+        CHECK_EQUAL(
+            "Rees,Melville",
+            query("$.store.book[?(@.price < 10)].author"));
+        CHECK_EQUAL(
+            "Waugh,Melville,Tolkien",
+            query("$.store.book[?(@.category == 'fiction')].author"));
+        CHECK_EQUAL(
+            "Rees",
+            query("$.store.book[?@.category != \"fiction\"].author"));
+        CHECK_EQUAL(
+            "Waugh,Tolkien",
+            query("$.store.book[?(@.author >= 'T')].author"));
+        CHECK_EQUAL("", query("$.store.book[?(@.price == 'cheap')]"));
+    }
+
+    TEST(filter_on_nested_paths_and_literals) {
+        const document& d = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"events\":["
+                    "{\"type\":\"PushEvent\",\"repo\":{\"name\":\"a\"}},"
+                    "{\"type\":\"WatchEvent\",\"repo\":{\"name\":\"b\"}},"
+                    "{\"type\":\"PushEvent\",\"repo\":{\"name\":\"c\"},"
+                    "\"public\":false,\"tags\":[1,null]}]}"));
+        CHECK_EQUAL(
+            "a,c", query("$.events[?(@.type=='PushEvent')].repo.name", d));
+        CHECK_EQUAL(
+            "WatchEvent", query("$.events[?(@.repo.name == 'b')].type", d));
+        CHECK_EQUAL(
+            "c", query("$.events[?(@.public == false)].repo.name", d));
+        CHECK_EQUAL(
+            "c", query("$.events[?(@.tags[1] == null)].repo.name", d));
+        CHECK_EQUAL(
+            "c", query("$.events[?(@['tags'][0] == 1.0)].repo.name", d));
+    }
+
+    TEST(filters_apply_to_object_members) {
+        CHECK_EQUAL("{}", query("$.store[?(@.color)]"));
+    }
+
+    TEST(invalid_expressions) {
+        const char* bad[] = {
+            "",
+            "store",
+            "$.",
+            "$[",
+            "$['a",
+            "$[a]",
+            "$[?(@.a == )]",
+            "$[?(@.a == 'x']",
+            "$[?(@..a)]",
+            "$[1:x]",
+            "$ x",
+        };
+        for (const char* text : bad) {
+            jsonpath path(sajson::string(text, strlen(text)));
+            CHECK(!path.is_valid());
+        }
+        jsonpath path(literal("$.a!"));
+        CHECK(!path.is_valid());
+        CHECK_EQUAL(3u, path.get_error_offset());
+    }
+}
@@ -0,0 +1,209 @@
+#include <sajson_loader.h>
+
+#include <UnitTest++.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using sajson::literal;
+
+namespace {
+// A temporary directory of files, removed on destruction.
+class temporary_files {
+public:
+    temporary_files() {
+        char pattern[] = "/tmp/sajson_loader_XXXXXX";
+        if (mkdtemp(pattern)) {
+            directory = pattern;
+        }
+    }
+
+    ~temporary_files() {
+        for (const auto& path : paths) {
+            unlink(path.c_str());
+        }
+        rmdir(directory.c_str());
+    }
+
+    std::string add(const std::string& contents) {
+        std::string path
+            = directory + "/" + std::to_string(paths.size()) + ".json";
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file) {
+            fwrite(contents.data(), 1, contents.size(), file);
+            fclose(file);
+        }
+        paths.push_back(path);
+        return path;
+    }
+
+    std::string directory;
+    std::vector<std::string> paths;
+};
+
+std::string numbered_document(size_t i) {
+    return "{\"i\":" + std::to_string(i) + ",\"pad\":\""
+        + std::string(i * 37 % 5000, 'x') + "\"}";
+}
+
+// Loads count numbered documents and checks that each arrives exactly once.
+template <typename Strategy>
+void check_loads_every_file(
+    const Strategy& strategy, size_t count, bool allow_io_uring) {
+    temporary_files files;
+    for (size_t i = 0; i < count; ++i) {
+        files.add(numbered_document(i));
+    }
+
+    sajson::file_loader<Strategy> loader(
+        strategy, files.paths, 3, 4, allow_io_uring);
+    if (!allow_io_uring) {
+        CHECK(!loader.is_using_io_uring());
+    }
+    std::vector<int> seen(count);
+    while (loader.remaining()) {
+        const sajson::loaded_file file = loader.next();
+        CHECK(file.index < count);
+        CHECK_EQUAL(0, file.error_number);
+        CHECK(file.doc.is_valid());
+        if (file.index < count && file.doc.is_valid()) {
+            ++seen[file.index];
+            CHECK_EQUAL(
+                static_cast<int>(file.index),
+                file.doc.get_root()
+                    .get_value_of_key(literal("i"))
+                    .get_integer_value());
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        CHECK_EQUAL(1, seen[i]);
+    }
+}
+} // namespace
+
+SUITE(loader) {
+    TEST(bounded_queue_blocks_and_closes) {
+        sajson::internal::bounded_queue<int> queue(2);
+        CHECK(queue.push(1));
+        CHECK(queue.push(2));
+        std::thread consumer([&] {
+            int item = 0;
+            for (int expected = 1; expected <= 3; ++expected) {
+                if (!queue.pop(item) || item != expected) {
+                    return;
+                }
+            }
+        });
+        // Blocks until the consumer makes room.
+        CHECK(queue.push(3));
+        consumer.join();
+
+        int item = 0;
+        std::thread closer([&] { queue.close(); });
+        CHECK(!queue.pop(item));
+        closer.join();
+        CHECK(!queue.push(4));
+    }
+
+    TEST(loads_with_pread) {
+        check_loads_every_file(sajson::dynamic_allocation(), 100, false);
+        check_loads_every_file(sajson::single_allocation(), 100, false);
+    }
+
+    TEST(loads_with_io_uring_if_available) {
+        check_loads_every_file(sajson::dynamic_allocation(), 100, true);
+        check_loads_every_file(sajson::single_allocation(), 100, true);
+    }
+
+#ifdef SAJSON_HAVE_IO_URING
+    TEST(io_uring_reader_drains_submitted_reads) {
+        sajson::internal::io_uring_reader ring(4);
+        if (!ring.is_valid()) {
+            return;
+        }
+        temporary_files files;
+        const std::string text = numbered_document(100);
+        int fd = -1;
+        size_t length = 0;
+        CHECK_EQUAL(
+            0,
+            sajson::internal::open_for_reading(
+                files.add(text).c_str(), &fd, &length));
+        CHECK_EQUAL(text.size(), length);
+
+        std::vector<char> first(length), second(length);
+        CHECK(ring.queue_read(
+            fd, first.data(), static_cast<unsigned>(length), 0, 0));
+        CHECK(ring.queue_read(
+            fd, second.data(), static_cast<unsigned>(length), 0, 1));
+        CHECK_EQUAL(0, ring.submit_and_wait());
+        CHECK_EQUAL(0, ring.drain());
+        // Both reads are done, and their completions were discarded.
+        size_t tag;
+        int result;
+        CHECK(!ring.pop_completion(&tag, &result));
+        CHECK(std::string(first.begin(), first.end()) == text);
+        CHECK(std::string(second.begin(), second.end()) == text);
+        close(fd);
+    }
+#endif
+
+    TEST(empty_list) {
+        const std::vector<std::string> paths;
+        sajson::file_loader<sajson::dynamic_allocation> loader(
+            sajson::dynamic_allocation(), paths);
+        CHECK_EQUAL(0u, loader.remaining());
+    }
+
+    TEST(reports_unreadable_and_invalid_files) {
+        for (bool allow_io_uring : { false, true }) {
+            temporary_files files;
+            files.add("[1,2,3]");
+            files.add("");
+            files.add("[1,");
+            std::vector<std::string> paths = files.paths;
+            paths.push_back(files.directory + "/missing.json");
+            paths.push_back(files.directory);
+
+            sajson::file_loader<sajson::dynamic_allocation> loader(
+                sajson::dynamic_allocation(), paths, 2, 64, allow_io_uring);
+            std::vector<int> error_numbers(paths.size(), -1);
+            std::vector<sajson::error> error_codes(paths.size());
+            while (loader.remaining()) {
+                const sajson::loaded_file file = loader.next();
+                error_numbers[file.index] = file.error_number;
+                error_codes[file.index] = file.doc._internal_get_error_code();
+                if (file.error_number) {
+                    CHECK_EQUAL(
+                        "failed to read input file",
+                        file.doc.get_error_message_as_string());
+                }
+            }
+
+            CHECK_EQUAL(0, error_numbers[0]);
+            CHECK_EQUAL(sajson::ERROR_NO_ERROR, error_codes[0]);
+            CHECK_EQUAL(0, error_numbers[1]);
+            CHECK_EQUAL(sajson::ERROR_MISSING_ROOT_ELEMENT, error_codes[1]);
+            CHECK_EQUAL(0, error_numbers[2]);
+            CHECK_EQUAL(sajson::ERROR_UNEXPECTED_END, error_codes[2]);
+            CHECK_EQUAL(ENOENT, error_numbers[3]);
+            CHECK_EQUAL(sajson::ERROR_READ_FAILED, error_codes[3]);
+            CHECK_EQUAL(EISDIR, error_numbers[4]);
+            CHECK_EQUAL(sajson::ERROR_READ_FAILED, error_codes[4]);
+        }
+    }
+
+    TEST(stops_early_when_destroyed) {
+        for (bool allow_io_uring : { false, true }) {
+            temporary_files files;
+            for (size_t i = 0; i < 200; ++i) {
+                files.add(numbered_document(i));
+            }
+            sajson::file_loader<sajson::single_allocation> loader(
+                sajson::single_allocation(), files.paths, 2, 2, allow_io_uring);
+            CHECK(loader.next().doc.is_valid());
+        }
+    }
+}
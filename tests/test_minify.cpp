@@ -0,0 +1,63 @@
+#include <sajson_minify.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+
+namespace {
+std::string minify(std::string text) {
+    const size_t length = sajson::minify(
+        sajson::mutable_string_view(text.size(), &text[0]));
+    text.resize(length);
+    return text;
+}
+} // namespace
+
+SUITE(minify) {
+    TEST(strips_whitespace_between_tokens) {
+        CHECK_EQUAL("", minify(""));
+        CHECK_EQUAL("", minify(" \t\r\n"));
+        CHECK_EQUAL(
+            "{\"a\":[1,2.5,true,null],\"b\":{}}",
+            minify("{\n  \"a\" : [ 1, 2.5,\ttrue , null ],\r\n"
+                   "  \"b\": { }\n}\n"));
+    }
+
+    TEST(keeps_whitespace_in_strings) {
+        CHECK_EQUAL(
+            "[\" a \\t b \",\"\\n\"]", minify("[ \" a \\t b \" , \"\\n\" ]"));
+    }
+
+    TEST(escaped_quotes_do_not_end_strings) {
+        CHECK_EQUAL(
+            "[\"\\\" x \",\"\\\\\",\"\\\\\\\" y\"]",
+            minify("[ \"\\\" x \" , \"\\\\\" , \"\\\\\\\" y\" ]"));
+    }
+
+    TEST(strings_and_escapes_across_blocks) {
+        // Puts a string's boundaries, and a backslash and the quote it
+        // escapes, on either side of every block offset.
+        for (size_t pad = 0; pad < 140; ++pad) {
+            const std::string spaces(pad, ' ');
+            const std::string text = "[" + spaces + "\"" + spaces + "\\\""
+                + spaces + "\"" + spaces + "," + spaces + "1]";
+            const std::string expected
+                = "[\"" + spaces + "\\\"" + spaces + "\",1]";
+            CHECK_EQUAL(expected, minify(text));
+        }
+    }
+
+    TEST(parses_the_same) {
+        std::string text = "{\n  \"k\": [ 1 , \"v w\" , { \"x\" : -0.5 } ]\n}";
+        const size_t length = sajson::minify(
+            sajson::mutable_string_view(text.size(), &text[0]));
+        const sajson::document d = sajson::parse(
+            sajson::dynamic_allocation(),
+            sajson::mutable_string_view(length, &text[0]));
+        CHECK(d.is_valid());
+        const sajson::value k
+            = d.get_root().get_value_of_key(sajson::literal("k"));
+        CHECK_EQUAL(3u, k.get_length());
+        CHECK_EQUAL("v w", k.get_array_element(1).as_string());
+    }
+}
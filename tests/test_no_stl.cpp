@@ -1,2 +1,24 @@
 #define SAJSON_NO_STD_STRING
 #include <sajson.h>
+
+// Not called: verifies the range API compiles without <string>.
+size_t count_scalars_without_std_string(const sajson::value& node) {
+    switch (node.get_type()) {
+    case sajson::TYPE_ARRAY: {
+        size_t count = 0;
+        for (const sajson::value& element : node.elements()) {
+            count += count_scalars_without_std_string(element);
+        }
+        return count;
+    }
+    case sajson::TYPE_OBJECT: {
+        size_t count = 0;
+        for (const auto& member : node.members()) {
+            count += count_scalars_without_std_string(member.second);
+        }
+        return count;
+    }
+    default:
+        return 1;
+    }
+}
@@ -0,0 +1,213 @@
+#include <sajson_parallel.h>
+
+#include <UnitTest++.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using sajson::document;
+using sajson::literal;
+using sajson::TYPE_ARRAY;
+
+SUITE(thread_pool) {
+    TEST(visits_every_index_once) {
+        sajson::thread_pool pool(4);
+        CHECK_EQUAL(4u, pool.get_thread_count());
+
+        std::vector<std::atomic<int>> visits(10007);
+        for (auto& v : visits) {
+            v = 0;
+        }
+        // UnitTest++'s CHECK macros are not thread-safe, so record any
+        // problems and check them afterwards.
+        std::atomic<bool> bad_chunk(false);
+        pool.for_each_index(
+            visits.size(), 3, [&](size_t worker, size_t begin, size_t end) {
+                if (worker >= 4 || begin >= end || end - begin > 3) {
+                    bad_chunk = true;
+                }
+                for (size_t i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+            });
+        CHECK(!bad_chunk);
+        for (auto& v : visits) {
+            CHECK_EQUAL(1, v.load());
+        }
+    }
+
+    TEST(pool_is_reusable) {
+        sajson::thread_pool pool(3);
+        for (size_t count = 0; count < 20; ++count) {
+            std::atomic<size_t> total(0);
+            pool.for_each_index(
+                count, 1, [&](size_t, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        total += i;
+                    }
+                });
+            CHECK_EQUAL(count * (count - 1) / 2, total.load());
+        }
+    }
+
+    TEST(exceptions_are_rethrown) {
+        sajson::thread_pool pool(2);
+        bool threw = false;
+        try {
+            pool.for_each_index(100, 1, [](size_t, size_t begin, size_t) {
+                if (begin == 42) {
+                    throw std::runtime_error("boom");
+                }
+            });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
+
+SUITE(parse_many) {
+    TEST(results_are_in_input_order) {
+        std::vector<std::string> texts;
+        for (int i = 0; i < 1000; ++i) {
+            texts.push_back("[" + std::to_string(i) + "]");
+        }
+        std::vector<sajson::string> inputs;
+        for (const auto& t : texts) {
+            inputs.push_back(sajson::string(t.data(), t.size()));
+        }
+
+        std::vector<document> outputs;
+        sajson::parse_many(sajson::single_allocation(), inputs, &outputs, 4);
+        CHECK_EQUAL(inputs.size(), outputs.size());
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            CHECK(outputs[i].is_valid());
+            const auto& root = outputs[i].get_root();
+            CHECK_EQUAL(TYPE_ARRAY, root.get_type());
+            CHECK_EQUAL(
+                static_cast<int>(i),
+                root.get_array_element(0).get_integer_value());
+        }
+    }
+
+    TEST(errors_are_per_document) {
+        std::vector<literal> inputs;
+        inputs.push_back(literal("[1]"));
+        inputs.push_back(literal("[1,]"));
+        inputs.push_back(literal("{}"));
+
+        std::vector<document> outputs;
+        sajson::thread_pool pool(2);
+        sajson::parse_many(
+            sajson::dynamic_allocation(), inputs, &outputs, pool);
+        CHECK_EQUAL(3u, outputs.size());
+        CHECK(outputs[0].is_valid());
+        CHECK(!outputs[1].is_valid());
+        CHECK_EQUAL(
+            sajson::ERROR_EXPECTED_VALUE,
+            outputs[1]._internal_get_error_code());
+        CHECK(outputs[2].is_valid());
+    }
+
+    TEST(outputs_are_replaced) {
+        std::vector<literal> inputs(1, literal("[]"));
+        std::vector<document> outputs;
+        sajson::parse_many(sajson::single_allocation(), inputs, &outputs, 1);
+        sajson::parse_many(sajson::single_allocation(), inputs, &outputs, 1);
+        CHECK_EQUAL(1u, outputs.size());
+    }
+
+    TEST(empty_batch) {
+        std::vector<literal> inputs;
+        std::vector<document> outputs;
+        sajson::parse_many(sajson::single_allocation(), inputs, &outputs, 2);
+        CHECK_EQUAL(0u, outputs.size());
+    }
+}
+
+namespace {
+// Parses [0, 1, ..., count - 1].
+document parse_indices(size_t count) {
+    std::string text = "[";
+    for (size_t i = 0; i < count; ++i) {
+        text += (i ? "," : "") + std::to_string(i);
+    }
+    text += "]";
+    return sajson::parse(
+        sajson::dynamic_allocation(),
+        sajson::string(text.data(), text.size()));
+}
+} // namespace
+
+SUITE(parallel_traversal) {
+    TEST(for_each_visits_every_element_once) {
+        const document d = parse_indices(10007);
+        std::vector<std::atomic<int>> visits(10007);
+        for (auto& v : visits) {
+            v = 0;
+        }
+        sajson::thread_pool pool(4);
+        sajson::parallel_for_each(
+            d.get_root(),
+            [&](const sajson::value& element) {
+                ++visits[element.get_integer_value()];
+            },
+            pool);
+        for (auto& v : visits) {
+            CHECK_EQUAL(1, v.load());
+        }
+    }
+
+    TEST(map_reduce_combines_every_element) {
+        const document d = parse_indices(5000);
+        sajson::thread_pool pool(3);
+        for (size_t chunk_size = 0; chunk_size < 4; ++chunk_size) {
+            const long long sum = sajson::parallel_map_reduce(
+                d.get_root(),
+                0LL,
+                [](const sajson::value& element) {
+                    return static_cast<long long>(element.get_integer_value());
+                },
+                [](long long a, long long b) { return a + b; },
+                pool,
+                chunk_size);
+            CHECK_EQUAL(5000LL * 4999 / 2, sum);
+        }
+    }
+
+    TEST(map_reduce_of_empty_array_is_identity) {
+        const document d = sajson::parse(
+            sajson::dynamic_allocation(), literal("[]"));
+        sajson::thread_pool pool(2);
+        const int result = sajson::parallel_map_reduce(
+            d.get_root(),
+            -1,
+            [](const sajson::value& element) {
+                return element.get_integer_value();
+            },
+            [](int a, int b) { return std::max(a, b); },
+            pool);
+        CHECK_EQUAL(-1, result);
+    }
+
+    TEST(for_each_rethrows) {
+        const document d = parse_indices(100);
+        sajson::thread_pool pool(2);
+        bool threw = false;
+        try {
+            sajson::parallel_for_each(
+                d.get_root(),
+                [](const sajson::value& element) {
+                    if (element.get_integer_value() == 42) {
+                        throw std::runtime_error("boom");
+                    }
+                },
+                pool);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
@@ -0,0 +1,258 @@
+#include <sajson_patch.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+
+using sajson::document;
+using sajson::patch_error;
+
+namespace {
+// sajson only accepts arrays and objects at the root, so wrap each document
+// and work with its only element.
+document parse(const char* text) {
+    const std::string wrapped = std::string("[") + text + "]";
+    return sajson::parse(
+        sajson::dynamic_allocation(),
+        sajson::string(wrapped.data(), wrapped.size()));
+}
+
+// Returns the patched document, or the failing operation and reason.
+std::string patch(const char* target, const char* operations) {
+    const document t = parse(target);
+    const document p = parse(operations);
+    sajson::writer out;
+    patch_error error;
+    if (!sajson::apply_patch(
+            t.get_root().get_array_element(0),
+            p.get_root().get_array_element(0),
+            out,
+            &error)) {
+        return std::to_string(error.operation) + ": " + error.reason;
+    }
+    const sajson::string s = out.get_output();
+    return std::string(s.data(), s.length());
+}
+
+std::string merge(const char* target, const char* merge_patch) {
+    const document t = parse(target);
+    const document p = parse(merge_patch);
+    sajson::writer out;
+    sajson::apply_merge_patch(
+        t.get_root().get_array_element(0),
+        p.get_root().get_array_element(0),
+        out);
+    const sajson::string s = out.get_output();
+    return std::string(s.data(), s.length());
+}
+
+// Like patch() and merge(), but parses the target with source ranges so
+// untouched subtrees are copied from it verbatim.
+std::string patch_verbatim(const char* target, const char* operations) {
+    const sajson::string text(target, strlen(target));
+    const document t
+        = sajson::parse_with_source_ranges(sajson::dynamic_allocation(), text);
+    const document p = parse(operations);
+    sajson::writer out;
+    if (!sajson::apply_patch(
+            t.get_root(), text, p.get_root().get_array_element(0), out)) {
+        return "failed";
+    }
+    const sajson::string s = out.get_output();
+    return std::string(s.data(), s.length());
+}
+
+std::string merge_verbatim(const char* target, const char* merge_patch) {
+    const sajson::string text(target, strlen(target));
+    const document t
+        = sajson::parse_with_source_ranges(sajson::dynamic_allocation(), text);
+    const document p = parse(merge_patch);
+    sajson::writer out;
+    sajson::apply_merge_patch(
+        t.get_root(), text, p.get_root().get_array_element(0), out);
+    const sajson::string s = out.get_output();
+    return std::string(s.data(), s.length());
+}
+} // namespace
+
+SUITE(patch) {
+    // Examples from RFC 6902 appendix A.
+    TEST(adds) {
+        CHECK_EQUAL(
+            "{\"foo\":\"bar\",\"baz\":\"qux\"}",
+            patch(
+                "{\"foo\":\"bar\"}",
+                "[{\"op\":\"add\",\"path\":\"/baz\",\"value\":\"qux\"}]"));
+        CHECK_EQUAL(
+            "{\"foo\":[\"bar\",\"qux\",\"baz\"]}",
+            patch(
+                "{\"foo\":[\"bar\",\"baz\"]}",
+                "[{\"op\":\"add\",\"path\":\"/foo/1\",\"value\":\"qux\"}]"));
+        CHECK_EQUAL(
+            "{\"foo\":[\"bar\",[\"abc\",\"def\"]]}",
+            patch(
+                "{\"foo\":[\"bar\"]}",
+                "[{\"op\":\"add\",\"path\":\"/foo/-\","
+                "\"value\":[\"abc\",\"def\"]}]"));
+    }
+
+    TEST(removes_and_replaces) {
+        CHECK_EQUAL(
+            "{\"foo\":\"bar\"}",
+            patch(
+                "{\"baz\":\"qux\",\"foo\":\"bar\"}",
+                "[{\"op\":\"remove\",\"path\":\"/baz\"}]"));
+        CHECK_EQUAL(
+            "{\"foo\":[\"bar\",\"baz\"]}",
+            patch(
+                "{\"foo\":[\"bar\",\"qux\",\"baz\"]}",
+                "[{\"op\":\"remove\",\"path\":\"/foo/1\"}]"));
+        CHECK_EQUAL(
+            "{\"baz\":\"boo\",\"foo\":\"bar\"}",
+            patch(
+                "{\"baz\":\"qux\",\"foo\":\"bar\"}",
+                "[{\"op\":\"replace\",\"path\":\"/baz\",\"value\":\"boo\"}]"));
+    }
+
+    TEST(moves_and_copies) {
+        CHECK_EQUAL(
+            "{\"foo\":{\"bar\":\"baz\"},\"qux\":{\"corge\":\"grault\","
+            "\"thud\":\"fred\"}}",
+            patch(
+                "{\"foo\":{\"bar\":\"baz\",\"waldo\":\"fred\"},"
+                "\"qux\":{\"corge\":\"grault\"}}",
+                "[{\"op\":\"move\",\"from\":\"/foo/waldo\","
+                "\"path\":\"/qux/thud\"}]"));
+        CHECK_EQUAL(
+            "{\"foo\":[\"all\",\"cows\",\"eat\",\"grass\"]}",
+            patch(
+                "{\"foo\":[\"all\",\"grass\",\"cows\",\"eat\"]}",
+                "[{\"op\":\"move\",\"from\":\"/foo/1\",\"path\":\"/foo/3\"}]"));
+        // The copy is unaffected by later edits to the original.
+        CHECK_EQUAL(
+            "{\"a\":[1,2],\"b\":[1]}",
+            patch(
+                "{\"a\":[1]}",
+                "[{\"op\":\"copy\",\"from\":\"/a\",\"path\":\"/b\"},"
+                "{\"op\":\"add\",\"path\":\"/a/-\",\"value\":2}]"));
+    }
+
+    TEST(tests_values) {
+        CHECK_EQUAL(
+            "{\"baz\":\"qux\",\"foo\":[\"a\",2,\"c\"]}",
+            patch(
+                "{\"baz\":\"qux\",\"foo\":[\"a\",2,\"c\"]}",
+                "[{\"op\":\"test\",\"path\":\"/baz\",\"value\":\"qux\"},"
+                "{\"op\":\"test\",\"path\":\"/foo/1\",\"value\":2}]"));
+        CHECK_EQUAL(
+            "0: test failed",
+            patch(
+                "{\"baz\":\"qux\"}",
+                "[{\"op\":\"test\",\"path\":\"/baz\",\"value\":\"bar\"}]"));
+        // Edited containers compare structurally too.
+        CHECK_EQUAL(
+            "{\"a\":{\"b\":1,\"c\":2}}",
+            patch(
+                "{\"a\":{\"b\":1}}",
+                "[{\"op\":\"add\",\"path\":\"/a/c\",\"value\":2},"
+                "{\"op\":\"test\",\"path\":\"\","
+                "\"value\":{\"a\":{\"c\":2,\"b\":1.0}}}]"));
+    }
+
+    TEST(replaces_the_root) {
+        CHECK_EQUAL(
+            "[1]",
+            patch(
+                "{\"a\":1}",
+                "[{\"op\":\"replace\",\"path\":\"\",\"value\":[1]}]"));
+    }
+
+    TEST(reports_errors) {
+        CHECK_EQUAL(
+            "1: path not found",
+            patch(
+                "{\"foo\":\"bar\"}",
+                "[{\"op\":\"add\",\"path\":\"/a\",\"value\":1},"
+                "{\"op\":\"add\",\"path\":\"/baz/bat\",\"value\":\"qux\"}]"));
+        CHECK_EQUAL(
+            "0: index out of range",
+            patch("[1]", "[{\"op\":\"add\",\"path\":\"/2\",\"value\":2}]"));
+        CHECK_EQUAL(
+            "0: cannot move a value into itself",
+            patch(
+                "{\"a\":{\"b\":1}}",
+                "[{\"op\":\"move\",\"from\":\"/a\",\"path\":\"/a/b/c\"}]"));
+        CHECK_EQUAL(
+            "0: unknown op", patch("[]", "[{\"op\":\"frob\",\"path\":\"\"}]"));
+        CHECK_EQUAL(
+            "0: missing value",
+            patch("[]", "[{\"op\":\"add\",\"path\":\"/-\"}]"));
+        CHECK_EQUAL("0: patch is not an array", patch("[]", "{}"));
+    }
+
+    TEST(copies_untouched_subtrees_verbatim) {
+        // Only the edited containers are regenerated; every other value keeps
+        // its original spelling.
+        CHECK_EQUAL(
+            "{\"keep\":[1.50, \"\\u00e9\"],\"edit\":{\"x\":1e2,\"z\":true}}",
+            patch_verbatim(
+                "{ \"keep\" : [1.50, \"\\u00e9\"],"
+                " \"edit\": {\"x\": 1e2, \"y\": 0} }",
+                "[{\"op\":\"remove\",\"path\":\"/edit/y\"},"
+                "{\"op\":\"add\",\"path\":\"/edit/z\",\"value\":true}]"));
+        CHECK_EQUAL(
+            "[{\"a\" :1},[2 ],{\"a\" :1}]",
+            patch_verbatim(
+                "[ {\"a\" :1}, [2 ] ]",
+                "[{\"op\":\"copy\",\"from\":\"/0\",\"path\":\"/-\"}]"));
+        CHECK_EQUAL(
+            "{\"a\":{\"b\":[ 1 ],\"c\":2}}",
+            merge_verbatim("{\"a\":{\"b\" : [ 1 ]}}", "{\"a\":{\"c\":2}}"));
+        CHECK_EQUAL(
+            "{ \"a\" : 1.0 }", patch_verbatim("{ \"a\" : 1.0 }", "[]"));
+    }
+
+    TEST(keeps_the_written_member_order) {
+        CHECK_EQUAL(
+            "{\"zeta\":[1, 2],\"a\":{\"y\":1,\"x\":5},\"mm\":3}",
+            patch_verbatim(
+                "{\"zeta\":[1, 2],\"a\":{\"y\":1,\"x\":2},\"mm\":3}",
+                "[{\"op\":\"replace\",\"path\":\"/a/x\",\"value\":5}]"));
+        CHECK_EQUAL(
+            "{\"b\":1,\"a\":{\"c\":true}}",
+            merge_verbatim("{\"b\":1,\"a\":2}", "{\"a\":{\"c\":true}}"));
+        CHECK_EQUAL(
+            "{\"b\":2,\"a\":1,\"c\":3}",
+            merge_verbatim("{\"b\":1,\"a\":1}", "{\"c\":3,\"b\":2}"));
+        // Without the source text, members come out in sajson's sorted
+        // order.
+        CHECK_EQUAL(
+            "{\"a\":{\"x\":5,\"y\":1},\"mm\":3,\"zeta\":[1,2]}",
+            patch(
+                "{\"zeta\":[1, 2],\"a\":{\"y\":1,\"x\":2},\"mm\":3}",
+                "[{\"op\":\"replace\",\"path\":\"/a/x\",\"value\":5}]"));
+    }
+
+    // Examples from RFC 7386 appendix A.
+    TEST(merges) {
+        CHECK_EQUAL("{\"a\":\"c\"}", merge("{\"a\":\"b\"}", "{\"a\":\"c\"}"));
+        CHECK_EQUAL(
+            "{\"a\":\"b\",\"b\":\"c\"}",
+            merge("{\"a\":\"b\"}", "{\"b\":\"c\"}"));
+        CHECK_EQUAL("{}", merge("{\"a\":\"b\"}", "{\"a\":null}"));
+        CHECK_EQUAL(
+            "{\"b\":\"c\"}",
+            merge("{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}"));
+        CHECK_EQUAL("{\"a\":\"c\"}", merge("{\"a\":[\"b\"]}", "{\"a\":\"c\"}"));
+        CHECK_EQUAL(
+            "{\"a\":{\"b\":\"d\"}}",
+            merge("{\"a\":{\"b\":\"c\"}}", "{\"a\":{\"b\":\"d\",\"c\":null}}"));
+        CHECK_EQUAL("[\"c\"]", merge("{\"a\":\"foo\"}", "[\"c\"]"));
+        CHECK_EQUAL("null", merge("{\"a\":\"foo\"}", "null"));
+        CHECK_EQUAL(
+            "{\"e\":null,\"a\":1}", merge("{\"e\":null}", "{\"a\":1}"));
+        CHECK_EQUAL(
+            "{\"a\":{\"bb\":{}}}",
+            merge("[1,2]", "{\"a\":{\"bb\":{\"ccc\":null}}}"));
+    }
+}
@@ -0,0 +1,107 @@
+#include <sajson_pointer.h>
+
+#include <UnitTest++.h>
+
+using sajson::document;
+using sajson::literal;
+using sajson::pointer;
+using sajson::value;
+
+namespace {
+const document& rfc_example() {
+    // The example document from RFC 6901 section 5.
+    static document d = sajson::parse(
+        sajson::dynamic_allocation(),
+        literal("{\"foo\":[\"bar\",\"baz\"],\"\":0,\"a/b\":1,\"c%d\":2,"
+                "\"e^f\":3,\"g|h\":4,\"i\\\\j\":5,\"k\\\"l\":6,\" \":7,"
+                "\"m~n\":8}"));
+    return d;
+}
+
+int evaluate_integer(const char* text) {
+    pointer p(sajson::string(text, strlen(text)));
+    value v;
+    if (!p.evaluate(rfc_example().get_root(), &v)
+        || v.get_type() != sajson::TYPE_INTEGER) {
+        return -1;
+    }
+    return v.get_integer_value();
+}
+} // namespace
+
+SUITE(pointer) {
+    TEST(empty_pointer_is_root) {
+        pointer p(literal(""));
+        CHECK(p.is_valid());
+        CHECK_EQUAL(0u, p.get_step_count());
+        value v;
+        CHECK(p.evaluate(rfc_example().get_root(), &v));
+        CHECK_EQUAL(sajson::TYPE_OBJECT, v.get_type());
+    }
+
+    TEST(rfc_examples) {
+        CHECK(rfc_example().is_valid());
+        CHECK_EQUAL(0, evaluate_integer("/"));
+        CHECK_EQUAL(1, evaluate_integer("/a~1b"));
+        CHECK_EQUAL(2, evaluate_integer("/c%d"));
+        CHECK_EQUAL(3, evaluate_integer("/e^f"));
+        CHECK_EQUAL(4, evaluate_integer("/g|h"));
+        CHECK_EQUAL(5, evaluate_integer("/i\\j"));
+        CHECK_EQUAL(6, evaluate_integer("/k\"l"));
+        CHECK_EQUAL(7, evaluate_integer("/ "));
+        CHECK_EQUAL(8, evaluate_integer("/m~0n"));
+    }
+
+    TEST(array_elements) {
+        value v;
+        CHECK(pointer(literal("/foo")).evaluate(rfc_example().get_root(), &v));
+        CHECK_EQUAL(sajson::TYPE_ARRAY, v.get_type());
+        CHECK(pointer(literal("/foo/1"))
+                  .evaluate(rfc_example().get_root(), &v));
+        CHECK_EQUAL("baz", v.as_string());
+    }
+
+    TEST(missing_steps_fail) {
+        const value root = rfc_example().get_root();
+        value v;
+        CHECK(!pointer(literal("/nope")).evaluate(root, &v));
+        CHECK(!pointer(literal("/foo/2")).evaluate(root, &v));
+        CHECK(!pointer(literal("/foo/-")).evaluate(root, &v));
+        CHECK(!pointer(literal("/foo/01")).evaluate(root, &v));
+        CHECK(!pointer(literal("/foo/0/x")).evaluate(root, &v));
+        CHECK(!pointer(literal("/foo/99999999999999999999999"))
+                   .evaluate(root, &v));
+    }
+
+    TEST(numeric_tokens_are_object_keys) {
+        const document& d = sajson::parse(
+            sajson::dynamic_allocation(), literal("{\"0\":{\"01\":true}}"));
+        value v;
+        CHECK(pointer(literal("/0/01")).evaluate(d.get_root(), &v));
+        CHECK_EQUAL(sajson::TYPE_TRUE, v.get_type());
+    }
+
+    TEST(malformed_pointers) {
+        CHECK(!pointer(literal("foo")).is_valid());
+        CHECK(!pointer(literal("/a~")).is_valid());
+        CHECK(!pointer(literal("/a~2")).is_valid());
+        value v;
+        CHECK(!pointer(literal("foo")).evaluate(rfc_example().get_root(), &v));
+    }
+
+    TEST(compiled_pointer_is_reusable) {
+        pointer p(literal("/items/1/id"));
+        CHECK_EQUAL(3u, p.get_step_count());
+        const document& a = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"items\":[{\"id\":1},{\"id\":2}]}"));
+        const document& b = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"items\":[{},{\"id\":3,\"x\":0}]}"));
+        value v;
+        CHECK(p.evaluate(a.get_root(), &v));
+        CHECK_EQUAL(2, v.get_integer_value());
+        CHECK(p.evaluate(b.get_root(), &v));
+        CHECK_EQUAL(3, v.get_integer_value());
+    }
+}
@@ -0,0 +1,239 @@
+#include <sajson_schema.h>
+
+#include <UnitTest++.h>
+
+#include <string>
+
+using sajson::document;
+using sajson::literal;
+using sajson::schema;
+using sajson::validation_error;
+
+namespace {
+// sajson only accepts arrays and objects at the root, so wrap each document
+// and work with its only element.
+document parse(const char* text) {
+    const std::string wrapped = std::string("[") + text + "]";
+    return sajson::parse(
+        sajson::dynamic_allocation(),
+        sajson::string(wrapped.data(), wrapped.size()));
+}
+
+// Validates instance against schema_text, filling error on failure.
+bool validate(
+    const char* schema_text,
+    const char* instance,
+    validation_error* error = 0) {
+    const document s = parse(schema_text);
+    const document i = parse(instance);
+    schema compiled(s.get_root().get_array_element(0));
+    return compiled.is_valid()
+        && compiled.validate(i.get_root().get_array_element(0), error);
+}
+
+const char* const person_schema
+    = "{\"type\":\"object\",\"required\":[\"name\",\"age\"],"
+      "\"properties\":{\"name\":{\"type\":\"string\",\"minLength\":1},"
+      "\"age\":{\"type\":\"integer\",\"minimum\":0},"
+      "\"tags\":{\"type\":\"array\",\"items\":{\"type\":\"string\"},"
+      "\"uniqueItems\":true}},"
+      "\"additionalProperties\":false}";
+} // namespace
+
+SUITE(schema) {
+    TEST(boolean_schemas) {
+        CHECK(validate("true", "[1,2]"));
+        validation_error error;
+        CHECK(!validate("false", "null", &error));
+        CHECK_EQUAL("false", error.keyword);
+    }
+
+    TEST(types) {
+        CHECK(!validate("{\"type\":\"integer\"}", "[3]"));
+        CHECK(validate("{\"type\":\"integer\"}", "3"));
+        CHECK(validate("{\"type\":\"integer\"}", "3.0"));
+        CHECK(!validate("{\"type\":\"integer\"}", "3.5"));
+        CHECK(validate("{\"type\":\"number\"}", "3.5"));
+        CHECK(validate("{\"type\":[\"null\",\"string\"]}", "null"));
+        CHECK(validate("{\"type\":[\"null\",\"string\"]}", "\"x\""));
+        CHECK(!validate("{\"type\":[\"null\",\"string\"]}", "false"));
+    }
+
+    TEST(enum_and_const) {
+        CHECK(validate("{\"enum\":[1,\"a\",[true]]}", "1.0"));
+        CHECK(validate("{\"enum\":[1,\"a\",[true]]}", "[true]"));
+        CHECK(!validate("{\"enum\":[1,\"a\",[true]]}", "\"b\""));
+        const char* object = "{\"const\":{\"a\":[1],\"b\":2}}";
+        CHECK(validate(object, "{\"b\":2,\"a\":[1]}"));
+        CHECK(!validate(object, "{\"a\":[1]}"));
+    }
+
+    TEST(numbers) {
+        const char* range = "{\"minimum\":1,\"exclusiveMaximum\":10}";
+        CHECK(validate(range, "1"));
+        CHECK(validate(range, "9.5"));
+        CHECK(!validate(range, "10"));
+        CHECK(!validate(range, "0.5"));
+        CHECK(validate(range, "\"not a number\""));
+        CHECK(validate("{\"multipleOf\":0.5}", "2.5"));
+        CHECK(!validate("{\"multipleOf\":3}", "7"));
+        CHECK(validate("{\"multipleOf\":0.1}", "0.3"));
+        CHECK(validate("{\"multipleOf\":0.01}", "19.99"));
+        CHECK(!validate("{\"multipleOf\":0.1}", "0.35"));
+        CHECK(validate("{\"multipleOf\":3}", "9007199254740990"));
+        CHECK(!validate("{\"multipleOf\":2}", "9007199254740991"));
+    }
+
+    TEST(string_length_counts_code_points) {
+        const char* s = "{\"minLength\":2,\"maxLength\":3}";
+        CHECK(validate(s, "\"\\u00e9\\u00e9\""));
+        CHECK(!validate(s, "\"\\u00e9\""));
+        CHECK(!validate(s, "\"abcd\""));
+    }
+
+    TEST(arrays) {
+        const char* tuple = "{\"prefixItems\":[{\"type\":\"string\"}],"
+                            "\"items\":{\"type\":\"integer\"},"
+                            "\"minItems\":1,\"contains\":{\"const\":5}}";
+        CHECK(validate(tuple, "[\"a\",1,5]"));
+        CHECK(!validate(tuple, "[\"a\",1]"));
+        CHECK(!validate(tuple, "[]"));
+        validation_error error;
+        CHECK(!validate(tuple, "[\"a\",5,\"b\"]", &error));
+        CHECK_EQUAL("/2", error.instance_path);
+        CHECK_EQUAL("type", error.keyword);
+        CHECK(!validate("{\"uniqueItems\":true}", "[1,[2],1.0]"));
+    }
+
+    TEST(objects) {
+        CHECK(validate(person_schema, "{\"age\":30,\"name\":\"Ada\"}"));
+        CHECK(validate(
+            person_schema,
+            "{\"tags\":[\"x\",\"y\"],\"name\":\"Ada\",\"age\":30}"));
+
+        validation_error error;
+        CHECK(!validate(person_schema, "{\"name\":\"Ada\"}", &error));
+        CHECK_EQUAL("required", error.keyword);
+        CHECK_EQUAL("", error.instance_path);
+        CHECK_EQUAL("age", error.detail);
+
+        CHECK(!validate(
+            person_schema, "{\"name\":\"Ada\",\"age\":1,\"x\":0}", &error));
+        CHECK_EQUAL("additionalProperties", error.keyword);
+        CHECK_EQUAL("/x", error.instance_path);
+
+        CHECK(!validate(
+            person_schema,
+            "{\"name\":\"Ada\",\"age\":1,\"tags\":[\"a\",2]}",
+            &error));
+        CHECK_EQUAL("type", error.keyword);
+        CHECK_EQUAL("/tags/1", error.instance_path);
+
+        CHECK(!validate(
+            "{\"maxProperties\":1}", "{\"a\":1,\"b\":2}", &error));
+        CHECK_EQUAL("maxProperties", error.keyword);
+    }
+
+    TEST(instance_paths_escape_keys) {
+        validation_error error;
+        CHECK(!validate(
+            "{\"additionalProperties\":{\"type\":\"null\"}}",
+            "{\"a/b~c\":1}",
+            &error));
+        CHECK_EQUAL("/a~1b~0c", error.instance_path);
+    }
+
+    TEST(combinators) {
+        const char* any = "{\"anyOf\":[{\"type\":\"string\"},{\"minimum\":3}]}";
+        CHECK(validate(any, "\"x\""));
+        CHECK(validate(any, "4"));
+        CHECK(!validate(any, "2"));
+
+        const char* one
+            = "{\"oneOf\":[{\"type\":\"integer\"},{\"minimum\":3}]}";
+        CHECK(validate(one, "1"));
+        CHECK(validate(one, "3.5"));
+        CHECK(!validate(one, "4"));
+
+        CHECK(validate("{\"not\":{\"type\":\"null\"}}", "0"));
+        CHECK(!validate("{\"not\":{\"type\":\"null\"}}", "null"));
+        CHECK(!validate(
+            "{\"allOf\":[{\"type\":\"integer\"},{\"maximum\":3}]}", "4"));
+
+        const char* conditional = "{\"if\":{\"type\":\"integer\"},"
+                                  "\"then\":{\"minimum\":0},"
+                                  "\"else\":{\"type\":\"string\"}}";
+        CHECK(validate(conditional, "1"));
+        CHECK(!validate(conditional, "-1"));
+        CHECK(validate(conditional, "\"x\""));
+        CHECK(!validate(conditional, "1.5"));
+    }
+
+    TEST(local_references) {
+        const char* tree = "{\"$defs\":{\"node\":{\"type\":\"object\","
+                           "\"properties\":{\"value\":{\"type\":\"integer\"},"
+                           "\"children\":{\"type\":\"array\","
+                           "\"items\":{\"$ref\":\"#/$defs/node\"}}}}},"
+                           "\"$ref\":\"#/$defs/node\"}";
+        CHECK(validate(
+            tree,
+            "{\"value\":1,\"children\":[{\"value\":2,\"children\":[]}]}"));
+        validation_error error;
+        CHECK(!validate(
+            tree,
+            "{\"value\":1,\"children\":[{\"children\":[{\"value\":\"x\"}]}]}",
+            &error));
+        CHECK_EQUAL("/children/0/children/0/value", error.instance_path);
+
+        const char* list = "{\"type\":[\"null\",\"object\"],"
+                           "\"properties\":{\"next\":{\"$ref\":\"#\"}}}";
+        CHECK(validate(list, "{\"next\":{\"next\":null}}"));
+        CHECK(!validate(list, "{\"next\":{\"next\":1}}"));
+    }
+
+    TEST(compile_errors) {
+        const char* invalid[] = {
+            "1",
+            "{\"type\":\"float\"}",
+            "{\"minimum\":\"1\"}",
+            "{\"minLength\":-1}",
+            "{\"multipleOf\":0}",
+            "{\"required\":[1]}",
+            "{\"allOf\":[]}",
+            "{\"pattern\":\"^a\"}",
+            "{\"$ref\":\"http://example.com/schema\"}",
+            "{\"$ref\":\"#/$defs/missing\"}",
+            "{\"properties\":{\"a\":{\"items\":3}}}",
+            "{\"$ref\":\"#\"}",
+            "{\"$defs\":{\"a\":{\"$ref\":\"#/$defs/a\"}},"
+            "\"$ref\":\"#/$defs/a\"}",
+            "{\"items\":{\"anyOf\":[{\"$ref\":\"#/items\"}]}}",
+        };
+        for (const char* text : invalid) {
+            const document d = parse(text);
+            const sajson::value root = d.get_root().get_array_element(0);
+            schema s(root);
+            CHECK(!s.is_valid());
+            CHECK(!s.get_error_message().empty());
+            CHECK(!s.validate(root));
+        }
+
+        const document d = parse("{\"properties\":{\"a\":{\"items\":3}}}");
+        CHECK_EQUAL(
+            "/properties/a/items: a schema must be an object or a boolean",
+            schema(d.get_root().get_array_element(0)).get_error_message());
+
+        const document cycle = parse("{\"not\":{\"$ref\":\"#\"}}");
+        CHECK_EQUAL(
+            "/: reference cycle does not descend into the instance",
+            schema(cycle.get_root().get_array_element(0))
+                .get_error_message());
+    }
+
+    TEST(annotations_are_ignored) {
+        CHECK(validate(
+            "{\"$schema\":\"https://json-schema.org/draft/2020-12/schema\","
+            "\"title\":\"t\",\"description\":\"d\",\"default\":1}",
+            "null"));
+    }
+}
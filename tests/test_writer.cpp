@@ -0,0 +1,247 @@
+#include <sajson_writer.h>
+
+#include <UnitTest++.h>
+
+#include <cmath>
+#include <string>
+
+using sajson::document;
+using sajson::literal;
+
+namespace {
+std::string rewrite(const std::string& json) {
+    const document d = sajson::parse(
+        sajson::dynamic_allocation(),
+        sajson::string(json.data(), json.size()));
+    std::string out;
+    if (d.is_valid()) {
+        sajson::write(d.get_root(), out);
+    }
+    return out;
+}
+
+void append_chunk(void* context, const char* data, size_t length) {
+    static_cast<std::string*>(context)->append(data, length);
+}
+
+std::string output(const sajson::writer& w) {
+    const sajson::string s = w.get_output();
+    return std::string(s.data(), s.length());
+}
+
+// Writes a document exercising every call.
+void build(sajson::writer& w) {
+    w.begin_object();
+    w.key("id");
+    w.int64(-9007199254740993LL);
+    w.key("score");
+    w.double_(0.25);
+    w.key("tags");
+    w.begin_array();
+    w.string("a\"b");
+    w.boolean(true);
+    w.boolean(false);
+    w.null();
+    w.begin_object();
+    w.end_object();
+    w.begin_array();
+    w.end_array();
+    w.end_array();
+    w.key("long");
+    w.string("a string longer than the smallest buffer,\twith escapes\n");
+    w.end_object();
+}
+} // namespace
+
+SUITE(writer) {
+    TEST(minifies) {
+        CHECK_EQUAL(
+            "[null,true,false,[],{},[1,[2]]]",
+            rewrite(" [ null , true , false , [ ] , { } , [1, [2]] ] "));
+        CHECK_EQUAL(
+            "{\"a\":{\"b\":[]}}", rewrite("{ \"a\" : { \"b\" : [ ] } }"));
+    }
+
+    TEST(integers) {
+        CHECK_EQUAL(
+            "[0,7,-7,10,99,100,-214748364,214748364]",
+            rewrite("[0,7,-7,10,99,100,-214748364,214748364]"));
+    }
+
+    TEST(doubles_round_trip) {
+        const std::string written
+            = rewrite("[0.5,-2.25,1e300,-0.0,1e999,12345678901234]");
+        const document d = sajson::parse(
+            sajson::dynamic_allocation(),
+            sajson::string(written.data(), written.size()));
+        CHECK(d.is_valid());
+        const sajson::value root = d.get_root();
+        CHECK_EQUAL(0.5, root.get_array_element(0).get_double_value());
+        CHECK_EQUAL(-2.25, root.get_array_element(1).get_double_value());
+        CHECK_EQUAL(1e300, root.get_array_element(2).get_double_value());
+        CHECK(signbit(root.get_array_element(3).get_double_value()));
+        CHECK_EQUAL(
+            std::numeric_limits<double>::infinity(),
+            root.get_array_element(4).get_double_value());
+        CHECK_EQUAL(
+            12345678901234.0, root.get_array_element(5).get_double_value());
+    }
+
+    TEST(doubles_are_shortest) {
+        CHECK_EQUAL(
+            "[0.1,0.3,0.30000000000000004,-2.5,100.0,1e21,0.000001,1e-7,"
+            "1.5e300,5e-324,1.7976931348623157e308]",
+            rewrite("[0.1,0.3,0.30000000000000004,-2.5,1e2,1e21,1e-6,1e-7,"
+                    "1.5e300,5e-324,1.7976931348623157e308]"));
+        CHECK_EQUAL(
+            "[123456789012345680000.0,2.34647130966]",
+            rewrite("[123456789012345678901,2.34647130966]"));
+    }
+
+    TEST(doubles_round_trip_bit_exact) {
+        // Every written double parses back to the same bits.
+        uint64_t bits = 0x123456789abcdefULL;
+        for (int i = 0; i < 10000; ++i) {
+            bits = bits * 6364136223846793005ULL + 1442695040888963407ULL;
+            double expected;
+            memcpy(&expected, &bits, sizeof(expected));
+            if (!std::isfinite(expected)) {
+                continue;
+            }
+            char buffer[sajson::internal::max_number_length + 2];
+            buffer[0] = '[';
+            char* end = sajson::internal::write_double(expected, buffer + 1);
+            *end++ = ']';
+            const document d = sajson::parse(
+                sajson::dynamic_allocation(),
+                sajson::mutable_string_view(end - buffer, buffer));
+            CHECK(d.is_valid());
+            const double actual
+                = d.get_root().get_array_element(0).get_double_value();
+            CHECK_EQUAL(0, memcmp(&expected, &actual, sizeof(actual)));
+        }
+    }
+
+    TEST(escapes) {
+        CHECK_EQUAL(
+            "[\"\\\"\\\\/\\b\\f\\n\\r\\t\\u0001\\u001f\"]",
+            rewrite("[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u0001\\u001F\"]"));
+        CHECK_EQUAL(
+            "{\"k\\ney\":\"\\u0000\"}", rewrite("{\"k\\ney\":\"\\u0000\"}"));
+    }
+
+    TEST(utf8_is_copied) {
+        CHECK_EQUAL(
+            "[\"caf\xc3\xa9 \xf0\x9f\x98\x80\"]",
+            rewrite("[\"caf\\u00e9 \\ud83d\\ude00\"]"));
+    }
+
+    TEST(escapes_at_every_offset) {
+        // Covers both the sixteen-byte scan and the tail.
+        for (size_t length = 0; length < 40; ++length) {
+            for (size_t position = 0; position < length; ++position) {
+                std::string text(length, 'x');
+                text[position] = '\n';
+                std::string expected = "[\"" + text + "\"]";
+                expected.replace(position + 2, 1, "\\n");
+
+                std::string input = expected;
+                CHECK_EQUAL(expected, rewrite(input));
+            }
+        }
+    }
+
+    TEST(appends_exactly) {
+        const document d = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"a\":[1.5,\"x\\ty\",-3],\"bb\":null}"));
+        const size_t length = sajson::get_write_length(d.get_root());
+        std::string out = "prefix";
+        sajson::write(d.get_root(), out);
+        CHECK_EQUAL(6 + length, out.size());
+        CHECK_EQUAL("prefix{\"a\":[1.5,\"x\\ty\",-3],\"bb\":null}", out);
+    }
+
+    TEST(builds_compact_output) {
+        sajson::writer w;
+        build(w);
+        CHECK_EQUAL(
+            "{\"id\":-9007199254740993,\"score\":0.25,"
+            "\"tags\":[\"a\\\"b\",true,false,null,{},[]],"
+            "\"long\":\"a string longer than the smallest buffer,"
+            "\\twith escapes\\n\"}",
+            output(w));
+    }
+
+    TEST(pretty_prints) {
+        sajson::writer w(2);
+        w.begin_object();
+        w.key("a");
+        w.begin_array();
+        w.int64(1);
+        w.begin_object();
+        w.key("b");
+        w.null();
+        w.end_object();
+        w.end_array();
+        w.key("c");
+        w.begin_array();
+        w.end_array();
+        w.end_object();
+        CHECK_EQUAL(
+            "{\n"
+            "  \"a\": [\n"
+            "    1,\n"
+            "    {\n"
+            "      \"b\": null\n"
+            "    }\n"
+            "  ],\n"
+            "  \"c\": []\n"
+            "}",
+            output(w));
+    }
+
+    TEST(flushes_in_chunks) {
+        for (unsigned indent = 0; indent < 2; ++indent) {
+            sajson::writer owned(indent * 40);
+            build(owned);
+
+            std::string flushed;
+            char buffer[sajson::writer::min_capacity];
+            sajson::writer w(
+                buffer, sizeof(buffer), append_chunk, &flushed, indent * 40);
+            build(w);
+            w.finish();
+            CHECK_EQUAL(output(owned), flushed);
+        }
+    }
+
+    TEST(writes_parsed_values) {
+        const document d = sajson::parse(
+            sajson::dynamic_allocation(),
+            literal("{\"a\":[1,2.5,\"x\\u0001\",{\"b\":[]}],\"c\":null}"));
+        std::string expected;
+        sajson::write(d.get_root(), expected);
+
+        sajson::writer w;
+        w.begin_array();
+        w.value(d.get_root());
+        w.end_array();
+        CHECK_EQUAL("[" + expected + "]", output(w));
+
+        w.reset();
+        w.value(d.get_root());
+        CHECK_EQUAL(expected, output(w));
+    }
+
+    TEST(writes_raw_values) {
+        sajson::writer w;
+        w.begin_object();
+        w.key("a");
+        w.raw(literal("[1, 2]"));
+        w.key("b");
+        w.raw(literal("\"\\u00e9\""));
+        w.end_object();
+        CHECK_EQUAL("{\"a\":[1, 2],\"b\":\"\\u00e9\"}", output(w));
+    }
+}